@@ -141,6 +141,10 @@ fi
 echo -e "\e[32mInstalling ZMQ...\e[0m"
 install_package libzmq3-dev
 
+# Install Google Benchmark, used by the routing table microbenchmarks in tools/benchmark
+echo -e "\e[32mInstalling Google Benchmark...\e[0m"
+install_package libbenchmark-dev
+
 # Install OMNeT++
 cd "$LIB_DIR"
 OMNETPP_VERSION="6.0.1"
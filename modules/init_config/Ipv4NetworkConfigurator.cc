@@ -6,7 +6,16 @@
 
 #include "inet/networklayer/configurator/ipv4/Ipv4NetworkConfigurator.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <queue>
 #include <set>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
 
 #include "inet/common/INETUtils.h"
 #include "inet/common/ModuleAccess.h"
@@ -17,6 +26,7 @@
 #include "inet/networklayer/contract/IInterfaceTable.h"
 #include "inet/networklayer/ipv4/IIpv4RoutingTable.h"
 #include "inet/networklayer/ipv4/RlConventionalRoutingTable.h"
+#include "inet/networklayer/ipv4/RlThreadPool.h"
 
 namespace inet
 {
@@ -65,6 +75,7 @@ void Ipv4NetworkConfigurator::initialize(int stage)
         addDefaultRoutesParameter = par("addDefaultRoutes");
         addDirectRoutesParameter = par("addDirectRoutes");
         optimizeRoutesParameter = par("optimizeRoutes");
+        configCacheDir = par("configCacheDir").stringValue();
     } else if (stage == INITSTAGE_NETWORK_CONFIGURATION)
         ensureConfigurationComputed(topology);
     else if (stage == INITSTAGE_LAST)
@@ -80,17 +91,32 @@ void Ipv4NetworkConfigurator::computeConfiguration()
     TIME(extractTopology(topology));
     // read the configuration from XML; it will serve as input for address assignment
     TIME(readInterfaceConfiguration(topology));
+    // load addresses and static routes computed by a previous run of the same topology
+    std::string cachePath;
+    bool cacheHit = false;
+    if (!configCacheDir.empty()) {
+        char hashStr[17];
+        snprintf(hashStr, sizeof(hashStr), "%016llx",
+                 (unsigned long long)computeTopologyHash(topology));
+        cachePath = configCacheDir + "/" + getSimulation()->getSystemModule()->getName() + "-"
+                    + hashStr + ".cfgcache";
+        TIME(cacheHit = loadConfigCache(topology, cachePath));
+    }
     // assign addresses to Ipv4 nodes
-    if (assignAddressesParameter)
+    if (assignAddressesParameter && !cacheHit)
         TIME(assignAddresses(topology));
     // read and configure multicast groups from the XML configuration
     TIME(readMulticastGroupConfiguration(topology));
     // read and configure manual routes from the XML configuration
-    readManualRouteConfiguration(topology);
+    if (!cacheHit)
+        readManualRouteConfiguration(topology);
     // read and configure manual multicast routes from the XML configuration
     readManualMulticastRouteConfiguration(topology);
+    // RL routing modes forward with their own tables, so only hosts get a default route towards their router
+    if (addStaticRoutesParameter && !cacheHit && isRlRoutingMode())
+        TIME(addRlHostRoutes(topology));
     // calculate shortest paths, and add corresponding static routes
-    if (addStaticRoutesParameter) {
+    else if (addStaticRoutesParameter && !cacheHit) {
         cXMLElementList autorouteElements = configuration->getChildrenByTagName("autoroute");
         if (autorouteElements.size() == 0) {
             cXMLElement defaultAutorouteElement("autoroute", "", nullptr);
@@ -100,9 +126,321 @@ void Ipv4NetworkConfigurator::computeConfiguration()
                 TIME(addStaticRoutes(topology, autorouteElement));
         }
     }
+    if (!cachePath.empty() && !cacheHit)
+        TIME(saveConfigCache(topology, cachePath));
+    // hand the topology over to the RL routing table for host route lookups and runtime route reprogramming
+    if (routingMode == "convention")
+        TIME(registerRlTopology(topology));
     printElapsedTime("computeConfiguration", initializeStartTime);
 }
 
+void Ipv4NetworkConfigurator::registerRlTopology(Topology &topology)
+{
+    RlConventionalRoutingTable *rlTable = RlConventionalRoutingTable::getInstance();
+    if (!rlTable)
+        return;
+    // routers are R[i] and the host attached to router i is H[i]
+    for (int i = 0; i < topology.getNumNodes(); i++) {
+        Node *node = (Node *)topology.getNode(i);
+        cModule *module = node->module;
+        if (!module->isVector())
+            continue;
+        int index = module->getIndex();
+        if (!strcmp(module->getName(), "R")) {
+            if (node->routingTable)
+                rlTable->registerRoutingTable(
+                    index, check_and_cast<IIpv4RoutingTable *>(node->routingTable));
+            for (auto &interfaceInfo : node->interfaceInfos) {
+                for (auto &peerInfo : interfaceInfo->linkInfo->interfaceInfos) {
+                    cModule *peerModule = peerInfo->node->module;
+                    if (peerInfo == interfaceInfo || !peerModule->isVector()
+                        || strcmp(peerModule->getName(), "R"))
+                        continue;
+                    rlTable->registerRouterLink(index, peerModule->getIndex(),
+                                                interfaceInfo->networkInterface,
+                                                static_cast<InterfaceInfo *>(peerInfo)->getAddress());
+                }
+            }
+        } else if (!strcmp(module->getName(), "H")) {
+            for (auto &interfaceInfo : node->interfaceInfos) {
+                InterfaceInfo *hostInterfaceInfo = static_cast<InterfaceInfo *>(interfaceInfo);
+                rlTable->registerHost(index, hostInterfaceInfo->getAddress(),
+                                      hostInterfaceInfo->getNetmask());
+            }
+        }
+    }
+}
+
+bool Ipv4NetworkConfigurator::isRlRoutingMode() const
+{
+    return routingMode == "probabilistic" || routingMode == "singlepath"
+           || routingMode == "multipath" || routingMode == "weighted" || routingMode == "ecmp";
+}
+
+void Ipv4NetworkConfigurator::addRlHostRoutes(Topology &topology)
+{
+    for (int i = 0; i < topology.getNumNodes(); i++) {
+        Node *node = (Node *)topology.getNode(i);
+        if (strcmp(node->module->getName(), "H"))
+            continue;
+        for (auto &interfaceInfo : node->interfaceInfos) {
+            for (auto &peerInfo : interfaceInfo->linkInfo->interfaceInfos) {
+                if (peerInfo == interfaceInfo)
+                    continue;
+                Ipv4Route *route = new Ipv4Route();
+                route->setSourceType(IRoute::MANUAL);
+                route->setDestination(Ipv4Address::UNSPECIFIED_ADDRESS);
+                route->setNetmask(Ipv4Address::UNSPECIFIED_ADDRESS);
+                route->setGateway(static_cast<InterfaceInfo *>(peerInfo)->getAddress());
+                route->setInterface(interfaceInfo->networkInterface);
+                node->staticRoutes.push_back(route);
+                break;
+            }
+        }
+    }
+}
+
+void Ipv4NetworkConfigurator::setRlDeviceAddress(InterfaceInfo *interfaceInfo, uint32_t address)
+{
+    std::string fullPath = interfaceInfo->getFullPath();
+    size_t firstDot = fullPath.find('.');
+    size_t secondDot = fullPath.find('.', firstDot + 1);
+    std::string deviceName = fullPath.substr(firstDot + 1, secondDot - firstDot - 1);
+    RlConventionalRoutingTable::getInstance()->setDeviceAddress(deviceName,
+                                                                Ipv4Address(address).str());
+}
+
+#define CONFIG_CACHE_MAGIC   0x524c4343 // "RLCC"
+#define CONFIG_CACHE_VERSION 2          // Bumped by every change of the computed addresses or routes
+
+static void hashBytes(uint64_t &hash, const void *data, size_t length)
+{
+    // FNV-1a
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+static void hashString(uint64_t &hash, const std::string &str)
+{
+    uint32_t length = str.size();
+    hashBytes(hash, &length, sizeof(length));
+    hashBytes(hash, str.data(), str.size());
+}
+
+template <typename T> static void writeCacheValue(std::ostream &out, const T &value)
+{
+    out.write((const char *)&value, sizeof(T));
+}
+
+static void writeCacheString(std::ostream &out, const std::string &str)
+{
+    writeCacheValue(out, (uint32_t)str.size());
+    out.write(str.data(), str.size());
+}
+
+template <typename T> static bool readCacheValue(std::istream &in, T &value)
+{
+    return (bool)in.read((char *)&value, sizeof(T));
+}
+
+static bool readCacheString(std::istream &in, std::string &str)
+{
+    uint32_t length;
+    if (!readCacheValue(in, length) || length > (1u << 20))
+        return false;
+    str.resize(length);
+    return (bool)in.read(&str[0], length);
+}
+
+uint64_t Ipv4NetworkConfigurator::computeTopologyHash(Topology &topology)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint32_t version = CONFIG_CACHE_VERSION;
+    hashBytes(hash, &version, sizeof(version));
+    bool parameters[] = {assignAddressesParameter,       assignUniqueAddresses,
+                         assignDisjunctSubnetAddressesParameter, addStaticRoutesParameter,
+                         addSubnetRoutesParameter,       addDefaultRoutesParameter,
+                         addDirectRoutesParameter,       optimizeRoutesParameter};
+    hashBytes(hash, parameters, sizeof(parameters));
+    hashString(hash, routingMode);
+    hashString(hash, configuration->getXML());
+    for (int i = 0; i < topology.getNumNodes(); i++) {
+        Node *node = (Node *)topology.getNode(i);
+        hashString(hash, node->module->getFullPath());
+        for (auto &interfaceInfo : node->interfaceInfos) {
+            hashString(hash, interfaceInfo->getFullPath());
+            // Link costs of the delay, dataRate and errorRate metrics
+            double channel[4] = {0, 0, 0, 0};
+            cDatarateChannel *txChannel =
+                dynamic_cast<cDatarateChannel *>(interfaceInfo->networkInterface->getTxTransmissionChannel());
+            if (txChannel) {
+                channel[0] = txChannel->getDatarate();
+                channel[1] = txChannel->getDelay().dbl();
+                channel[2] = txChannel->getBitErrorRate();
+                channel[3] = txChannel->getPacketErrorRate();
+            }
+            hashBytes(hash, channel, sizeof(channel));
+        }
+    }
+    for (auto &linkInfo : topology.linkInfos) {
+        uint32_t interfaceNum = linkInfo->interfaceInfos.size();
+        hashBytes(hash, &interfaceNum, sizeof(interfaceNum));
+        for (auto &interfaceInfo : linkInfo->interfaceInfos)
+            hashString(hash, interfaceInfo->getFullPath());
+    }
+    return hash;
+}
+
+/**
+ * Cache layout: magic, version, then the address and netmask of every interface, then the static routes of every
+ * node. Nothing is applied unless the whole file matches the current topology.
+ */
+bool Ipv4NetworkConfigurator::loadConfigCache(Topology &topology, const std::string &cachePath)
+{
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in)
+        return false;
+    uint32_t magic, version;
+    if (!readCacheValue(in, magic) || magic != CONFIG_CACHE_MAGIC || !readCacheValue(in, version)
+        || version != CONFIG_CACHE_VERSION)
+        return false;
+
+    std::map<std::string, InterfaceInfo *> interfaceInfoByPath;
+    std::map<std::string, Node *> nodeByPath;
+    for (int i = 0; i < topology.getNumNodes(); i++) {
+        Node *node = (Node *)topology.getNode(i);
+        nodeByPath[node->module->getFullPath()] = node;
+        for (auto &interfaceInfo : node->interfaceInfos)
+            interfaceInfoByPath[interfaceInfo->getFullPath()] =
+                static_cast<InterfaceInfo *>(interfaceInfo);
+    }
+
+    uint32_t interfaceNum;
+    if (!readCacheValue(in, interfaceNum) || interfaceNum != interfaceInfoByPath.size())
+        return false;
+    std::vector<std::pair<InterfaceInfo *, std::pair<uint32_t, uint32_t>>> addresses;
+    for (uint32_t i = 0; i < interfaceNum; i++) {
+        std::string path;
+        uint32_t address, netmask;
+        if (!readCacheString(in, path) || !readCacheValue(in, address)
+            || !readCacheValue(in, netmask))
+            return false;
+        auto it = interfaceInfoByPath.find(path);
+        if (it == interfaceInfoByPath.end())
+            return false;
+        addresses.push_back(std::make_pair(it->second, std::make_pair(address, netmask)));
+    }
+
+    uint32_t nodeNum;
+    if (!readCacheValue(in, nodeNum))
+        return false;
+    std::vector<std::pair<Node *, Ipv4Route *>> routes;
+    bool valid = true;
+    for (uint32_t i = 0; i < nodeNum && valid; i++) {
+        std::string path;
+        uint32_t routeNum;
+        valid = readCacheString(in, path) && readCacheValue(in, routeNum)
+                && nodeByPath.find(path) != nodeByPath.end();
+        if (!valid)
+            break;
+        Node *node = nodeByPath[path];
+        for (uint32_t j = 0; j < routeNum; j++) {
+            uint32_t destination, netmask, gateway;
+            int32_t metric, sourceType;
+            std::string interfaceName;
+            valid = readCacheValue(in, destination) && readCacheValue(in, netmask)
+                    && readCacheValue(in, gateway) && readCacheValue(in, metric)
+                    && readCacheValue(in, sourceType) && readCacheString(in, interfaceName);
+            NetworkInterface *networkInterface = nullptr;
+            if (valid && !interfaceName.empty()) {
+                networkInterface = node->interfaceTable->findInterfaceByName(interfaceName.c_str());
+                valid = networkInterface != nullptr;
+            }
+            if (!valid)
+                break;
+            Ipv4Route *route = new Ipv4Route();
+            route->setDestination(Ipv4Address(destination));
+            route->setNetmask(Ipv4Address(netmask));
+            route->setGateway(Ipv4Address(gateway));
+            route->setInterface(networkInterface);
+            route->setMetric(metric);
+            route->setSourceType((IRoute::SourceType)sourceType);
+            routes.push_back(std::make_pair(node, route));
+        }
+    }
+    if (!valid) {
+        for (auto &route : routes)
+            delete route.second;
+        return false;
+    }
+
+    for (auto &address : addresses) {
+        InterfaceInfo *interfaceInfo = address.first;
+        interfaceInfo->address = address.second.first;
+        interfaceInfo->addressSpecifiedBits = 0xFFFFFFFF;
+        interfaceInfo->netmask = address.second.second;
+        interfaceInfo->netmaskSpecifiedBits = 0xFFFFFFFF;
+        if (routingMode == "convention")
+            setRlDeviceAddress(interfaceInfo, interfaceInfo->address);
+    }
+    for (auto &route : routes)
+        route.first->staticRoutes.push_back(route.second);
+    EV_INFO << "Loaded network configuration from " << cachePath << endl;
+    return true;
+}
+
+void Ipv4NetworkConfigurator::saveConfigCache(Topology &topology, const std::string &cachePath)
+{
+    // Write to a private file first, so that concurrent runs never read a partial cache
+    mkdir(configCacheDir.c_str(), 0755);
+    std::string tmpPath = cachePath + "." + std::to_string(getpid()) + ".tmp";
+    std::ofstream out(tmpPath, std::ios::binary);
+    if (!out) {
+        EV_WARN << "Cannot write network configuration cache " << cachePath << endl;
+        return;
+    }
+    writeCacheValue(out, (uint32_t)CONFIG_CACHE_MAGIC);
+    writeCacheValue(out, (uint32_t)CONFIG_CACHE_VERSION);
+
+    uint32_t interfaceNum = 0;
+    for (int i = 0; i < topology.getNumNodes(); i++)
+        interfaceNum += ((Node *)topology.getNode(i))->interfaceInfos.size();
+    writeCacheValue(out, interfaceNum);
+    for (int i = 0; i < topology.getNumNodes(); i++) {
+        Node *node = (Node *)topology.getNode(i);
+        for (auto &interfaceInfo : node->interfaceInfos) {
+            InterfaceInfo *ipv4InterfaceInfo = static_cast<InterfaceInfo *>(interfaceInfo);
+            writeCacheString(out, ipv4InterfaceInfo->getFullPath());
+            writeCacheValue(out, ipv4InterfaceInfo->address);
+            writeCacheValue(out, ipv4InterfaceInfo->netmask);
+        }
+    }
+
+    writeCacheValue(out, (uint32_t)topology.getNumNodes());
+    for (int i = 0; i < topology.getNumNodes(); i++) {
+        Node *node = (Node *)topology.getNode(i);
+        writeCacheString(out, node->module->getFullPath());
+        writeCacheValue(out, (uint32_t)node->staticRoutes.size());
+        for (auto &route : node->staticRoutes) {
+            writeCacheValue(out, route->getDestination().getInt());
+            writeCacheValue(out, route->getNetmask().getInt());
+            writeCacheValue(out, route->getGateway().getInt());
+            writeCacheValue(out, (int32_t)route->getMetric());
+            writeCacheValue(out, (int32_t)route->getSourceType());
+            writeCacheString(out, route->getInterface() ? route->getInterface()->getInterfaceName()
+                                                        : "");
+        }
+    }
+    out.close();
+    if (!out || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        EV_WARN << "Cannot write network configuration cache " << cachePath << endl;
+    }
+}
+
 void Ipv4NetworkConfigurator::ensureConfigurationComputed(Topology &topology)
 {
     if (topology.getNumNodes() == 0)
@@ -687,16 +1025,8 @@ void Ipv4NetworkConfigurator::assignAddresses(std::vector<LinkInfo *> links)
                          << compatibleInterface->getFullPath()
                          << ", address = " << Ipv4Address(completeAddress)
                          << ", netmask = " << Ipv4Address(completeNetmask) << endl;
-                if (routingMode == "convention") {
-                    std::string fullPath = compatibleInterface->getFullPath();
-                    size_t firstDot = fullPath.find('.');
-                    size_t secondDot = fullPath.find('.', firstDot + 1);
-                    std::string deviceName =
-                        fullPath.substr(firstDot + 1, secondDot - firstDot - 1);
-                    std::string address = Ipv4Address(completeAddress).str();
-                    RlConventionalRoutingTable::getInstance()->setDeviceAddress(deviceName,
-                                                                                address);
-                }
+                if (routingMode == "convention")
+                    setRlDeviceAddress(compatibleInterface, completeAddress);
                 compatibleInterface->address = completeAddress;
                 compatibleInterface->addressSpecifiedBits = 0xFFFFFFFF;
                 compatibleInterface->netmask = completeNetmask;
@@ -1568,8 +1898,40 @@ void Ipv4NetworkConfigurator::addStaticRoutes(Topology &topology, cXMLElement *a
         destinationInterfaces = "**";
     Matcher sourceHostsMatcher(sourceHosts);
     Matcher destinationInterfacesMatcher(destinationInterfaces);
+    // index the nodes and their enabled in links once, so that every worker can run its own Dijkstra without touching
+    // the path state stored in the shared Topology object
+    std::vector<Node *> nodes(topology.getNumNodes());
+    std::map<Node *, int> nodeIndices;
     for (int i = 0; i < topology.getNumNodes(); i++) {
-        Node *sourceNode = (Node *)topology.getNode(i);
+        nodes[i] = (Node *)topology.getNode(i);
+        nodeIndices[nodes[i]] = i;
+    }
+    std::vector<std::vector<std::pair<int, Link *>>> inLinks(nodes.size());
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        for (int j = 0; j < nodes[i]->getNumInLinks(); j++) {
+            Link *link = (Link *)nodes[i]->getLinkIn(j);
+            Node *remoteNode = (Node *)link->getLinkInRemoteNode();
+            if (link->isEnabled() && remoteNode->isEnabled())
+                inLinks[i].push_back(std::make_pair(nodeIndices[remoteNode], link));
+        }
+    }
+    // match the destination interfaces once instead of once per source
+    std::vector<std::vector<bool>> destinationInterfaceMatches(nodes.size());
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        for (auto &interfaceInfo : nodes[i]->interfaceInfos) {
+            std::string destinationFullPath =
+                interfaceInfo->networkInterface->getInterfaceFullPath();
+            std::string destinationShortenedFullPath =
+                destinationFullPath.substr(destinationFullPath.find('.') + 1);
+            destinationInterfaceMatches[i].push_back(
+                destinationInterfacesMatcher.matchesAny()
+                || destinationInterfacesMatcher.matches(destinationFullPath.c_str())
+                || destinationInterfacesMatcher.matches(destinationShortenedFullPath.c_str()));
+        }
+    }
+    std::vector<int> sourceIndices;
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        Node *sourceNode = nodes[i];
         std::string hostFullPath = sourceNode->module->getFullPath();
         std::string hostShortenedFullPath = hostFullPath.substr(hostFullPath.find('.') + 1);
         if (!sourceHostsMatcher.matchesAny()
@@ -1578,144 +1940,182 @@ void Ipv4NetworkConfigurator::addStaticRoutes(Topology &topology, cXMLElement *a
             continue;
         if (isBridgeNode(sourceNode))
             continue;
-        // calculate shortest paths from everywhere to sourceNode
-        // we are going to use the paths in reverse direction (assuming all links are bidirectional)
-        topology.calculateWeightedSingleShortestPathsTo(sourceNode);
-        // check if adding the default routes would be ok (this is an optimization)
-        if (addDefaultRoutesParameter && sourceNode->interfaceInfos.size() == 1
-            && sourceNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo
-            && sourceNode->interfaceInfos[0]->addDefaultRoute) {
-            InterfaceInfo *sourceInterfaceInfo =
-                static_cast<InterfaceInfo *>(sourceNode->interfaceInfos[0]);
-            NetworkInterface *sourceNetworkInterface = sourceInterfaceInfo->networkInterface;
-            InterfaceInfo *gatewayInterfaceInfo =
-                static_cast<InterfaceInfo *>(sourceInterfaceInfo->linkInfo->gatewayInterfaceInfo);
-            //            NetworkInterface *gatewayNetworkInterface = gatewayInterfaceInfo->networkInterface;
-
-            if (addDirectRoutesParameter) {
-                // add a network route for the local network using ARP
-                Ipv4Route *route = new Ipv4Route();
-                route->setDestination(
-                    sourceInterfaceInfo->getAddress().doAnd(sourceInterfaceInfo->getNetmask()));
-                route->setGateway(Ipv4Address::UNSPECIFIED_ADDRESS);
-                route->setNetmask(sourceInterfaceInfo->getNetmask());
-                route->setInterface(sourceNetworkInterface);
-                route->setSourceType(Ipv4Route::MANUAL);
-                EV_DEBUG << "Adding direct route " << *route << " to "
-                         << sourceNode->module->getFullPath() << endl;
-                sourceNode->staticRoutes.push_back(route);
+        sourceIndices.push_back(i);
+    }
+    // every source only writes its own staticRoutes, so the result does not depend on the number of workers
+    RlThreadPool::getInstance()->parallelFor(sourceIndices.size(), [&](int k) {
+        ShortestPaths paths;
+        calculateShortestPathsTo(nodes, inLinks, sourceIndices[k], paths);
+        addStaticRoutesOfSource(nodes, sourceIndices[k], paths, destinationInterfaceMatches);
+    });
+    for (int sourceIndex : sourceIndices)
+        EV_DEBUG << "Added " << nodes[sourceIndex]->staticRoutes.size() << " routes to "
+                 << nodes[sourceIndex]->module->getFullPath() << endl;
+}
+
+/**
+ * Same as Topology::calculateWeightedSingleShortestPathsTo(), including the order in which equally distant nodes are
+ * settled, but the result is written into paths instead of the nodes.
+ */
+void Ipv4NetworkConfigurator::calculateShortestPathsTo(
+    const std::vector<Node *> &nodes, const std::vector<std::vector<std::pair<int, Link *>>> &inLinks,
+    int target, ShortestPaths &paths)
+{
+    int nodeNum = nodes.size();
+    paths.dist.assign(nodeNum, INFINITY);
+    paths.pathLink.assign(nodeNum, nullptr);
+    paths.pathNext.assign(nodeNum, -1);
+    std::vector<long> queuedSeq(nodeNum, -1);
+    // (distance, insertion order, node), equally distant nodes leave the queue in the order they entered it
+    typedef std::tuple<double, long, int> QueueItem;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    long seq = 0;
+    paths.dist[target] = 0;
+    queuedSeq[target] = seq;
+    queue.push(std::make_tuple(0.0, seq++, target));
+    while (!queue.empty()) {
+        int dest = std::get<2>(queue.top());
+        long destSeq = std::get<1>(queue.top());
+        queue.pop();
+        if (destSeq != queuedSeq[dest])
+            continue;
+        queuedSeq[dest] = -1;
+        ASSERT(nodes[dest]->getWeight() >= 0.0);
+        for (auto &inLink : inLinks[dest]) {
+            int src = inLink.first;
+            ASSERT(inLink.second->getWeight() >= 0.0);
+            double newDist = paths.dist[dest] + inLink.second->getWeight();
+            if (dest != target)
+                newDist += nodes[dest]->getWeight();
+            if (paths.dist[src] > newDist) {
+                paths.dist[src] = newDist;
+                paths.pathLink[src] = inLink.second;
+                paths.pathNext[src] = dest;
+                queuedSeq[src] = seq;
+                queue.push(std::make_tuple(newDist, seq++, src));
             }
+        }
+    }
+}
 
-            // add a default route towards the only one gateway
+void Ipv4NetworkConfigurator::addStaticRoutesOfSource(
+    const std::vector<Node *> &nodes, int sourceIndex, const ShortestPaths &paths,
+    const std::vector<std::vector<bool>> &destinationInterfaceMatches)
+{
+    // the paths lead from everywhere to sourceNode, we are going to use them in reverse direction (assuming all links
+    // are bidirectional)
+    Node *sourceNode = nodes[sourceIndex];
+    // check if adding the default routes would be ok (this is an optimization)
+    if (addDefaultRoutesParameter && sourceNode->interfaceInfos.size() == 1
+        && sourceNode->interfaceInfos[0]->linkInfo->gatewayInterfaceInfo
+        && sourceNode->interfaceInfos[0]->addDefaultRoute) {
+        InterfaceInfo *sourceInterfaceInfo =
+            static_cast<InterfaceInfo *>(sourceNode->interfaceInfos[0]);
+        NetworkInterface *sourceNetworkInterface = sourceInterfaceInfo->networkInterface;
+        InterfaceInfo *gatewayInterfaceInfo =
+            static_cast<InterfaceInfo *>(sourceInterfaceInfo->linkInfo->gatewayInterfaceInfo);
+        //            NetworkInterface *gatewayNetworkInterface = gatewayInterfaceInfo->networkInterface;
+
+        if (addDirectRoutesParameter) {
+            // add a network route for the local network using ARP
             Ipv4Route *route = new Ipv4Route();
-            Ipv4Address gateway = gatewayInterfaceInfo->getAddress();
-            route->setDestination(Ipv4Address::UNSPECIFIED_ADDRESS);
-            route->setNetmask(Ipv4Address::UNSPECIFIED_ADDRESS);
-            route->setGateway(gateway);
+            route->setDestination(
+                sourceInterfaceInfo->getAddress().doAnd(sourceInterfaceInfo->getNetmask()));
+            route->setGateway(Ipv4Address::UNSPECIFIED_ADDRESS);
+            route->setNetmask(sourceInterfaceInfo->getNetmask());
             route->setInterface(sourceNetworkInterface);
             route->setSourceType(Ipv4Route::MANUAL);
-            EV_DEBUG << "Adding default route " << *route << " to "
-                     << sourceNode->module->getFullPath() << endl;
             sourceNode->staticRoutes.push_back(route);
+        }
 
-            // skip building and optimizing the whole routing table
-            EV_DEBUG << "Adding default routes to " << sourceNode->getModule()->getFullPath()
-                     << ", node has only one (non-loopback) interface" << endl;
-        } else {
-            // add a route to all destinations in the network
-            for (int j = 0; j < topology.getNumNodes(); j++) {
-                // extract destination
-                Node *destinationNode = (Node *)topology.getNode(j);
-                if (sourceNode == destinationNode)
-                    continue;
-                if (destinationNode->getNumPaths() == 0)
-                    continue;
-                if (isBridgeNode(destinationNode))
-                    continue;
-                if (std::isinf(destinationNode->getDistanceToTarget()))
-                    continue;
-
-                // determine next hop interface
-                // find next hop interface (the last IP interface on the path that is not in the source node)
-                Node *node = destinationNode;
-                Link *link = nullptr;
-                InterfaceInfo *nextHopInterfaceInfo = nullptr;
-                while (node != sourceNode) {
-                    link = (Link *)node->getPath(0);
-                    if (node != sourceNode && !isBridgeNode(node) && link->sourceInterfaceInfo)
-                        nextHopInterfaceInfo =
-                            static_cast<InterfaceInfo *>(link->sourceInterfaceInfo);
-                    node = (Node *)node->getPath(0)->getLinkOutRemoteNode();
-                }
+        // add a default route towards the only one gateway
+        Ipv4Route *route = new Ipv4Route();
+        Ipv4Address gateway = gatewayInterfaceInfo->getAddress();
+        route->setDestination(Ipv4Address::UNSPECIFIED_ADDRESS);
+        route->setNetmask(Ipv4Address::UNSPECIFIED_ADDRESS);
+        route->setGateway(gateway);
+        route->setInterface(sourceNetworkInterface);
+        route->setSourceType(Ipv4Route::MANUAL);
+        sourceNode->staticRoutes.push_back(route);
+        // skip building and optimizing the whole routing table
+    } else {
+        // add a route to all destinations in the network
+        for (int destinationIndex = 0; destinationIndex < (int)nodes.size(); destinationIndex++) {
+            // extract destination
+            Node *destinationNode = nodes[destinationIndex];
+            if (sourceNode == destinationNode)
+                continue;
+            if (!paths.pathLink[destinationIndex])
+                continue;
+            if (isBridgeNode(destinationNode))
+                continue;
+            if (std::isinf(paths.dist[destinationIndex]))
+                continue;
+
+            // determine next hop interface
+            // find next hop interface (the last IP interface on the path that is not in the source node)
+            int nodeIndex = destinationIndex;
+            Link *link = nullptr;
+            InterfaceInfo *nextHopInterfaceInfo = nullptr;
+            while (nodeIndex != sourceIndex) {
+                link = paths.pathLink[nodeIndex];
+                if (!isBridgeNode(nodes[nodeIndex]) && link->sourceInterfaceInfo)
+                    nextHopInterfaceInfo =
+                        static_cast<InterfaceInfo *>(link->sourceInterfaceInfo);
+                nodeIndex = paths.pathNext[nodeIndex];
+            }
 
-                // determine source interface
-                if (nextHopInterfaceInfo && link->destinationInterfaceInfo
-                    && link->destinationInterfaceInfo->addStaticRoute) {
-                    NetworkInterface *sourceNetworkInterface =
-                        link->destinationInterfaceInfo->networkInterface;
-                    // add the same routes for all destination interfaces (IP packets are accepted from any interface at the destination)
-                    for (size_t j = 0; j < destinationNode->interfaceInfos.size(); j++) {
-                        InterfaceInfo *destinationInterfaceInfo =
-                            static_cast<InterfaceInfo *>(destinationNode->interfaceInfos[j]);
-                        std::string destinationFullPath =
-                            destinationInterfaceInfo->networkInterface->getInterfaceFullPath();
-                        std::string destinationShortenedFullPath =
-                            destinationFullPath.substr(destinationFullPath.find('.') + 1);
-                        if (!destinationInterfacesMatcher.matchesAny()
-                            && !destinationInterfacesMatcher.matches(destinationFullPath.c_str())
-                            && !destinationInterfacesMatcher.matches(
-                                destinationShortenedFullPath.c_str()))
-                            continue;
-                        NetworkInterface *destinationNetworkInterface =
-                            destinationInterfaceInfo->networkInterface;
-                        Ipv4Address destinationAddress = destinationInterfaceInfo->getAddress();
-                        Ipv4Address destinationNetmask = destinationInterfaceInfo->getNetmask();
-                        if (!destinationNetworkInterface->isLoopback()
-                            && !destinationAddress.isUnspecified()) {
-                            Ipv4Route *route = new Ipv4Route();
-                            Ipv4Address gatewayAddress = nextHopInterfaceInfo->getAddress();
-                            if (addSubnetRoutesParameter
-                                && destinationNode->interfaceInfos.size() == 1
-                                && destinationNode->interfaceInfos[0]
-                                       ->linkInfo->gatewayInterfaceInfo
-                                && destinationNode->interfaceInfos[0]->addSubnetRoute) {
-                                ASSERT(
-                                    !destinationAddress.doAnd(destinationNetmask).isUnspecified());
-                                route->setDestination(destinationAddress.doAnd(destinationNetmask));
-                                route->setNetmask(destinationNetmask);
-                            } else {
-                                route->setDestination(destinationAddress);
-                                route->setNetmask(Ipv4Address::ALLONES_ADDRESS);
-                            }
-                            route->setInterface(sourceNetworkInterface);
-                            if (gatewayAddress != destinationAddress)
-                                route->setGateway(gatewayAddress);
-                            route->setSourceType(Ipv4Route::MANUAL);
-                            if (containsRoute(sourceNode->staticRoutes, route))
-                                delete route;
-                            else if (!addDirectRoutesParameter
-                                     && route->getGateway().isUnspecified())
-                                delete route;
-                            else {
-                                sourceNode->staticRoutes.push_back(route);
-                                EV_DEBUG << "Adding route "
-                                         << sourceNetworkInterface->getInterfaceFullPath() << " -> "
-                                         << destinationNetworkInterface->getInterfaceFullPath()
-                                         << " as " << route->str() << endl;
-                            }
+            // determine source interface
+            if (nextHopInterfaceInfo && link->destinationInterfaceInfo
+                && link->destinationInterfaceInfo->addStaticRoute) {
+                NetworkInterface *sourceNetworkInterface =
+                    link->destinationInterfaceInfo->networkInterface;
+                // add the same routes for all destination interfaces (IP packets are accepted from any interface at the destination)
+                for (size_t j = 0; j < destinationNode->interfaceInfos.size(); j++) {
+                    InterfaceInfo *destinationInterfaceInfo =
+                        static_cast<InterfaceInfo *>(destinationNode->interfaceInfos[j]);
+                    if (!destinationInterfaceMatches[destinationIndex][j])
+                        continue;
+                    NetworkInterface *destinationNetworkInterface =
+                        destinationInterfaceInfo->networkInterface;
+                    Ipv4Address destinationAddress = destinationInterfaceInfo->getAddress();
+                    Ipv4Address destinationNetmask = destinationInterfaceInfo->getNetmask();
+                    if (!destinationNetworkInterface->isLoopback()
+                        && !destinationAddress.isUnspecified()) {
+                        Ipv4Route *route = new Ipv4Route();
+                        Ipv4Address gatewayAddress = nextHopInterfaceInfo->getAddress();
+                        if (addSubnetRoutesParameter
+                            && destinationNode->interfaceInfos.size() == 1
+                            && destinationNode->interfaceInfos[0]
+                                   ->linkInfo->gatewayInterfaceInfo
+                            && destinationNode->interfaceInfos[0]->addSubnetRoute) {
+                            ASSERT(
+                                !destinationAddress.doAnd(destinationNetmask).isUnspecified());
+                            route->setDestination(destinationAddress.doAnd(destinationNetmask));
+                            route->setNetmask(destinationNetmask);
+                        } else {
+                            route->setDestination(destinationAddress);
+                            route->setNetmask(Ipv4Address::ALLONES_ADDRESS);
                         }
+                        route->setInterface(sourceNetworkInterface);
+                        if (gatewayAddress != destinationAddress)
+                            route->setGateway(gatewayAddress);
+                        route->setSourceType(Ipv4Route::MANUAL);
+                        if (containsRoute(sourceNode->staticRoutes, route))
+                            delete route;
+                        else if (!addDirectRoutesParameter
+                                 && route->getGateway().isUnspecified())
+                            delete route;
+                        else
+                            sourceNode->staticRoutes.push_back(route);
                     }
                 }
             }
-
-            // optimize routing table to save memory and increase lookup performance
-            if (optimizeRoutesParameter) {
-                EV_INFO << "Optimizing " << sourceNode->staticRoutes.size() << " routes for "
-                        << sourceNode->module->getFullName();
-                optimizeRoutes(sourceNode->staticRoutes);
-                EV_INFO << " resulted in " << sourceNode->staticRoutes.size() << " routes" << endl;
-            }
         }
+
+        // optimize routing table to save memory and increase lookup performance
+        if (optimizeRoutesParameter)
+            optimizeRoutes(sourceNode->staticRoutes);
     }
 }
 
@@ -1745,301 +2145,221 @@ int Ipv4NetworkConfigurator::findRouteIndexWithSameColor(const std::vector<Ipv4R
 }
 
 /**
- * Returns true if swapping two ADJACENT routes in the routing table does not change the table's meaning.
+ * Asserts that all original routes are still routed the same way as by the original routing table.
  */
-bool Ipv4NetworkConfigurator::routesCanBeSwapped(RouteInfo *routeInfo1, RouteInfo *routeInfo2)
+void Ipv4NetworkConfigurator::checkOriginalRoutes(const RoutingTableInfo &routingTableInfo,
+                                                  const RoutingTableInfo &originalRoutingTableInfo)
 {
-    if (routeInfo1->color == routeInfo2->color)
-        return true; // these two routes send the packet in the same direction (same gw/iface), doesn't matter which one we use -> can be swapped
-    else {
-        // unrelated routes can also be swapped
-        uint32_t netmask = routeInfo1->netmask & routeInfo2->netmask;
-        return (routeInfo1->destination & netmask) != (routeInfo2->destination & netmask);
+    // assert that all original routes are routed with the same color
+    for (auto &originalRouteInfo : originalRoutingTableInfo.routeInfos) {
+        Ipv4NetworkConfigurator::RouteInfo *matchingRouteInfo =
+            routingTableInfo.findBestMatchingRouteInfo(originalRouteInfo->destination);
+        Ipv4NetworkConfigurator::RouteInfo *matchingOriginalRouteInfo =
+            originalRoutingTableInfo.findBestMatchingRouteInfo(originalRouteInfo->destination);
+        ASSERT(matchingRouteInfo && matchingRouteInfo->color == matchingOriginalRouteInfo->color);
     }
 }
 
-/**
- * Returns true if the routes can be neighbors by repeatedly swapping routes
- * in the routing table without changing their meaning.
- */
-bool Ipv4NetworkConfigurator::routesCanBeNeighbors(const std::vector<RouteInfo *> &routeInfos,
-                                                   int i, int j)
-{
-    int begin = std::min(i, j);
-    int end = std::max(i, j);
-    Ipv4NetworkConfigurator::RouteInfo *beginRouteInfo = routeInfos.at(begin);
-    for (int index = begin + 1; index < end; index++)
-        if (!routesCanBeSwapped(beginRouteInfo, routeInfos.at(index)))
-            return false;
-
-    return true;
-}
+namespace {
 
 /**
- * Returns true if the original route is interrupted by any of the routes in
- * the routing table between begin and end.
+ * Node of the binary address prefix trie used by the route optimizer.
  */
-bool Ipv4NetworkConfigurator::interruptsOriginalRoute(const RoutingTableInfo &routingTableInfo,
-                                                      int begin, int end,
-                                                      RouteInfo *originalRouteInfo)
+struct PrefixTrieNode
 {
-    Ipv4NetworkConfigurator::RouteInfo *matchingRouteInfo =
-        routingTableInfo.findBestMatchingRouteInfo(originalRouteInfo->destination, begin, end);
-    return matchingRouteInfo && matchingRouteInfo->color != originalRouteInfo->color;
-}
+    int children[2] = {-1, -1};
+    int color = -1;           // color of the original route with exactly this prefix, -1 if none
+    uint32_t destination = 0; // unmasked destination of that route, it decides between routes of the same prefix
+    int coveringColor = -1;   // color of the longest original route covering this prefix, -1 if none
+    bool anyColor = false;    // no original route covers any address of this prefix, it may be routed anywhere
+    std::vector<int> colors;  // sorted colors that route the whole prefix with the fewest routes below it
+};
 
 /**
- * Returns true if any of the original routes is interrupted by any of the
- * routes in the routing table between begin and end.
+ * Route produced by the route optimizer.
  */
-bool Ipv4NetworkConfigurator::interruptsAnyOriginalRoute(
-    const RoutingTableInfo &routingTableInfo, int begin, int end,
-    const std::vector<RouteInfo *> &originalRouteInfos)
+struct PrefixRoute
 {
-    if (begin < end)
-        for (auto &originalRouteInfo : originalRouteInfos)
-            if (interruptsOriginalRoute(routingTableInfo, begin, end, originalRouteInfo))
-                return true;
+    uint32_t destination;
+    int length;
+    int color;
+};
 
-    return false;
-}
+} // namespace
 
 /**
- * Returns true if any of the original routes attached to the routes in the
- * routing table below index are interrupted by the route at index.
+ * Returns the number of leading one bits of the netmask, or -1 if the netmask is not contiguous.
  */
-bool Ipv4NetworkConfigurator::interruptsSubsequentOriginalRoutes(
-    const RoutingTableInfo &routingTableInfo, int index)
+static int getPrefixLength(uint32_t netmask)
 {
-    for (size_t i = index + 1; i < routingTableInfo.routeInfos.size(); i++) {
-        Ipv4NetworkConfigurator::RouteInfo *routeInfo = routingTableInfo.routeInfos.at(i);
-        if (interruptsAnyOriginalRoute(routingTableInfo, index, index + 1,
-                                       routeInfo->originalRouteInfos))
-            return true;
-    }
-    return false;
+    uint32_t hostmask = ~netmask;
+    if (hostmask & (hostmask + 1))
+        return -1;
+    int length = 32;
+    for (; hostmask; hostmask >>= 1)
+        length--;
+    return length;
 }
 
 /**
- * Asserts that all original routes are still routed the same way as by the original routing table.
+ * Adds a prefix to the trie. Routes of the same prefix are ordered by their unmasked destination
+ * and then by their position in the routing table, the first one wins just like in the routing table.
  */
-void Ipv4NetworkConfigurator::checkOriginalRoutes(const RoutingTableInfo &routingTableInfo,
-                                                  const RoutingTableInfo &originalRoutingTableInfo)
+static void insertPrefix(std::vector<PrefixTrieNode> &trie, uint32_t destination, int length,
+                         int color)
 {
-    // assert that all original routes are routed with the same color
-    for (auto &originalRouteInfo : originalRoutingTableInfo.routeInfos) {
-        Ipv4NetworkConfigurator::RouteInfo *matchingRouteInfo =
-            routingTableInfo.findBestMatchingRouteInfo(originalRouteInfo->destination);
-        Ipv4NetworkConfigurator::RouteInfo *matchingOriginalRouteInfo =
-            originalRoutingTableInfo.findBestMatchingRouteInfo(originalRouteInfo->destination);
-        ASSERT(matchingRouteInfo && matchingRouteInfo->color == matchingOriginalRouteInfo->color);
+    int index = 0;
+    for (int bitIndex = 0; bitIndex < length; bitIndex++) {
+        int bit = (destination >> (31 - bitIndex)) & 1;
+        if (trie[index].children[bit] == -1) {
+            trie[index].children[bit] = trie.size();
+            trie.emplace_back();
+        }
+        index = trie[index].children[bit];
     }
-}
-
-/**
- * Returns the longest shared address prefix and netmask by iterating through bits from left to right.
- */
-void Ipv4NetworkConfigurator::findLongestCommonDestinationPrefix(
-    uint32_t destination1, uint32_t netmask1, uint32_t destination2, uint32_t netmask2,
-    uint32_t &destinationOut, uint32_t &netmaskOut)
-{
-    netmaskOut = 0;
-    destinationOut = 0;
-    for (int bitIndex = 31; bitIndex >= 0; bitIndex--) {
-        uint32_t mask = 1 << bitIndex;
-        if ((destination1 & mask) == (destination2 & mask) && (netmask1 & mask) != 0
-            && (netmask2 & mask) != 0) {
-            netmaskOut |= mask;
-            destinationOut |= destination1 & mask;
-        } else
-            break;
+    if (trie[index].color == -1 || destination < trie[index].destination) {
+        trie[index].color = color;
+        trie[index].destination = destination;
     }
 }
 
 /**
- * Adds all of the original routes to the matching optimized routes between begin and end.
+ * Merges the color sets of two sibling prefixes: the common colors if there are any, all colors otherwise.
  */
-void Ipv4NetworkConfigurator::addOriginalRouteInfos(
-    RoutingTableInfo &routingTableInfo, int begin, int end,
-    const std::vector<RouteInfo *> &originalRouteInfos)
+static void mergeColorSets(bool anyColor1, const std::vector<int> &colors1, bool anyColor2,
+                           const std::vector<int> &colors2, bool &anyColor, std::vector<int> &colors)
 {
-    for (auto &originalRouteInfo : originalRouteInfos) {
-        Ipv4NetworkConfigurator::RouteInfo *matchingRouteInfo =
-            routingTableInfo.findBestMatchingRouteInfo(originalRouteInfo->destination, begin, end);
-        ASSERT(matchingRouteInfo && matchingRouteInfo->color == originalRouteInfo->color);
-        matchingRouteInfo->originalRouteInfos.push_back(originalRouteInfo);
+    anyColor = anyColor1 && anyColor2;
+    if (anyColor1 || anyColor2) {
+        colors = anyColor1 ? colors2 : colors1;
+        return;
     }
+    colors.clear();
+    std::set_intersection(colors1.begin(), colors1.end(), colors2.begin(), colors2.end(),
+                          std::back_inserter(colors));
+    if (colors.empty())
+        std::set_union(colors1.begin(), colors1.end(), colors2.begin(), colors2.end(),
+                       std::back_inserter(colors));
 }
 
 /**
- * Try to merge two routes that have the same color and could be neighbours in table
- * without changing the table's meaning. There are two merge opportunities:
- * (1) one route's network contains the other one (then the second can be dropped),
- * and (2) use a shorter common prefix that covers both (this is only possible
- * if this doesn't interfere with existing routes in the table).
- * Returns true if the two routes have been merged, otherwise returns false.
+ * Bottom-up pass: computes the set of colors each prefix can be routed with. A missing child
+ * behaves like a leaf routed by the longest original route covering it.
  */
-bool Ipv4NetworkConfigurator::tryToMergeTwoRoutes(RoutingTableInfo &routingTableInfo, int i, int j,
-                                                  RouteInfo *routeInfoI, RouteInfo *routeInfoJ)
+static void computeColorSets(std::vector<PrefixTrieNode> &trie, int index, int coveringColor)
 {
-    // determine longest shared address prefix and netmask by iterating through bits from left to right
-    uint32_t netmask;
-    uint32_t destination;
-    findLongestCommonDestinationPrefix(routeInfoI->destination, routeInfoI->netmask,
-                                       routeInfoJ->destination, routeInfoJ->netmask, destination,
-                                       netmask);
-
-    // create the merged route
-    ASSERT(routeInfoI->color == routeInfoJ->color);
-    RouteInfo *mergedRouteInfo = new RouteInfo(routeInfoI->color, destination, netmask);
-    routeInfoI->enabled = false;
-    routeInfoJ->enabled = false;
-    int m = routingTableInfo.addRouteInfo(mergedRouteInfo);
-    ASSERT(m > i && m > j);
-
-    // check if all the original routes are still routed the same way by the optimized routing table.
-    // check optimization: instead of checking all the original routes, check only those which can go wrong due to the merge.
-    // (assuming the previous configuration was correct)
-    // - the original routes on I and J are going to be routed by M after the merge, so check if the routes in between don't interrupt them
-    // - the original routes following M can be accidentally overridden by M (being larger than the sum of I and J), so verify that M does not interrupt them
-    // note that the condition is not symmetric because I follows J so it requires fewer checks and we do use that.
-    if (!interruptsAnyOriginalRoute(routingTableInfo, j + 1, i, routeInfoJ->originalRouteInfos)
-        && // check that original routes on J are not interrupted between J and I
-        !interruptsAnyOriginalRoute(routingTableInfo, i + 1, m, routeInfoJ->originalRouteInfos)
-        && // check that original routes on J are not interrupted between I and M
-        !interruptsAnyOriginalRoute(routingTableInfo, i + 1, m, routeInfoI->originalRouteInfos)
-        && // check that original routes on I are not interrupted between I and M
-        !interruptsSubsequentOriginalRoutes(
-            routingTableInfo, m)) // check that the original routes after M are not interrupted by M
-    {
-        // now we know that the merge does not conflict with any route in the routing table.
-        // the next thing to do is to maintain the original routes attached to the optimized ones.
-        // move original routes from the to be deleted I route to the capturing routes.
-        addOriginalRouteInfos(routingTableInfo, i + 1, m + 1, routeInfoI->originalRouteInfos);
-
-        // move original routes from the to be deleted J route to the capturing routes.
-        addOriginalRouteInfos(routingTableInfo, j + 1, m + 1, routeInfoJ->originalRouteInfos);
-
-        // move original routes from the routes following the merged one if necessary.
-        for (int k = m + 1; k < (int)routingTableInfo.routeInfos.size(); k++) {
-            Ipv4NetworkConfigurator::RouteInfo *followingRouteInfo =
-                routingTableInfo.routeInfos.at(k);
-            for (int l = 0; l < (int)followingRouteInfo->originalRouteInfos.size(); l++) {
-                Ipv4NetworkConfigurator::RouteInfo *originalRouteInfo =
-                    followingRouteInfo->originalRouteInfos.at(l);
-                if (!((originalRouteInfo->destination ^ mergedRouteInfo->destination)
-                      & mergedRouteInfo->netmask)) {
-                    followingRouteInfo->originalRouteInfos.erase(
-                        followingRouteInfo->originalRouteInfos.begin() + l);
-                    ASSERT(mergedRouteInfo->color == originalRouteInfo->color);
-                    mergedRouteInfo->originalRouteInfos.push_back(originalRouteInfo);
-                    l--;
-                }
-            }
+    if (trie[index].color != -1)
+        coveringColor = trie[index].color;
+    trie[index].coveringColor = coveringColor;
+
+    bool childAnyColor[2];
+    std::vector<int> missingChildColors;
+    if (coveringColor != -1)
+        missingChildColors.push_back(coveringColor);
+    const std::vector<int> *childColors[2];
+    for (int bit = 0; bit < 2; bit++) {
+        int child = trie[index].children[bit];
+        if (child == -1) {
+            childAnyColor[bit] = coveringColor == -1;
+            childColors[bit] = &missingChildColors;
+        } else {
+            computeColorSets(trie, child, coveringColor);
+            childAnyColor[bit] = trie[child].anyColor;
+            childColors[bit] = &trie[child].colors;
         }
-        routingTableInfo.removeRouteInfo(routeInfoI);
-        routingTableInfo.removeRouteInfo(routeInfoJ);
-#ifndef NDEBUG
-//        checkOriginalRoutes(routingTableInfo, originalRoutingTableInfos);
-#endif // ifndef NDEBUG
-        delete routeInfoI;
-        delete routeInfoJ;
-        return true;
-    } else {
-        // merge failed; restore original state
-        routeInfoI->enabled = true;
-        routeInfoJ->enabled = true;
-        routingTableInfo.removeRouteInfo(mergedRouteInfo);
-        delete mergedRouteInfo;
-        return false;
     }
+    if (trie[index].children[0] == -1 && trie[index].children[1] == -1) {
+        trie[index].anyColor = coveringColor == -1;
+        trie[index].colors = missingChildColors;
+    } else
+        mergeColorSets(childAnyColor[0], *childColors[0], childAnyColor[1], *childColors[1],
+                       trie[index].anyColor, trie[index].colors);
 }
 
 /**
- * Iteratively checks if any two routes can be aggressively merged without changing the meaning of all original routes.
- * The merged route will have the longest shared address prefix and netmask with the two merged routes.
- * This optimization might change the meaning of the routing table in that it will route packets that it did not route before.
- * Nevertheless, any packet routed by the original routing table will still be routed the same way by the optimized routing table.
- * Returns true if two routes has been merged, otherwise returns false.
+ * Top-down pass: emits a route for a prefix only if the route inherited from the enclosing
+ * prefixes does not use one of its colors.
  */
-bool Ipv4NetworkConfigurator::tryToMergeAnyTwoRoutes(RoutingTableInfo &routingTableInfo)
-{
-    for (int i = 0; i < (int)routingTableInfo.routeInfos.size(); i++) {
-        Ipv4NetworkConfigurator::RouteInfo *routeInfoI = routingTableInfo.routeInfos.at(i);
-
-        // iterate backward so that we try to merge routes having longer netmasks first.
-        // this results in smaller changes and allows more symmetric optimization.
-        for (int j = i - 1; j >= 0; j--) {
-            Ipv4NetworkConfigurator::RouteInfo *routeInfoJ = routingTableInfo.routeInfos.at(j);
-
-            // we can only merge neighbor routes having the same color
-            if (routeInfoI->color == routeInfoJ->color
-                && routesCanBeNeighbors(routingTableInfo.routeInfos, i, j)) {
-                // it is worth to actually try to merge them
-                if (tryToMergeTwoRoutes(routingTableInfo, i, j, routeInfoI, routeInfoJ))
-                    return true;
-            }
-        }
+static void collectPrefixRoutes(const std::vector<PrefixTrieNode> &trie, int index,
+                                int coveringColor, uint32_t destination, int length,
+                                int routedColor, std::vector<PrefixRoute> &routes)
+{
+    bool anyColor = index == -1 ? coveringColor == -1 : trie[index].anyColor;
+    if (anyColor)
+        return;
+    if (index == -1) {
+        if (routedColor != coveringColor)
+            routes.push_back({destination, length, coveringColor});
+        return;
     }
-    return false;
+    const std::vector<int> &colors = trie[index].colors;
+    if (routedColor == -1 || !std::binary_search(colors.begin(), colors.end(), routedColor)) {
+        routedColor = colors.front();
+        routes.push_back({destination, length, routedColor});
+    }
+    if (trie[index].children[0] == -1 && trie[index].children[1] == -1)
+        return;
+    for (int bit = 0; bit < 2; bit++)
+        collectPrefixRoutes(trie, trie[index].children[bit], trie[index].coveringColor,
+                            destination | ((uint32_t)bit << (31 - length)), length + 1,
+                            routedColor, routes);
 }
 
 void Ipv4NetworkConfigurator::optimizeRoutes(std::vector<Ipv4Route *> &originalRoutes)
 {
-    // The basic idea: if two routes "do the same" (same output interface, gateway, etc) and
-    // match "similar" addresses, one can try to move them to be neighbors in the table and
-    // replace them with a single route which contains their longest common prefix as address
-    // prefix -- provided that this operation doesn't affect the meaning of the routing table
-    // for "existing" addresses. (We don't care about changing the routing for addresses that
-    // we know don't occur in our currently configured network.) We can repeatedly merge routes
-    // in this way until it's not possible any more. Of course, the result also depends on
-    // which pairs of routes we merge, and in which order.
+    // The basic idea: routes that "do the same" (same output interface, gateway, etc) get the same
+    // color, and all route prefixes are put into a binary trie. Each address range covered by an
+    // original route must keep its color, all the other addresses are don't care: we don't care
+    // about changing the routing for addresses that we know don't occur in our currently configured
+    // network. A bottom-up pass computes for every prefix the colors it can be routed with using the
+    // fewest routes below it (the common colors of the two halves, or all of them if there are none),
+    // and a top-down pass emits a route only where the color inherited from the enclosing route does
+    // not fit (ORTC, Draves et al.). This produces the smallest such table in time linear in the
+    // number of routes times the address length.
 
     // STEP 1.
-    // instead of working with Ipv4 routes we transform them into the internal representation of the optimizer.
     // routes are classified based on their action (gateway, interface, type, source, metric, etc.) and a color is assigned to them.
-    RoutingTableInfo routingTableInfo;
     std::vector<Ipv4Route *>
         colorToRoute; // a mapping from color to route action (interface, gateway, metric, etc.)
-    RoutingTableInfo
-        originalRoutingTableInfo; // a copy of the original routes in the optimizer's format
-
-    // build colorToRouteColor, originalRoutingTableInfo and initial routeInfos in routingTableInfo
+    std::vector<PrefixTrieNode> trie(1);
     for (auto &originalRoute : originalRoutes) {
+        int length = getPrefixLength(originalRoute->getNetmask().getInt());
+        if (length == -1)
+            return; // prefixes cannot describe a non-contiguous netmask, leave the routes as they are
         int color = findRouteIndexWithSameColor(colorToRoute, originalRoute);
         if (color == -1) {
             color = colorToRoute.size();
             colorToRoute.push_back(originalRoute);
         }
-
-        // create original route and determine its color
-        RouteInfo *originalRouteInfo = new RouteInfo(
-            color, originalRoute->getDestination().getInt(), originalRoute->getNetmask().getInt());
-        originalRoutingTableInfo.addRouteInfo(originalRouteInfo);
-
-        // create a copy of the original route that can be destructively optimized later
-        RouteInfo *optimizedRouteInfo = new RouteInfo(*originalRouteInfo);
-        optimizedRouteInfo->originalRouteInfos.push_back(originalRouteInfo);
-        routingTableInfo.addRouteInfo(optimizedRouteInfo);
+        insertPrefix(trie, originalRoute->getDestination().getInt(), length, color);
     }
 
-#ifndef NDEBUG
-    checkOriginalRoutes(routingTableInfo, originalRoutingTableInfo);
-#endif // ifndef NDEBUG
-
     // STEP 2.
-    // from now on we are only working with the internal data structures called RouteInfo and RoutingTableInfo.
-    // the main optimizer loop runs until it cannot merge any two routes.
-    while (tryToMergeAnyTwoRoutes(routingTableInfo))
-        ;
+    // aggregate the prefixes bottom-up, then emit the routes top-down
+    computeColorSets(trie, 0, -1);
+    std::vector<PrefixRoute> prefixRoutes;
+    collectPrefixRoutes(trie, 0, -1, 0, 0, -1, prefixRoutes);
+
+    RoutingTableInfo routingTableInfo;
+    for (auto &prefixRoute : prefixRoutes) {
+        uint32_t netmask = prefixRoute.length == 0 ? 0 : 0xFFFFFFFFu << (32 - prefixRoute.length);
+        routingTableInfo.routeInfos.push_back(
+            new RouteInfo(prefixRoute.color, prefixRoute.destination, netmask));
+    }
+    std::sort(routingTableInfo.routeInfos.begin(), routingTableInfo.routeInfos.end(),
+              RoutingTableInfo::routeInfoLessThan);
 
 #ifndef NDEBUG
+    RoutingTableInfo originalRoutingTableInfo;
+    for (auto &originalRoute : originalRoutes)
+        originalRoutingTableInfo.addRouteInfo(
+            new RouteInfo(findRouteIndexWithSameColor(colorToRoute, originalRoute),
+                          originalRoute->getDestination().getInt(),
+                          originalRoute->getNetmask().getInt()));
     checkOriginalRoutes(routingTableInfo, originalRoutingTableInfo);
-#endif // ifndef NDEBUG
-
     for (auto rti : originalRoutingTableInfo.routeInfos)
         delete rti;
-    originalRoutingTableInfo.routeInfos.clear();
+#endif // ifndef NDEBUG
 
     // STEP 3.
     // convert the optimized routes to new optimized Ipv4 routes based on the saved colors
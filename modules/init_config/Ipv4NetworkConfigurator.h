@@ -239,6 +239,21 @@ protected:
      */
     virtual void addStaticRoutes(Topology &topology, cXMLElement *element);
 
+    /**
+     * Shortest paths from every node to one target, owned by a single worker of addStaticRoutes().
+     */
+    struct ShortestPaths {
+        std::vector<double> dist;     // distance to the target
+        std::vector<Link *> pathLink; // first link on the path towards the target, nullptr if there is none
+        std::vector<int> pathNext;    // index of the node at the other end of pathLink
+    };
+    void calculateShortestPathsTo(const std::vector<Node *> &nodes,
+                                  const std::vector<std::vector<std::pair<int, Link *>>> &inLinks,
+                                  int target, ShortestPaths &paths);
+    void addStaticRoutesOfSource(const std::vector<Node *> &nodes, int sourceIndex,
+                                 const ShortestPaths &paths,
+                                 const std::vector<std::vector<bool>> &destinationInterfaceMatches);
+
     /**
      * Destructively optimizes the given Ipv4 routes by merging some of them.
      * The resulting routes might be different in that they will route packets
@@ -248,6 +263,29 @@ protected:
      */
     virtual void optimizeRoutes(std::vector<Ipv4Route *> &routes);
 
+    /**
+     * Hands the routing tables of routers, the links between routers and the host addresses over to
+     * RlConventionalRoutingTable, so that it can reprogram the routes with the link weights of the agent.
+     */
+    virtual void registerRlTopology(Topology &topology);
+
+    /**
+     * RL routing modes choose the next hop in their own routing tables, so instead of addStaticRoutes only a default
+     * route from every host towards its router is added.
+     */
+    bool isRlRoutingMode() const;
+    virtual void addRlHostRoutes(Topology &topology);
+    void setRlDeviceAddress(InterfaceInfo *interfaceInfo, uint32_t address);
+
+    /**
+     * Caches assigned addresses and static routes in configCacheDir. The cache file is named after a hash of the
+     * extracted topology and its channels, the configuration parameters and the XML configuration, so any change
+     * misses the cache.
+     */
+    uint64_t computeTopologyHash(Topology &topology);
+    bool loadConfigCache(Topology &topology, const std::string &cachePath);
+    void saveConfigCache(Topology &topology, const std::string &cachePath);
+
     void ensureConfigurationComputed(Topology &topology);
     void configureInterface(InterfaceInfo *interfaceInfo);
     void configureRoutingTable(Node *node);
@@ -294,28 +332,14 @@ protected:
     bool containsRoute(const std::vector<Ipv4Route *> &routes, Ipv4Route *route);
     bool routesHaveSameColor(Ipv4Route *route1, Ipv4Route *route2);
     int findRouteIndexWithSameColor(const std::vector<Ipv4Route *> &routes, Ipv4Route *route);
-    bool routesCanBeSwapped(RouteInfo *routeInfo1, RouteInfo *routeInfo2);
-    bool routesCanBeNeighbors(const std::vector<RouteInfo *> &routeInfos, int i, int j);
-    bool interruptsOriginalRoute(const RoutingTableInfo &routingTableInfo, int begin, int end,
-                                 RouteInfo *originalRouteInfo);
-    bool interruptsAnyOriginalRoute(const RoutingTableInfo &routingTableInfo, int begin, int end,
-                                    const std::vector<RouteInfo *> &originalRouteInfos);
-    bool interruptsSubsequentOriginalRoutes(const RoutingTableInfo &routingTableInfo, int index);
     void checkOriginalRoutes(const RoutingTableInfo &routingTableInfo,
                              const RoutingTableInfo &originalRoutingTableInfo);
-    void findLongestCommonDestinationPrefix(uint32_t destination1, uint32_t netmask1,
-                                            uint32_t destination2, uint32_t netmask2,
-                                            uint32_t &destinationOut, uint32_t &netmaskOut);
-    void addOriginalRouteInfos(RoutingTableInfo &routingTableInfo, int begin, int end,
-                               const std::vector<RouteInfo *> &originalRouteInfos);
-    bool tryToMergeTwoRoutes(RoutingTableInfo &routingTableInfo, int i, int j,
-                             RouteInfo *routeInfoI, RouteInfo *routeInfoJ);
-    bool tryToMergeAnyTwoRoutes(RoutingTableInfo &routingTableInfo);
 
     // address resolver interface
     bool getInterfaceIpv4Address(L3Address &ret, NetworkInterface *networkInterface,
                                  bool netmask) override;
     std::string routingMode;
+    std::string configCacheDir;
 };
 
 } // namespace inet
@@ -21,6 +21,7 @@
 #include "inet/common/packet/Message.h"
 #include "inet/common/ProtocolTag_m.h"
 #include "inet/common/ProtocolUtils.h"
+#include "inet/common/Simsignals.h"
 #include "inet/common/socket/SocketTag_m.h"
 #include "inet/linklayer/common/InterfaceTag_m.h"
 #include "inet/linklayer/common/MacAddressTag_m.h"
@@ -49,6 +50,8 @@
 #include "inet/networklayer/ipv4/RlConventionalRoutingTable.h"
 #include "inet/networklayer/ipv4/RlMultipathRoutingTable.h"
 #include "inet/networklayer/ipv4/RlPathRoutingTable.h"
+#include "inet/networklayer/ipv4/RlWeightedShortestPathRoutingTable.h"
+#include "inet/networklayer/ipv4/RlEcmpRoutingTable.h"
 namespace inet
 {
 
@@ -115,6 +118,11 @@ void Ipv4::initialize(int stage)
         cModule *arpModule = check_and_cast<cModule *>(arp.get());
         arpModule->subscribe(IArp::arpResolutionCompletedSignal, this);
         arpModule->subscribe(IArp::arpResolutionFailedSignal, this);
+        // the routes towards the RL hosts are cached, so any route change invalidates them
+        cModule *node = getContainingNode(this);
+        node->subscribe(routeAddedSignal, this);
+        node->subscribe(routeDeletedSignal, this);
+        node->subscribe(routeChangedSignal, this);
 
         registerService(Protocol::ipv4, gate("transportIn"), gate("transportOut"));
         registerProtocol(Protocol::ipv4, gate("queueOut"), gate("queueIn"));
@@ -505,6 +513,33 @@ Ipv4::determineOutgoingInterfaceForMulticastDatagram(const Ptr<const Ipv4Header>
     return ie;
 }
 
+/**
+ * Looks up the route towards every RL host once, so that forwarding in conventional mode reads
+ * the route of a packet by the ID of its destination host. The next hop router is resolved with
+ * the same device names as the statistics of routeUnicastPacket.
+ */
+void Ipv4::buildRlHostRoutes()
+{
+    RlConventionalRoutingTable *rlTable = RlConventionalRoutingTable::getInstance();
+    auto routerIdOf = [rlTable](const string &address) {
+        string device = rlTable->getDeviceNameByAddress(address);
+        return device[0] == 'R' ? atoi(device.c_str() + 2) : -1;
+    };
+    rlRouterId = routerIdOf(rt->getRouterId().str());
+    rlHostRoutes.assign(rlTable->getHostNum(), RlHostRoute());
+    for (int host = 0; host < (int)rlHostRoutes.size(); host++) {
+        Ipv4Address hostAddress = rlTable->getHostAddress(host);
+        if (hostAddress.isUnspecified())
+            continue;
+        const Ipv4Route *re = rt->findBestMatchingRoute(hostAddress);
+        if (!re)
+            continue;
+        rlHostRoutes[host].ie = re->getInterface();
+        rlHostRoutes[host].gateway = re->getGateway();
+        rlHostRoutes[host].nextRouter = routerIdOf(re->getNextHopAsGeneric().str());
+    }
+}
+
 void Ipv4::routeUnicastPacket(Packet *packet)
 {
     const NetworkInterface *fromIE = getSourceInterface(packet);
@@ -532,7 +567,7 @@ void Ipv4::routeUnicastPacket(Packet *packet)
         }
     } else {
         const char *pktName = packet->getFullName();
-        if (regex_search(pktName, regex("probabilistic|multipath|singlepath"))) {
+        if (regex_search(pktName, regex("probabilistic|multipath|singlepath|weighted|ecmp"))) {
             string modulePath = getParentModule()->getFullPath();
             pair<string, int> routePair;
             unordered_map<string, function<pair<string, int>(const string &, Packet *)>> routeMap =
@@ -551,6 +586,15 @@ void Ipv4::routeUnicastPacket(Packet *packet)
                      [](const string &modulePath, Packet *packet) {
                          return RlPathRoutingTable::getInstance()->getRoute(modulePath, packet);
                      }},
+                    {"weighted",
+                     [](const string &modulePath, Packet *packet) {
+                         return RlWeightedShortestPathRoutingTable::getInstance()->getRoute(
+                             modulePath, packet);
+                     }},
+                    {"ecmp",
+                     [](const string &modulePath, Packet *packet) {
+                         return RlEcmpRoutingTable::getInstance()->getRoute(modulePath, packet);
+                     }},
                 };
 
             unordered_map<string, function<void(const string &, Packet *)>> countMap = {
@@ -566,12 +610,24 @@ void Ipv4::routeUnicastPacket(Packet *packet)
                  [](const string &modulePath, Packet *packet) {
                      RlPathRoutingTable::getInstance()->countPktInNode(modulePath, packet);
                  }},
+                {"weighted",
+                 [](const string &modulePath, Packet *packet) {
+                     RlWeightedShortestPathRoutingTable::getInstance()->countPktInNode(modulePath,
+                                                                                      packet);
+                 }},
+                {"ecmp",
+                 [](const string &modulePath, Packet *packet) {
+                     RlEcmpRoutingTable::getInstance()->countPktInNode(modulePath, packet);
+                 }},
             };
 
             string pktNameStr(pktName);
             for (const auto& routeType : routeMap) {
                 if (pktNameStr.find(routeType.first) != string::npos) {
-                    routePair = routeType.second(modulePath, packet);
+                    {
+                        RlProfileScope scope(PROFILE_LOOKUP);
+                        routePair = routeType.second(modulePath, packet);
+                    }
                     if (pktNameStr.find("distributed") != string::npos) {
                         countMap[routeType.first](modulePath, packet);
                     }
@@ -592,25 +648,46 @@ void Ipv4::routeUnicastPacket(Packet *packet)
         }
         // conventional routing protocols
         else {
-            const Ipv4Route *re = rt->findBestMatchingRoute(destAddr);
-            if (re) {
-                // statistical status information
-                string srcDevice =
-                    RlConventionalRoutingTable::getInstance()->getDeviceNameByAddress(
-                        rt->getRouterId().str());
-                string nextHopDevice =
-                    RlConventionalRoutingTable::getInstance()->getDeviceNameByAddress(
-                        re->getNextHopAsGeneric().str());
-                if (srcDevice[0] == 'R' && nextHopDevice[0] == 'R') {
-                    srcDevice.erase(srcDevice.begin(), srcDevice.begin() + 2);
-                    nextHopDevice.erase(nextHopDevice.begin(), nextHopDevice.begin() + 2);
-                    RlConventionalRoutingTable::getInstance()->countPkct(
-                        atoi(srcDevice.c_str()), atoi(nextHopDevice.c_str()),
-                        int(packet->getBitLength()));
+            RlConventionalRoutingTable *rlTable = RlConventionalRoutingTable::getInstance();
+            int hostId = rlTable ? rlTable->getHostId(destAddr) : -1;
+            if (hostId != -1) {
+                // RL traffic is always addressed to a host, so its route is read from the cache
+                if (rlHostRoutes.empty())
+                    buildRlHostRoutes();
+                const RlHostRoute &hostRoute = rlHostRoutes[hostId];
+                if (hostRoute.ie) {
+                    if (rlRouterId != -1 && hostRoute.nextRouter != -1)
+                        rlTable->countPkct(rlRouterId, hostRoute.nextRouter,
+                                           int(packet->getBitLength()));
+                    destIE = hostRoute.ie;
+                    packet->addTagIfAbsent<InterfaceReq>()->setInterfaceId(
+                        destIE->getInterfaceId());
+                    packet->addTagIfAbsent<NextHopAddressReq>()->setNextHopAddress(
+                        hostRoute.gateway);
+                }
+            } else {
+                const Ipv4Route *re = rt->findBestMatchingRoute(destAddr);
+                if (re) {
+                    // statistical status information
+                    string srcDevice =
+                        RlConventionalRoutingTable::getInstance()->getDeviceNameByAddress(
+                            rt->getRouterId().str());
+                    string nextHopDevice =
+                        RlConventionalRoutingTable::getInstance()->getDeviceNameByAddress(
+                            re->getNextHopAsGeneric().str());
+                    if (srcDevice[0] == 'R' && nextHopDevice[0] == 'R') {
+                        srcDevice.erase(srcDevice.begin(), srcDevice.begin() + 2);
+                        nextHopDevice.erase(nextHopDevice.begin(), nextHopDevice.begin() + 2);
+                        RlConventionalRoutingTable::getInstance()->countPkct(
+                            atoi(srcDevice.c_str()), atoi(nextHopDevice.c_str()),
+                            int(packet->getBitLength()));
+                    }
+                    destIE = re->getInterface();
+                    packet->addTagIfAbsent<InterfaceReq>()->setInterfaceId(
+                        destIE->getInterfaceId());
+                    packet->addTagIfAbsent<NextHopAddressReq>()->setNextHopAddress(
+                        re->getGateway());
                 }
-                destIE = re->getInterface();
-                packet->addTagIfAbsent<InterfaceReq>()->setInterfaceId(destIE->getInterfaceId());
-                packet->addTagIfAbsent<NextHopAddressReq>()->setNextHopAddress(re->getGateway());
             }
         }
     }
@@ -1459,6 +1536,10 @@ void Ipv4::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj,
     if (signalID == IArp::arpResolutionFailedSignal) {
         arpResolutionTimedOut(check_and_cast<IArp::Notification *>(obj));
     }
+    if (signalID == routeAddedSignal || signalID == routeDeletedSignal
+        || signalID == routeChangedSignal) {
+        rlHostRoutes.clear();
+    }
 }
 
 void Ipv4::sendIcmpError(Packet *origPacket, int inputInterfaceId, IcmpType type, IcmpCode code)
@@ -111,6 +111,15 @@ protected:
     typedef std::list<QueuedDatagramForHook> DatagramQueueForHooks;
     DatagramQueueForHooks queuedDatagramsForHooks;
 
+    // conventional mode: route of this node towards each RL host, indexed by the host ID
+    struct RlHostRoute {
+        const NetworkInterface *ie = nullptr;
+        Ipv4Address gateway;
+        int nextRouter = -1; // ID of the next hop router, -1 if the next hop is not a router
+    };
+    std::vector<RlHostRoute> rlHostRoutes; // empty until the first lookup after a route change
+    int rlRouterId = -1;                   // ID of this router, -1 on hosts
+
 protected:
     // utility: look up interface from getArrivalGate()
     virtual const NetworkInterface *getSourceInterface(Packet *packet);
@@ -121,6 +130,9 @@ protected:
     virtual const NetworkInterface *
     getShortestPathInterfaceToSource(const Ptr<const Ipv4Header> &ipv4Header) const;
 
+    // utility: rebuild the routes towards the RL hosts from the routing table
+    void buildRlHostRoutes();
+
     // utility: show current statistics above the icon
     virtual void refreshDisplay() const override;
 
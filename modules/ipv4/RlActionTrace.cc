@@ -0,0 +1,210 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 23:27:45
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 23:27:45
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlActionTrace.cc
+ * @Description  : Recording of the replies of an agent and their replay without the agent in RouterRL.
+ */
+#include "RlActionTrace.h"
+#include "RlLogger.h"
+#include <cstdlib>
+#include <cstring>
+#include <omnetpp.h>
+#include <pthread.h>
+
+using namespace omnetpp;
+
+RlActionTrace *RlActionTrace::actionTrace = NULL;
+
+/**
+ * @brief Initialize the action trace, only the first call creates it
+ *
+ * @param file_v    Trace file
+ * @param mode_v    ACTION_TRACE_RECORD or ACTION_TRACE_REPLAY
+ * @param check_v   Comparison of the replayed rewards, ACTION_CHECK_NONE, ACTION_CHECK_WARN or ACTION_CHECK_ERROR
+ * @param nodeNum_v Number of nodes, must match the trace when replaying
+ * @return RlActionTrace* Action trace
+ */
+RlActionTrace *RlActionTrace::initTrace(string file_v, int mode_v, int check_v, int nodeNum_v)
+{
+    if (!actionTrace) {
+        pthread_atfork(&RlActionTrace::beforeFork, NULL, NULL);
+        atexit(&RlActionTrace::atExit);
+        actionTrace = new RlActionTrace(file_v, mode_v, check_v, nodeNum_v);
+    }
+    return actionTrace;
+}
+
+RlActionTrace::RlActionTrace(string file_v, int mode_v, int check_v, int nodeNum_v)
+    : traceFile(file_v), file(file_v), mode(mode_v), check(check_v), nodeNum(nodeNum_v)
+{
+    if (mode == ACTION_TRACE_REPLAY)
+        load();
+    else
+        openFile(file);
+}
+
+/**
+ * @brief Open a trace file to record and write its header
+ *
+ * @param path  Trace file
+ */
+void RlActionTrace::openFile(const string &path)
+{
+    output.open(path, ios::out | ios::trunc | ios::binary);
+    if (!output)
+        throw cRuntimeError("Cannot write the action trace '%s'", path.c_str());
+    traceFile.setOpened();
+    RlActionTraceHeader header = {RL_ACTION_TRACE_MAGIC, RL_ACTION_TRACE_VERSION, (uint32_t)nodeNum, 0};
+    output.write((const char *)&header, sizeof(header));
+}
+
+/**
+ * @brief Load the replies and the requests of a trace file to replay
+ *
+ */
+void RlActionTrace::load()
+{
+    ifstream input(file, ios::binary);
+    if (!input)
+        throw cRuntimeError("Cannot read the action trace '%s'", file.c_str());
+    RlActionTraceHeader header;
+    if (!input.read((char *)&header, sizeof(header)) || header.magic != RL_ACTION_TRACE_MAGIC ||
+        header.version != RL_ACTION_TRACE_VERSION)
+        throw cRuntimeError("'%s' is not a version %d action trace", file.c_str(), RL_ACTION_TRACE_VERSION);
+    if ((int)header.nodeNum != nodeNum)
+        throw cRuntimeError("The action trace '%s' was recorded with %u nodes, the network has %d", file.c_str(),
+                            header.nodeNum, nodeNum);
+
+    RlActionTraceEntry entry;
+    while (input.read((char *)&entry, sizeof(entry))) {
+        string data(entry.size, '\0');
+        // An entry cut by a stopped recording ends the trace
+        if (!input.read(&data[0], entry.size))
+            break;
+        if (entry.kind == 'd') {
+            replies.push_back(move(data));
+        } else {
+            if (entry.replyId >= replies.size())
+                throw cRuntimeError("The action trace '%s' is corrupted", file.c_str());
+            requests[requestKey(entry.kind, entry.step)] = make_pair(entry.replyId, move(data));
+        }
+    }
+}
+
+void RlActionTrace::writeEntry(char kind, int step, uint32_t replyId, const string &data)
+{
+    RlActionTraceEntry entry = {kind, {0, 0, 0}, step, replyId, (uint32_t)data.size()};
+    output.write((const char *)&entry, sizeof(entry));
+    output.write(data.data(), data.size());
+}
+
+/**
+ * @brief Write a request and the reply of the agent, the reply only once for all the requests it answers
+ *
+ * @param request   Request sent to the agent, "kind@@step@@data"
+ * @param reply     Final reply of the agent
+ */
+void RlActionTrace::record(const string &request, const string &reply)
+{
+    if (traceFile.isStale())
+        continueAfterFork();
+    auto known = replyIds.find(reply);
+    uint32_t replyId;
+    if (known == replyIds.end()) {
+        replyId = replyIds.size();
+        replyIds[reply] = replyId;
+        writeEntry('d', -1, replyId, reply);
+    } else {
+        replyId = known->second;
+    }
+    char kind = request[0];
+    size_t dataStart = request.find("@@", 3);
+    string reward = (kind == 'r' && dataStart != string::npos) ? request.substr(dataStart + 2) : "";
+    writeEntry(kind, atoi(request.c_str() + 3), replyId, reward);
+    // The trace is complete up to the last reward if the simulation is stopped
+    if (kind == 'r')
+        output.flush();
+}
+
+/**
+ * @brief Answer a request with the recorded reply, and compare its reward with the recorded one
+ *
+ * @param request   Request of the simulation, "kind@@step@@data"
+ * @return string   Reply recorded for the same kind of request and step
+ */
+string RlActionTrace::replay(const string &request)
+{
+    char kind = request[0];
+    int step = atoi(request.c_str() + 3);
+    auto recorded = requests.find(requestKey(kind, step));
+    if (recorded == requests.end())
+        throw cRuntimeError("The action trace '%s' has no reply to the '%c' request of step %d", file.c_str(), kind,
+                            step);
+
+    if (kind == 'r' && check != ACTION_CHECK_NONE) {
+        size_t dataStart = request.find("@@", 3);
+        string reward = dataStart != string::npos ? request.substr(dataStart + 2) : "";
+        if (reward != recorded->second.second) {
+            if (check == ACTION_CHECK_ERROR)
+                throw cRuntimeError("The reward of step %d differs from the action trace: %s instead of %s", step,
+                                    reward.c_str(), recorded->second.second.c_str());
+            if (mismatchNum++ == 0)
+                RlLogger::log(LOG_WARN, "Action trace: the reward of step " + to_string(step) +
+                                            " differs from the trace: " + reward + " instead of " +
+                                            recorded->second.second);
+        }
+    }
+    return replies[recorded->second.first];
+}
+
+/**
+ * @brief Write the recorded entries before a fork, so that they are only written once in the file of the parent
+ *
+ */
+void RlActionTrace::beforeFork()
+{
+    if (actionTrace && !actionTrace->isReplaying())
+        actionTrace->output.flush();
+}
+
+/**
+ * @brief Continue the recording of a child process created by fork() in its own file, before its first record: a copy
+ * of the trace of the parent until the fork
+ *
+ */
+void RlActionTrace::continueAfterFork()
+{
+    // The entries of the parent were flushed before the fork, and the parent may have recorded more since
+    streamoff forkedSize = output.tellp();
+    ifstream parent(file, ios::binary);
+    string content(forkedSize, '\0');
+    if (!parent.read(&content[0], forkedSize))
+        throw cRuntimeError("Cannot read the action trace '%s' of the parent", file.c_str());
+    string childFile = traceFile.getPath();
+    ofstream child(childFile, ios::out | ios::trunc | ios::binary);
+    if (!child)
+        throw cRuntimeError("Cannot write the action trace '%s'", childFile.c_str());
+    child.write(content.data(), content.size());
+    // Closes the file of the parent
+    output = move(child);
+    traceFile.setOpened();
+    file = childFile;
+}
+
+/**
+ * @brief Write the last entries of a recording, or the number of differing rewards of a replay, at the exit of the
+ * process
+ *
+ */
+void RlActionTrace::atExit()
+{
+    if (!actionTrace)
+        return;
+    if (!actionTrace->isReplaying())
+        actionTrace->output.flush();
+    else if (actionTrace->mismatchNum)
+        RlLogger::logAtExit(LOG_WARN, "Action trace: " + to_string(actionTrace->mismatchNum) +
+                                    " rewards differ from the trace");
+}
@@ -0,0 +1,103 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 23:27:45
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 23:27:45
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlActionTrace.h
+ * @Description  : Recording of the replies of an agent and their replay without the agent in RouterRL.
+ */
+#ifndef RLACTIONTRACE_H
+#define RLACTIONTRACE_H
+#include "RlForkedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define RL_ACTION_TRACE_MAGIC   0x54414c52 // "RLAT"
+#define RL_ACTION_TRACE_VERSION 1
+
+#define ACTION_TRACE_RECORD 0 // Requests are sent to the agent, its replies are written to the trace
+#define ACTION_TRACE_REPLAY 1 // Requests are answered from the trace, no agent is needed
+
+#define ACTION_CHECK_NONE  0 // Rewards are not compared with the trace
+#define ACTION_CHECK_WARN  1 // Rewards that differ from the trace are counted, the first one is printed
+#define ACTION_CHECK_ERROR 2 // A reward that differs from the trace stops the simulation
+
+/**
+ * Action trace layout (little-endian), a stream of entries in the order of the requests:
+ *   RlActionTraceHeader                magic, version, nodeNum, reserved
+ *   RlActionTraceEntry + data[size]    kind 'd': a new reply, numbered from 0 in the order of the file, data is the reply
+ *                                      kind 's', 'r' or 'c': request of a step answered by the reply replyId, data is
+ *                                      the reward of the request for 'r' and empty otherwise
+ * Identical replies are stored once and referenced by the later requests they answer, which only shrinks the traces
+ * of policies that repeat their replies, e.g. fixed baselines. Otherwise every reply is stored in full, plus an entry of
+ * 16 bytes per request.
+ */
+struct RlActionTraceHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeNum;
+    uint32_t reserved;
+};
+
+struct RlActionTraceEntry {
+    char kind;
+    char reserved[3];
+    int32_t step;
+    uint32_t replyId;
+    uint32_t size;
+};
+
+/**
+ * While recording, every request of exchange() and the final reply of the agent are written, forks included. While
+ * replaying, the trace is loaded at start and exchange() takes the reply recorded for the same request kind and step,
+ * so that the simulation runs without the agent and without ZMQ. Replayed rewards are compared with the recorded ones,
+ * which differ if the simulation is not deterministic or does not have the configuration of the recorded run.
+ * There is only a single global static object, and none when the action trace is off. While recording, a child process
+ * created by fork() writes its own trace file, see RlForkedFile. It starts with the trace of the parent until the fork,
+ * so that the episode of the child can be replayed from its start.
+ */
+class RlActionTrace
+{
+public:
+    static RlActionTrace *getInstance() { return actionTrace; }
+
+    /**
+     * Used to initialize the unique static instance, opens the trace file to record or loads it to replay.
+     */
+    static RlActionTrace *initTrace(string file_v, int mode_v, int check_v, int nodeNum_v);
+
+    bool isReplaying() const { return mode == ACTION_TRACE_REPLAY; }
+    void record(const string &request, const string &reply);
+    string replay(const string &request);
+
+protected:
+    RlActionTrace(string file_v, int mode_v, int check_v, int nodeNum_v);
+    static void beforeFork();
+    static void atExit();
+    static long long requestKey(char kind, int step) { return ((long long)step << 8) | (unsigned char)kind; }
+    void openFile(const string &path);
+    void load();
+    void writeEntry(char kind, int step, uint32_t replyId, const string &data);
+    void continueAfterFork();
+
+    RlForkedFile traceFile;
+    string file;                                                   // File being recorded or replayed
+    int mode;
+    int check;
+    int nodeNum;
+    ofstream output;
+    unordered_map<string, uint32_t> replyIds;                      // Recorded replies, to their ID
+    vector<string> replies;                                        // Replayed replies, by ID
+    unordered_map<long long, pair<uint32_t, string>> requests;     // Replayed (reply ID, reward) of each request
+    long long mismatchNum = 0;                                     // Replayed rewards that differ from the trace
+
+private:
+    static RlActionTrace *actionTrace;
+};
+
+#endif // RLACTIONTRACE_H
@@ -7,6 +7,13 @@
  * @Description  : Basic routing tabel in RouterRL
  */
 #include "RlBasicRoutingTable.h"
+#include "RlThreadPool.h"
+#include <cerrno>
+#include <climits>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define FORK_REQUEST "fork@@" // Reply of the agent asking to fork the simulation, followed by the ports of the children
 
 /**
  * @brief Construct a new routing table
@@ -29,6 +36,7 @@ RlBasicRoutingTable::~RlBasicRoutingTable()
         zmq_context->close();
         delete zmq_context;
     }
+    reapForks();
 }
 
 /**
@@ -37,17 +45,15 @@ RlBasicRoutingTable::~RlBasicRoutingTable()
  */
 void RlBasicRoutingTable::initiate()
 {
-    zmq_context = new zmq::context_t(1);
-    zmq_socket = new zmq::socket_t(*zmq_context, zmq::socket_type::req);
-    std::string addr = "tcp://127.0.0.1:" + std::to_string(zmqPort);
-    std::cout << "ZeroMQ: Connect to " << addr << std::endl;
-    zmq_socket->setsockopt(ZMQ_LINGER, 0);
-    zmq_socket->connect(addr);
+    RlActionTrace *actionTrace = RlActionTrace::getInstance();
+    if (!actionTrace || !actionTrace->isReplaying())
+        connectAgent();
 
     topo = (int **)malloc(nodeNum * sizeof(int *));
-    memset(topo, 0, nodeNum);
+    memset(topo, 0, nodeNum * sizeof(int *));
     int *tmp = (int *)malloc(nodeNum * nodeNum * sizeof(int));
-    memset(tmp, 0, nodeNum * nodeNum);
+    // No link until the table reads its topology, all bytes 0xff make every entry -1
+    memset(tmp, 0xff, nodeNum * nodeNum * sizeof(int));
     for (int i = 0; i < nodeNum; i++) {
         topo[i] = tmp + nodeNum * i;
     }
@@ -78,11 +84,17 @@ void RlBasicRoutingTable::initiate()
     pkNumOfStep = (int *)malloc(totalStep * sizeof(int));
     memset(pkNumOfStep, 0, totalStep * sizeof(int));
 
+    pkArrivedOfStep = (int *)malloc(totalStep * sizeof(int));
+    memset(pkArrivedOfStep, 0, totalStep * sizeof(int));
+
+    delaySumOfStep = (double *)malloc(totalStep * sizeof(double));
+    memset(delaySumOfStep, 0, totalStep * sizeof(double));
+
     if (returnMode == 1) {
         for (int i = 0; i < totalStep; i++) {
-            vector<unordered_set<int> *> nvec;
+            vector<unordered_map<int, int> *> nvec;
             for (int j = 0; j < nodeNum; j++) {
-                unordered_set<int> *nuset = new unordered_set<int>;
+                unordered_map<int, int> *nuset = new unordered_map<int, int>;
                 nvec.push_back(nuset);
             }
             pktInNode.push_back(nvec);
@@ -163,7 +175,8 @@ int RlBasicRoutingTable::getNextNode(int nodeId, int srcNode, int dstNode)
  */
 void RlBasicRoutingTable::countPkct(int src, int dst, int pkBit)
 {
-    pkct[src][dst] += pkBit;
+    // Saturated rather than wrapped around when the fluid model adds the load of a fast link
+    pkct[src][dst] = (int)min((long long)pkct[src][dst] + pkBit, (long long)INT_MAX);
 }
 
 /**
@@ -222,6 +235,38 @@ void RlBasicRoutingTable::clearPkts()
         }
 }
 
+/**
+ * @brief Keep the link loads of the state of a step in the results file and in the dataset, before they are cleared
+ *
+ * @param step      Step of the state
+ * @param stepTime  Duration of the step
+ */
+void RlBasicRoutingTable::recordLinkLoads(int step, double stepTime)
+{
+    if (RlResultsWriter *results = RlResultsWriter::getInstance())
+        results->recordState(step, pkct, stepTime);
+    if (RlDatasetWriter *dataset = RlDatasetWriter::getInstance())
+        dataset->recordState(step, pkct, stepTime);
+}
+
+/**
+ * @brief Keep the reward of a step in the results file and in the dataset
+ *
+ * @param step      Step of the reward
+ * @param delay     Global average delay
+ * @param loss      Global loss rate
+ * @param delays    Average delay of each node or OD pair in distributed mode, empty in global mode
+ * @param losses    Loss rate of each node or OD pair in distributed mode, empty in global mode
+ */
+void RlBasicRoutingTable::recordReward(int step, double delay, double loss, const vector<double> &delays,
+                                       const vector<double> &losses)
+{
+    if (RlResultsWriter *results = RlResultsWriter::getInstance())
+        results->recordReward(step, delay, loss, delays, losses);
+    if (RlDatasetWriter *dataset = RlDatasetWriter::getInstance())
+        dataset->recordReward(step, delay, loss, delays, losses);
+}
+
 /**
  * @brief Record the number of packets
  *
@@ -273,7 +318,7 @@ void RlBasicRoutingTable::countPktInNode(string path, Packet *packet)
 
     int step = packet->par("step").longValue();
     int pktId = packet->par("id").longValue();
-    (*pktInNode[step][thisNodeId]).insert(pktId);
+    (*pktInNode[step][thisNodeId])[pktId] = getPacketWeight(packet);
 }
 
 /**
@@ -287,21 +332,123 @@ void RlBasicRoutingTable::countPktDelay(Packet *packet, double delay)
 {
     int pktId = packet->par("id").longValue();
     int step = packet->par("step").longValue();
-    // If delayWithStep[step] is empty, initialize delayWithStep[step] with the current delay as the first element
-    if (delayWithStep.size() < (step + 1)) {
-        vector<double> delayVec;
-        delayVec.push_back(delay);
-        delayWithStep.push_back(delayVec);
-    }
-    // If delayWithStep[step] already has values, insert directly
-    else {
-        delayWithStep[step].push_back(delay);
-    }
+    int weight = getPacketWeight(packet);
+    // A packet train stands for weight packets that all have its delay
+    pkArrivedOfStep[step] += weight;
+    delaySumOfStep[step] += delay * weight;
     if (returnMode == 1) {
         (*pktDelay[step])[pktId] = delay;
     }
 }
 
+/**
+ * @brief Get the number of packets a simulated packet stands for, more than 1 for the packet trains of RlUdpApp
+ *
+ * @param packet    Packet information
+ * @return int      Number of packets carried by the packet
+ */
+int RlBasicRoutingTable::getPacketWeight(Packet *packet)
+{
+    return packet->hasPar("weight") ? packet->par("weight").longValue() : 1;
+}
+
+/**
+ * @brief Get the share of the traffic of an OD pair at a node sent to each next node, the single next hop of the table by default
+ *
+ * @param nodeId    ID of the current node
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @param split     (next node, share) of the traffic, empty if the destination is unreachable
+ */
+void RlBasicRoutingTable::getSplitRatios(int nodeId, int srcNode, int dstNode,
+                                         vector<pair<int, double>> &split)
+{
+    split.clear();
+    int nextNode = getNextNode(nodeId, srcNode, dstNode);
+    if (nextNode >= 0 && nextNode < nodeNum)
+        split.push_back(make_pair(nextNode, 1.0));
+}
+
+/**
+ * @brief Get the paths of an OD pair with the share of its traffic, none by default since tables route hop by hop
+ *
+ * @param srcNode       ID of the source node
+ * @param dstNode       ID of the destination node
+ * @param flowNum       Number of flows of the OD pair
+ * @param fluidPaths    (node sequence, share) of each path
+ */
+void RlBasicRoutingTable::getFluidPaths(int srcNode, int dstNode, int flowNum,
+                                        vector<pair<vector<int>, double>> &fluidPaths)
+{
+    fluidPaths.clear();
+}
+
+/**
+ * @brief Add fractional packets to a running sum, and get the whole packets it adds once rounded, so that the rounding
+ * error of a counter stays below half a packet however many OD pairs add to it
+ *
+ * @param sum       Running sum of the counter
+ * @param packets   Packets to add
+ * @return int      Whole packets to add to the counter
+ */
+static int addRounded(double &sum, double packets)
+{
+    long before = lround(sum);
+    sum += packets;
+    return lround(sum) - before;
+}
+
+/**
+ * @brief Count the packets of an OD pair solved by the fluid model. In distributed mode, the pair stands for two packets, one for
+ * its received packets and one for its lost packets, that pass through each router with the number of packets of the pair there
+ *
+ * @param step      Step number
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @param sent      Packets sent by the pair during the step
+ * @param arrived   Packets of the pair received
+ * @param delay     Mean delay of the received packets
+ * @param nodePass  Packets of the pair passing through each router
+ */
+void RlBasicRoutingTable::countFluidDemand(int step, int srcNode, int dstNode, double sent,
+                                           double arrived, double delay,
+                                           const vector<double> &nodePass)
+{
+    countFluidPackets(step, sent, arrived, delay);
+    if (returnMode == 1) {
+        FluidCount &count = fluidCounts[step];
+        if (count.arrivedPass.empty()) {
+            count.arrivedPass.assign(nodeNum, 0);
+            count.lostPass.assign(nodeNum, 0);
+        }
+        int arrivedId = getSendId(), lostId = getSendId();
+        (*pktDelay[step])[arrivedId] = delay;
+        for (int i = 0; i < nodeNum; i++) {
+            if (nodePass[i] <= 0)
+                continue;
+            double arrivedPass = nodePass[i] * arrived / sent;
+            (*pktInNode[step][i])[arrivedId] = addRounded(count.arrivedPass[i], arrivedPass);
+            (*pktInNode[step][i])[lostId] = addRounded(count.lostPass[i], nodePass[i] - arrivedPass);
+        }
+    }
+}
+
+/**
+ * @brief Count the sent and received packets of an OD pair solved by the fluid model in the global counters of a step
+ *
+ * @param step      Step number
+ * @param sent      Packets sent by the pair during the step
+ * @param arrived   Packets of the pair received
+ * @param delay     Mean delay of the received packets
+ */
+void RlBasicRoutingTable::countFluidPackets(int step, double sent, double arrived, double delay)
+{
+    FluidCount &count = fluidCounts[step];
+    pkNumOfStep[step] += addRounded(count.sent, sent);
+    pkArrivedOfStep[step] += addRounded(count.arrived, arrived);
+    delaySumOfStep[step] += delay * arrived;
+}
+
 /**
  * @brief Determine if the current step is finished
  *
@@ -312,9 +459,8 @@ void RlBasicRoutingTable::stepOverJudge(int step, double currentTime)
 {
     // Determine if all packets for this step have been sent and notify the RL side
     if (stepIsEnd[step] && (!stepFinished[step])) {
-        if (delayWithStep[step].size() == pkNumOfStep[step]) {
-            endStep(step);
-            delayWithStep[step].clear();
+        if (pkArrivedOfStep[step] == pkNumOfStep[step]) {
+            finishStep(step);
         }
     }
 
@@ -322,8 +468,9 @@ void RlBasicRoutingTable::stepOverJudge(int step, double currentTime)
     for (int formerStep = 0; formerStep <= step; formerStep++) {
         double timePast = currentTime - stepEndTime[formerStep];
         if (stepIsEnd[formerStep] && (timePast >= overTime) && (!stepFinished[formerStep])) {
-            endStep(formerStep);
-            delayWithStep[formerStep].clear();
+            if (RlTracer *tracer = RlTracer::getInstance())
+                tracer->instant("timeout", formerStep);
+            finishStep(formerStep);
         }
     }
 }
@@ -337,32 +484,30 @@ void RlBasicRoutingTable::endStep(int step)
 {
     string reqStr = "r@@" + to_string(step) + "@@";
 
+    vector<double> nodeDelays, nodeLosses;
     if (returnMode == 1) {
         vector<int> pktPass(nodeNum, 0);
         vector<int> pktArrive(nodeNum, 0);
-        vector<vector<double>> delays;
+        vector<double> delaySums(nodeNum, 0.0);
         for (int i = 0; i < nodeNum; i++) {
-            vector<double> nvec;
-            for (int pktId : (*pktInNode[step][i])) {
-                if ((*pktDelay[step]).count(pktId)) {
-                    nvec.push_back((*pktDelay[step])[pktId]);
-                    pktArrive[i]++;
+            // Packet trains are weighted by the number of packets they stand for
+            for (auto &pkt : (*pktInNode[step][i])) {
+                auto delay = (*pktDelay[step]).find(pkt.first);
+                if (delay != (*pktDelay[step]).end()) {
+                    delaySums[i] += delay->second * pkt.second;
+                    pktArrive[i] += pkt.second;
                 }
-                pktPass[i]++;
+                pktPass[i] += pkt.second;
             }
-
-            delays.push_back(nvec);
         }
         for (int i = 0; i < nodeNum; i++) {
-            double sum = 0.0;
-            for (int j = 0; j < delays[i].size(); j++) {
-                sum += delays[i][j];
-            }
-            double avgDelay = (delays[i].size() == 0) ? 0.0 : (sum / delays[i].size());
+            double avgDelay = (pktArrive[i] == 0) ? 0.0 : (delaySums[i] / pktArrive[i]);
 
             double lossRate = 1.0 - (double)(pktArrive[i]) / (double)(pktPass[i]);
 
             reqStr += to_string(avgDelay) + "," + to_string(lossRate) + "/";
+            nodeDelays.push_back(avgDelay);
+            nodeLosses.push_back(lossRate);
         }
         for (int i = 0; i < nodeNum; i++) {
             pktInNode[step][i]->clear();
@@ -371,30 +516,189 @@ void RlBasicRoutingTable::endStep(int step)
     }
 
     double globalAvgDelay = 0.0;
-    if (delayWithStep[step].size()) {
-        for (int i = 0; i < delayWithStep[step].size(); i++) {
-            globalAvgDelay += delayWithStep[step][i];
-        }
-
-        globalAvgDelay /= delayWithStep[step].size();
-    }
+    if (pkArrivedOfStep[step])
+        globalAvgDelay = delaySumOfStep[step] / pkArrivedOfStep[step];
     double globalLossRate = 1.0;
     if (pkNumOfStep[step] != 0)
-        globalLossRate -= (double)(delayWithStep[step].size()) / (double)(pkNumOfStep[step]);
+        globalLossRate -= (double)(pkArrivedOfStep[step]) / (double)(pkNumOfStep[step]);
     // The final data is global information
     reqStr += to_string(globalAvgDelay) + "," + to_string(globalLossRate);
 
-    std::cout << reqStr << std::endl;
+    exchange(reqStr);
+    recordReward(step, globalAvgDelay, globalLossRate, nodeDelays, nodeLosses);
+
+    stepFinished[step] = true;
+}
+
+/**
+ * @brief End a step, the time spent in endStep is charged to messages in the step profile, except the wait for the agent,
+ * and the reward is traced once it is sent
+ *
+ * @param step The step to be ended
+ */
+void RlBasicRoutingTable::finishStep(int step)
+{
+    {
+        RlProfileScope scope(PROFILE_MESSAGES);
+        RlTraceScope trace("endStep", step);
+        endStep(step);
+    }
+    fluidCounts.erase(step);
+    if (RlStepProfiler *profiler = RlStepProfiler::getInstance())
+        profiler->endStep(step, getSimulation()->getEventNumber());
+    if (RlTracer *tracer = RlTracer::getInstance()) {
+        tracer->instant("reward", step);
+        tracer->flush();
+    }
+}
+
+/**
+ * @brief Establish ZMQ communication with the Python side on zmqPort
+ *
+ */
+void RlBasicRoutingTable::connectAgent()
+{
+    zmq_context = new zmq::context_t(1);
+    zmq_socket = new zmq::socket_t(*zmq_context, zmq::socket_type::req);
+    std::string addr = "tcp://127.0.0.1:" + std::to_string(zmqPort);
+    RlLogger::log(LOG_INFO, "ZeroMQ: Connect to " + addr);
+    zmq_socket->setsockopt(ZMQ_LINGER, 0);
+    zmq_socket->connect(addr);
+}
 
-    const char *reqData = reqStr.c_str();
-    const size_t reqLen = strlen(reqData);
-    zmq::message_t request{reqLen};
-    memcpy(request.data(), reqData, reqLen);
+/**
+ * @brief Send a request to the ZMQ server (Python side) and wait for its reply
+ *
+ * @param msg       Request message
+ * @return string   Reply message
+ */
+string RlBasicRoutingTable::sendRequest(const string &msg)
+{
+    RlProfileScope scope(PROFILE_AGENT);
+    RlTraceScope trace(msg[0] == 's' ? "agent: state/action" : (msg[0] == 'r' ? "agent: reward" : "agent"));
+    zmq::message_t request{msg.size()};
+    memcpy(request.data(), msg.data(), msg.size());
     zmq_socket->send(request, zmq::send_flags::none);
+
     zmq::message_t reply;
     auto res = zmq_socket->recv(reply, zmq::recv_flags::none);
+    return string(static_cast<const char *>(reply.data()), reply.size());
+}
 
-    stepFinished[step] = true;
+/**
+ * @brief Send a request to the ZMQ server (Python side) and wait for its reply. Fork requests of the agent are served
+ * until it replies to the request itself, so every process sees the same request and gets its own reply. Both are
+ * logged at the debug level. With an action trace, the reply is recorded, or replayed without the agent
+ *
+ * @param msg       Request message
+ * @return string   Reply message
+ */
+string RlBasicRoutingTable::exchange(const string &msg)
+{
+    RlLogger::log(LOG_DEBUG, msg);
+    RlActionTrace *actionTrace = RlActionTrace::getInstance();
+    string reply;
+    if (actionTrace && actionTrace->isReplaying()) {
+        reply = actionTrace->replay(msg);
+    } else {
+        reapForks();
+        reply = sendRequest(msg);
+        while (reply.compare(0, strlen(FORK_REQUEST), FORK_REQUEST) == 0) {
+            forkSimulation(reply.substr(strlen(FORK_REQUEST)));
+            reply = sendRequest(msg);
+        }
+        if (actionTrace)
+            actionTrace->record(msg, reply);
+    }
+    RlLogger::log(LOG_DEBUG, reply);
+    if (msg[0] == 's') {
+        if (RlResultsWriter *results = RlResultsWriter::getInstance())
+            results->recordAction(atoi(msg.c_str() + 3), reply);
+        if (RlDatasetWriter *dataset = RlDatasetWriter::getInstance())
+            dataset->recordAction(atoi(msg.c_str() + 3), reply);
+    }
+    return reply;
+}
+
+/**
+ * @brief Fork the simulation at the current request: event queue, packets in flight, routing state and statistics are
+ * shared copy-on-write with the children. The parent stays blocked on its own port, so it can be forked again later as
+ * a snapshot. Each child connects to its port and announces its pid with "f@@pid@@" before sending the request again
+ *
+ * @param portList  Ports of the children, comma-separated
+ */
+void RlBasicRoutingTable::forkSimulation(const string &portList)
+{
+    vector<int> ports;
+    const char *cursor = portList.c_str();
+    while (*cursor) {
+        char *end;
+        long port = strtol(cursor, &end, 10);
+        if (end == cursor || port <= 0 || port > 65535)
+            throw cRuntimeError("Invalid fork request '%s'", portList.c_str());
+        ports.push_back(port);
+        cursor = end;
+        while (*cursor == ',' || *cursor == ' ')
+            cursor++;
+    }
+
+    // Buffered output would be written once by every process
+    cout.flush();
+    fflush(stdout);
+    for (int port : ports) {
+        pid_t pid = fork();
+        if (pid < 0)
+            throw cRuntimeError("Cannot fork the simulation: %s", strerror(errno));
+        if (pid == 0) {
+            // The siblings are not children of this process. The ZMQ context of the parent must not be used in a
+            // child, its I/O threads only exist in the parent, so it is replaced without being closed
+            forkedPids.clear();
+            zmqPort = port;
+            connectAgent();
+            sendRequest("f@@" + to_string(getpid()) + "@@");
+            return;
+        }
+        forkedPids.push_back(pid);
+    }
+}
+
+/**
+ * @brief Reap the forked children that exited, the agent stops them by their pid. Only these children are waited for,
+ * without blocking and without changing the handling of SIGCHLD of the process
+ *
+ */
+void RlBasicRoutingTable::reapForks()
+{
+    auto exited = remove_if(forkedPids.begin(), forkedPids.end(),
+                            [](pid_t pid) { return waitpid(pid, NULL, WNOHANG) != 0; });
+    forkedPids.erase(exited, forkedPids.end());
+}
+
+/**
+ * @brief Parse link weights from the agent, links missing in the message keep their current weights
+ *
+ * @param weightStr Message format: w_1,w_2,...,w_E, mapped to the links in the order of their link numbers
+ * @param weights   Weight of each directed link, updated in place
+ * @return int      Number of weights read from the message, 0 if it carries no weights (e.g. "get state")
+ */
+int RlBasicRoutingTable::parseLinkWeights(const string &weightStr, vector<double> &weights)
+{
+    const char *cursor = weightStr.c_str();
+    int i = 0;
+    for (; i < (int)weights.size(); i++) {
+        char *end;
+        double weight = strtod(cursor, &end);
+        if (end == cursor)
+            break;
+        if (!(weight > 0))
+            throw cRuntimeError("Invalid weight %f of link %d, weights must be positive", weight,
+                                i);
+        weights[i] = weight;
+        cursor = end;
+        while (*cursor == ',' || *cursor == ' ')
+            cursor++;
+    }
+    return i;
 }
 
 /**
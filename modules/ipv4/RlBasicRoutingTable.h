@@ -23,6 +23,12 @@
 #include <queue>
 
 #include "inet/networklayer/contract/INetfilter.h"
+#include "RlActionTrace.h"
+#include "RlDatasetWriter.h"
+#include "RlLogger.h"
+#include "RlResultsWriter.h"
+#include "RlStepProfiler.h"
+#include "RlTracer.h"
 
 using namespace std;
 using namespace omnetpp;
@@ -51,6 +57,17 @@ public:
      * transfers delay and packet loss rate, and clears the already collected data.
      */
     virtual void endStep(int step);
+    /**
+     * Ends a step through endStep, and closes the interval of the step in the step profile when profiling is on.
+     */
+    void finishStep(int step);
+    /**
+     * Sends a request to the ZMQ server (Python side) and blocks until its reply arrives.
+     * The agent may reply "fork@@port_1,...,port_n" instead: the simulation is then forked into n child processes at
+     * this point, each one connected to its own port, and every process sends the request again.
+     */
+    string exchange(const string &msg);
+    int parseLinkWeights(const string &weightStr, vector<double> &weights);
     virtual void stepOverJudge(int step, double currentTime);
     virtual void updateRoutingTable(int step, double stepTime) = 0;
     void recordPktNum(int pkNum, int stepNum);
@@ -60,12 +77,29 @@ public:
     void setVals(int port, int num, const char *initRoutingTable_v, double overTime_v,
                  int totalStep_v, int returnMode_v);
     void clearPkts();
+    void recordLinkLoads(int step, double stepTime);
+    void recordReward(int step, double delay, double loss, const vector<double> &delays,
+                      const vector<double> &losses);
     void countPkct(int src, int dst, int pkByte);
     virtual void
     countPktInNode(string path,
                    Packet *packet); // Only counts the nodes each packet passes through.
     // Count delay of each packet according to pktID.
     virtual void countPktDelay(Packet *packet, double delay);
+    static int getPacketWeight(Packet *packet);
+
+    /**
+     * Routing state seen by the fluid model: the share of the traffic of an OD pair at a node sent to each next node, or
+     * the paths of the pair with their share for the tables that route by path. No path means hop by hop.
+     */
+    virtual void getSplitRatios(int nodeId, int srcNode, int dstNode,
+                                vector<pair<int, double>> &split);
+    virtual void getFluidPaths(int srcNode, int dstNode, int flowNum,
+                               vector<pair<vector<int>, double>> &fluidPaths);
+    // Count the packets of an OD pair solved by the fluid model as if they had been forwarded and received.
+    virtual void countFluidDemand(int step, int srcNode, int dstNode, double sent, double arrived,
+                                  double delay, const vector<double> &nodePass);
+    void countFluidPackets(int step, double sent, double arrived, double delay);
     int getSendId();
     int **
         topo; // Stores the network topology, represented by -1 for no link between nodes and the link number for existing links.
@@ -73,8 +107,15 @@ public:
     string initRoutingTable; // Initialization of the forwarding probability matrix.
     int **pkct;              // Records the traffic on each link during a step, measured in bits.
     int edgeNum = 0;         // Number of links in the network topology.
-    vector<vector<double>> delayWithStep; // Stores delays by step number.
-    int *pkNumOfStep;                     // Stores the number of packets sent in each step.
+    double *delaySumOfStep; // Sum of the delays of the packets received in each step, weighted by the packets each one stands for.
+    int *pkArrivedOfStep;   // Number of packets received in each step, a packet train counts for all its packets.
+    int *pkNumOfStep;       // Stores the number of packets sent in each step.
+    struct FluidCount {
+        double sent = 0, arrived = 0;         // Packets of the OD pairs.
+        vector<double> arrivedPass, lostPass; // Received and lost packets passing through each router.
+    };
+    unordered_map<int, FluidCount>
+        fluidCounts; // Fractional packets of the fluid model counted in each step, rounded once per step and counter.
     bool *stepIsEnd;     // Sender confirms that all packets for each step have been sent.
     double *stepEndTime; // End time of each step recorded by the sender, used for st calculation.
     bool
@@ -86,8 +127,8 @@ public:
     double overTime;        // Timeout setting.
     int totalStep = 0;      // Total number of simulation steps.
 
-    vector<vector<unordered_set<int> *>>
-        pktInNode; // Only need to count the packet IDs that pass through each node.
+    vector<vector<unordered_map<int, int> *>>
+        pktInNode; // Only need to count the packet IDs that pass through each node, with the packets each one stands for.
     vector<unordered_map<int, double> *>
         pktDelay; // Used to store the final E2E delay of each packet.
 
@@ -96,8 +137,13 @@ public:
     int returnMode;  // Simulation mode.
     int routingMode;
     int zmqPort; // ZMQ port.
-    zmq::context_t *zmq_context;
-    zmq::socket_t *zmq_socket;
+    zmq::context_t *zmq_context = nullptr; // Not connected when the actions are replayed from a trace.
+    zmq::socket_t *zmq_socket = nullptr;
+    void connectAgent();
+    string sendRequest(const string &msg);
+    void forkSimulation(const string &portList);
+    void reapForks();
+    vector<pid_t> forkedPids; // Children forked by this process and not reaped yet.
     RlBasicRoutingTable(); // Constructor and destructor, both private since they are not meant to be called externally.
     virtual ~RlBasicRoutingTable();
 };
@@ -23,6 +23,8 @@ RlConventionalRoutingTable::~RlConventionalRoutingTable()
         zmq_context->close();
         delete zmq_context;
     }
+    if (engine)
+        delete engine;
     if (routingTable)
         delete routingTable;
 }
@@ -61,14 +63,17 @@ string RlConventionalRoutingTable::getDeviceNameByAddress(string address)
  * @param overTime_v        Timeout value
  * @param totalStep_v       Total number of simulation steps
  * @param simMode_v         Simulation mode
+ * @param reprogramRoutes_v Whether the agent sends link weights to reprogram the INET routes at runtime
  * @return RlConventionalRoutingTable* Initialized probability routing table
  */
-RlConventionalRoutingTable *
-RlConventionalRoutingTable::initTable(int nodeNum, int port, double overTime_v, int totalStep_v)
+RlConventionalRoutingTable *RlConventionalRoutingTable::initTable(int nodeNum, int port,
+                                                                  double overTime_v,
+                                                                  int totalStep_v,
+                                                                  bool reprogramRoutes_v)
 {
     if (!routingTable) {
         routingTable = new RlConventionalRoutingTable();
-        routingTable->setVals(port, nodeNum, overTime_v, totalStep_v);
+        routingTable->setVals(port, nodeNum, overTime_v, totalStep_v, reprogramRoutes_v);
         routingTable->initiate();
     }
     return routingTable;
@@ -77,25 +82,155 @@ RlConventionalRoutingTable::initTable(int nodeNum, int port, double overTime_v,
 void RlConventionalRoutingTable::initiate()
 {
     RlBasicRoutingTable::initiate();
+    routerTables.assign(nodeNum, nullptr);
+    routerLinks.assign(nodeNum, vector<RouterLink>());
+    hostAddress.assign(nodeNum, Ipv4Address::UNSPECIFIED_ADDRESS);
+    hostNetmask.assign(nodeNum, Ipv4Address::ALLONES_ADDRESS);
 }
 
-void RlConventionalRoutingTable::setVals(int port, int num, double overTime_v, int totalStep_v)
+void RlConventionalRoutingTable::setVals(int port, int num, double overTime_v, int totalStep_v,
+                                         bool reprogramRoutes_v)
 {
     zmqPort = port;
     nodeNum = num;
     overTime = overTime_v;
     totalStep = totalStep_v;
+    reprogramRoutes = reprogramRoutes_v;
 }
 
+void RlConventionalRoutingTable::registerRoutingTable(int router, IIpv4RoutingTable *table)
+{
+    if (router >= 0 && router < nodeNum)
+        routerTables[router] = table;
+}
+
+/**
+ * @brief Register a link between two routers, parallel links to the same neighbor keep the first one
+ *
+ * @param router    ID of the router owning the interface
+ * @param neighbor  ID of the router on the other end of the link
+ * @param ie        Outgoing interface of the router
+ * @param gateway   Address of the neighbor on the link
+ */
+void RlConventionalRoutingTable::registerRouterLink(int router, int neighbor, NetworkInterface *ie,
+                                                    Ipv4Address gateway)
+{
+    if (router < 0 || router >= nodeNum || neighbor < 0 || neighbor >= nodeNum)
+        return;
+    vector<RouterLink> &links = routerLinks[router];
+    auto it = links.begin();
+    while (it != links.end() && it->neighbor < neighbor)
+        it++;
+    if (it != links.end() && it->neighbor == neighbor)
+        return;
+    links.insert(it, RouterLink{neighbor, ie, gateway});
+}
+
+void RlConventionalRoutingTable::registerHost(int host, Ipv4Address address, Ipv4Address netmask)
+{
+    if (host < 0 || host >= nodeNum)
+        return;
+    hostAddress[host] = address;
+    hostNetmask[host] = netmask;
+    hostIds[address.getInt()] = host;
+}
+
+/**
+ * @brief Number the directed links between routers row by row, in the same order as the adjacency matrix on the Python side
+ *
+ */
+void RlConventionalRoutingTable::initTopoTable()
+{
+    int edgeCount = 0;
+    for (int i = 0; i < nodeNum; i++) {
+        for (int j = 0; j < nodeNum; j++) {
+            topo[i][j] = -1;
+        }
+        for (auto &link : routerLinks[i]) {
+            topo[i][link.neighbor] = edgeCount++;
+        }
+    }
+    edgeNum = edgeCount;
+}
+
+/**
+ * @brief Rewrite the INET routes whose next hop changed under the current weights, routes towards the host of each router
+ * are updated in place when they are host routes, and shadowed by a new host route when they are aggregated
+ *
+ * @return int  Number of routes rewritten
+ */
+int RlConventionalRoutingTable::reprogramChangedRoutes()
+{
+    int rewritten = 0;
+    for (auto &change : engine->getChangedNextHops()) {
+        int node = change.first, dst = change.second;
+        int nextNode = engine->getNextNode(node, dst);
+        if (node == dst || nextNode == -1 || !routerTables[node] || hostAddress[dst].isUnspecified())
+            continue;
+        const RouterLink *link = nullptr;
+        for (auto &l : routerLinks[node]) {
+            if (l.neighbor == nextNode) {
+                link = &l;
+                break;
+            }
+        }
+        if (!link)
+            continue;
+
+        Ipv4Address dstNetwork = hostAddress[dst].doAnd(hostNetmask[dst]);
+        Ipv4Route *route = routerTables[node]->findBestMatchingRoute(hostAddress[dst]);
+        if (route && route->getInterface() == link->ie && route->getGateway() == link->gateway)
+            continue;
+        bool ownRoute = route && route->getSourceType() == IRoute::MANUAL
+                        && ((route->getDestination() == hostAddress[dst]
+                             && route->getNetmask() == Ipv4Address::ALLONES_ADDRESS)
+                            || (route->getDestination() == dstNetwork
+                                && route->getNetmask() == hostNetmask[dst]));
+        if (ownRoute) {
+            route->setInterface(link->ie);
+            route->setGateway(link->gateway);
+        } else {
+            // The matching route is shared with other destinations, so a more specific one is added instead
+            Ipv4Route *hostRoute = new Ipv4Route();
+            hostRoute->setSourceType(IRoute::MANUAL);
+            hostRoute->setDestination(dstNetwork);
+            hostRoute->setNetmask(hostNetmask[dst]);
+            hostRoute->setInterface(link->ie);
+            hostRoute->setGateway(link->gateway);
+            routerTables[node]->addRoute(hostRoute);
+        }
+        rewritten++;
+    }
+    return rewritten;
+}
+
+/**
+ * @brief Get the next hop of a router towards a destination, from the reprogrammed weights or else from the INET routes
+ *
+ * @param nodeId    ID of the current router
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @return int      Next hop router, -1 if it is unknown
+ */
 int RlConventionalRoutingTable::getNextNode(int nodeId, int srcNode, int dstNode)
 {
-    return 0;
+    if (engine)
+        return engine->getNextNode(nodeId, dstNode);
+    if (!routerTables[nodeId] || hostAddress[dstNode].isUnspecified())
+        return -1;
+    Ipv4Route *route = routerTables[nodeId]->findBestMatchingRoute(hostAddress[dstNode]);
+    if (!route)
+        return -1;
+    for (auto &link : routerLinks[nodeId])
+        if (link.ie == route->getInterface())
+            return link.neighbor;
+    return -1;
 }
 
 /**
  * @brief Called after all packets of the current step have been sent, communicates with the ZMQ server (Python side), transfers the current
- * step's throughput, obtains the weights of nodes for the next step, calculates the corresponding forwarding probabilities, and clears the 
- * already collected throughput data
+ * step's throughput, obtains the weights of links for the next step when routes are reprogrammed, rewrites the INET routes whose next hop
+ * changed, and clears the already collected throughput data
  *
  * @param step  Current step number
  */
@@ -113,16 +248,26 @@ void RlConventionalRoutingTable::updateRoutingTable(int step, double stepTime)
                 else
                     stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime) + ",";
             }
+        // The links are registered by the configurator after the table is created
+        if (!topoReady) {
+            initTopoTable();
+            topoReady = true;
+        }
+        recordLinkLoads(step, stepTime);
         clearPkts();
 
-        const char *reqData = stateStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmq_socket->send(request, zmq::send_flags::none);
-
-        zmq::message_t reply;
-        auto res = zmq_socket->recv(reply, zmq::recv_flags::none);
+        string reply = exchange(stateStr);
+        if (reprogramRoutes) {
+            if (!engine) {
+                engine = new RlShortestPathEngine(nodeNum, topo);
+                weights.assign(edgeNum, 1.0);
+            }
+            // "get state" carries no weights and leaves the routes of the configurator untouched
+            if (parseLinkWeights(reply, weights) > 0) {
+                engine->update(weights);
+                reprogramChangedRoutes();
+            }
+        }
         sendId = 0;
     }
 }
\ No newline at end of file
@@ -10,6 +10,8 @@
 #ifndef RlConventionalRoutingTable_H
 #define RlConventionalRoutingTable_H
 #include "RlBasicRoutingTable.h"
+#include "RlShortestPathEngine.h"
+#include "inet/networklayer/ipv4/IIpv4RoutingTable.h"
 
 /**
  * Stores the forwarding probabilities for the entire network and serves as the network's statistics module, exchanging data with the Python side through ZMQ communication.
@@ -30,7 +32,7 @@ public:
      * Used to initialize the unique static instance, set parameters, and allocate memory for statistics variables.
      */
     static RlConventionalRoutingTable *initTable(int nodeNum, int port, double overTime_v,
-                                                 int totalStep_v);
+                                                 int totalStep_v, bool reprogramRoutes_v = false);
     void initiate() override;
 
     //   /**
@@ -39,12 +41,53 @@ public:
     //    */
     void updateRoutingTable(int step, double stepTime) override;
     int getNextNode(int nodeId, int srcNode, int dstNode) override;
-    void setVals(int port, int nodeNum, double overTime_v, int totalStep_v);
+    void setVals(int port, int nodeNum, double overTime_v, int totalStep_v, bool reprogramRoutes_v);
     void setDeviceAddress(string deviceName, string address);
     string getDeviceNameByAddress(string address);
 
+    /**
+     * Called by the network configurator to hand over the INET routing tables of routers, the links between routers and
+     * the addresses of hosts, which are needed to reprogram the routes at runtime.
+     */
+    bool isReprogramming() const { return reprogramRoutes; }
+    void registerRoutingTable(int router, IIpv4RoutingTable *table);
+    void registerRouterLink(int router, int neighbor, NetworkInterface *ie, Ipv4Address gateway);
+    void registerHost(int host, Ipv4Address address, Ipv4Address netmask);
+
+    /**
+     * Host lookups used by Ipv4 to cache the route of each router towards every host.
+     */
+    int getHostId(Ipv4Address address) const
+    {
+        auto it = hostIds.find(address.getInt());
+        return it == hostIds.end() ? -1 : it->second;
+    }
+    int getHostNum() const { return hostAddress.size(); }
+    Ipv4Address getHostAddress(int host) const { return hostAddress[host]; }
+
 protected:
+    /**
+     * Outgoing interface of a router towards one neighbor router, and the neighbor's address on that link.
+     */
+    struct RouterLink {
+        int neighbor;
+        NetworkInterface *ie;
+        Ipv4Address gateway;
+    };
+
+    void initTopoTable();
+    int reprogramChangedRoutes();
+
     unordered_map<string, string> deviceAddressMap;
+    bool reprogramRoutes = false;             // Whether the agent sends link weights to reprogram the INET routes.
+    bool topoReady = false;                   // Whether topo numbers the registered links, done at the first state.
+    vector<IIpv4RoutingTable *> routerTables; // INET routing table of each router.
+    vector<vector<RouterLink>> routerLinks;   // Links of each router, sorted by the neighbor ID.
+    vector<Ipv4Address> hostAddress;          // Address of the host attached to each router.
+    vector<Ipv4Address> hostNetmask;
+    unordered_map<uint32_t, int> hostIds;     // Host ID of each host address.
+    vector<double> weights;                   // Weight of each directed link, indexed by the link number in topo.
+    RlShortestPathEngine *engine = nullptr;   // Next hops under the current weights, built on the first weights.
 
 private:
     static RlConventionalRoutingTable *routingTable;
@@ -0,0 +1,323 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 22:52:03
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 22:52:03
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlDatasetWriter.cc
+ * @Description  : Offline RL dataset of the transitions of RouterRL, read by utils/dataset_file.py.
+ */
+#include "RlDatasetWriter.h"
+#include "RlLogger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <omnetpp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace omnetpp;
+
+RlDatasetWriter *RlDatasetWriter::datasetWriter = NULL;
+
+/**
+ * @brief Initialize the dataset writer, only the first call creates it
+ *
+ * @param file_v        Dataset file, appended to if it exists
+ * @param nodeNum_v     Number of nodes
+ * @param topo          Topology of the routing table, -1 for no link, read at the first state, action or reward
+ * @param statScope_v   Reward fields besides the global ones, RESULTS_GLOBAL, RESULTS_NODE or RESULTS_OD
+ * @param totalStep_v   Steps of the simulation, the last one has no next state
+ * @return RlDatasetWriter* Dataset writer
+ */
+RlDatasetWriter *RlDatasetWriter::initWriter(string file_v, int nodeNum_v, int **topo, int statScope_v,
+                                             int totalStep_v)
+{
+    if (!datasetWriter) {
+        atexit(&RlDatasetWriter::atExit);
+        datasetWriter = new RlDatasetWriter(file_v, nodeNum_v, topo, statScope_v, totalStep_v);
+    }
+    return datasetWriter;
+}
+
+RlDatasetWriter::RlDatasetWriter(string file_v, int nodeNum_v, int **topo_v, int statScope_v, int totalStep_v)
+    : file(file_v), nodeNum(nodeNum_v), topo(topo_v), statScope(statScope_v), totalStep(totalStep_v)
+{
+    if (statScope == RESULTS_NODE)
+        statWidth = nodeNum;
+    else if (statScope == RESULTS_OD)
+        statWidth = nodeNum * nodeNum;
+    int check = open(file.getPath().c_str(), O_RDWR | O_CREAT, 0644);
+    if (check < 0)
+        throw cRuntimeError("Cannot write the dataset file '%s': %s", file.getPath().c_str(), strerror(errno));
+    close(check);
+}
+
+/**
+ * @brief Read the links of the topology, make the fields of a slot and open the dataset file
+ *
+ */
+void RlDatasetWriter::makeLayout()
+{
+    for (int i = 0; i < nodeNum; i++)
+        for (int j = 0; j < nodeNum; j++)
+            if (topo[i][j] != -1)
+                linkNum++;
+
+    // Fields of 8-byte values first, so that every field of every slot is aligned
+    addField("delay", "<f8", 1);
+    addField("loss", "<f8", 1);
+    addField("action_hash", "<u8", 1);
+    addField("step", "<i4", 1);
+    addField("done", "<i4", 1);
+    addField("state", "<f4", nodeNum * nodeNum);
+    addField("next_state", "<f4", nodeNum * nodeNum);
+    addField("action", "<f4", linkNum);
+    if (statWidth) {
+        addField("reward_delay", "<f4", statWidth);
+        addField("reward_loss", "<f4", statWidth);
+    }
+    slotSize = (slotSize + 7) / 8 * 8;
+    slot.resize(slotSize, 0);
+    dataOffset = (sizeof(RlDatasetHeader) + fields.size() * sizeof(RlResultsColumn) + 7) / 8 * 8;
+    openFile(file.getPath());
+}
+
+/**
+ * @brief Make the layout and open the file at the first record, or open the file of a forked child at its first
+ * record. The steps not written yet are kept, their transitions are written by the child
+ *
+ */
+void RlDatasetWriter::openDataset()
+{
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (fields.empty())
+        makeLayout();
+    else
+        openFile(file.getPath());
+}
+
+RlDatasetWriter::~RlDatasetWriter()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+void RlDatasetWriter::addField(const char *name, const char *type, uint32_t width)
+{
+    RlResultsColumn field = {};
+    strncpy(field.name, name, sizeof(field.name) - 1);
+    memcpy(field.type, type, 3);
+    field.width = width;
+    fields.push_back(field);
+    slotSize += width * (type[2] - '0');
+}
+
+/**
+ * @brief Open a dataset file: a new file gets the header, an existing one must have the same layout and is continued
+ * after its last complete slot
+ *
+ * @param path  Dataset file
+ */
+void RlDatasetWriter::openFile(const string &path)
+{
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw cRuntimeError("Cannot write the dataset file '%s': %s", path.c_str(), strerror(errno));
+    file.setOpened();
+    struct stat st;
+    fstat(fd, &st);
+
+    RlDatasetHeader header = {RL_DATASET_MAGIC, RL_DATASET_VERSION, (uint32_t)nodeNum, (uint32_t)linkNum,
+                              (uint32_t)fields.size(), slotSize, 0};
+    if (st.st_size == 0) {
+        vector<char> start(dataOffset, 0);
+        memcpy(start.data(), &header, sizeof(header));
+        memcpy(start.data() + sizeof(header), fields.data(), fields.size() * sizeof(RlResultsColumn));
+        if (pwrite(fd, start.data(), start.size(), 0) != (ssize_t)start.size())
+            throw cRuntimeError("Cannot write the dataset file '%s': %s", path.c_str(), strerror(errno));
+        slotNum = 0;
+        return;
+    }
+
+    RlDatasetHeader existing;
+    vector<RlResultsColumn> existingFields(fields.size());
+    size_t fieldBytes = fields.size() * sizeof(RlResultsColumn);
+    if (pread(fd, &existing, sizeof(existing), 0) != sizeof(existing) || existing.magic != RL_DATASET_MAGIC ||
+        existing.version != RL_DATASET_VERSION)
+        throw cRuntimeError("'%s' is not a version %d dataset file", path.c_str(), RL_DATASET_VERSION);
+    header.slotNum = existing.slotNum;
+    if (memcmp(&existing, &header, sizeof(header)) != 0 ||
+        pread(fd, existingFields.data(), fieldBytes, sizeof(header)) != (ssize_t)fieldBytes ||
+        memcmp(existingFields.data(), fields.data(), fieldBytes) != 0)
+        throw cRuntimeError("The dataset file '%s' has the slots of another network or return mode", path.c_str());
+    // Bytes after the last counted slot are from a simulation stopped while writing
+    slotNum = existing.slotNum;
+    if (ftruncate(fd, dataOffset + slotNum * slotSize) != 0)
+        throw cRuntimeError("Cannot write the dataset file '%s': %s", path.c_str(), strerror(errno));
+}
+
+/**
+ * @brief Keep the state of a step, and write the transition of the previous step if it is rewarded
+ *
+ * @param step      Step of the state
+ * @param pkct      Bits sent between each pair of nodes during the step
+ * @param stepTime  Duration of the step
+ */
+void RlDatasetWriter::recordState(int step, int **pkct, double stepTime)
+{
+    if (fd < 0 || file.isStale())
+        openDataset();
+    StepRecord &record = steps[step];
+    record.state.resize(nodeNum * nodeNum);
+    for (int i = 0; i < nodeNum; i++)
+        for (int j = 0; j < nodeNum; j++)
+            record.state[i * nodeNum + j] = (float)(double(pkct[i][j]) / 1000 / 1000 / stepTime);
+
+    auto previous = steps.find(step - 1);
+    if (previous != steps.end() && previous->second.rewarded)
+        writeTransition(step - 1, DATASET_CONTINUE);
+}
+
+/**
+ * @brief Keep the action applied after the state of a step: its numbers, up to one per link, and its hash
+ *
+ * @param step      Step of the state
+ * @param action    Reply of the agent to the state
+ */
+void RlDatasetWriter::recordAction(int step, const string &action)
+{
+    if (fd < 0 || file.isStale())
+        openDataset();
+    StepRecord &record = steps[step];
+    record.action.assign(linkNum, NAN);
+    // Only actions made of numbers are kept, e.g. not the paths of the path tables or "get state"
+    const char *cursor = action.c_str();
+    for (int i = 0; i < linkNum && *cursor; i++) {
+        char *end;
+        double value = strtod(cursor, &end);
+        if (end == cursor || (*end != ',' && *end != '\0')) {
+            record.action.assign(linkNum, NAN);
+            break;
+        }
+        record.action[i] = (float)value;
+        cursor = *end ? end + 1 : end;
+    }
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : action) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    record.actionHash = hash;
+}
+
+/**
+ * @brief Keep the reward of a step, and write its transition if the state of the next step is known
+ *
+ * @param step      Step of the reward
+ * @param delay     Global average delay
+ * @param loss      Global loss rate
+ * @param delays    Average delay of each node or OD pair of the scope, empty for RESULTS_GLOBAL
+ * @param losses    Loss rate of each node or OD pair of the scope, empty for RESULTS_GLOBAL
+ */
+void RlDatasetWriter::recordReward(int step, double delay, double loss, const vector<double> &delays,
+                                   const vector<double> &losses)
+{
+    if (fd < 0 || file.isStale())
+        openDataset();
+    StepRecord &record = steps[step];
+    record.rewarded = true;
+    record.delay = delay;
+    record.loss = loss;
+    record.statDelay.assign(statWidth, NAN);
+    record.statLoss.assign(statWidth, NAN);
+    for (int i = 0; i < statWidth && i < (int)delays.size(); i++)
+        record.statDelay[i] = delays[i];
+    for (int i = 0; i < statWidth && i < (int)losses.size(); i++)
+        record.statLoss[i] = losses[i];
+
+    if (step == totalStep - 1) {
+        writeTransition(step, DATASET_LAST);
+        return;
+    }
+    auto next = steps.find(step + 1);
+    if (next != steps.end() && !next->second.state.empty())
+        writeTransition(step, DATASET_CONTINUE);
+}
+
+/**
+ * @brief Write the transition of a step in the next slot, then count the slot in the header
+ *
+ * @param step  Step of the transition
+ * @param done  DATASET_CONTINUE, DATASET_LAST or DATASET_TRUNCATED
+ */
+void RlDatasetWriter::writeTransition(int step, int done)
+{
+    StepRecord &record = steps[step];
+    const StepRecord *next = NULL;
+    if (done == DATASET_CONTINUE)
+        next = &steps[step + 1];
+    int32_t step32 = step, done32 = done;
+    vector<float> nan(max(nodeNum * nodeNum, max(linkNum, statWidth)), NAN);
+
+    char *cursor = slot.data();
+    auto put = [&](const void *values, size_t size, size_t expected) {
+        if (size == expected)
+            memcpy(cursor, values, size);
+        else
+            memcpy(cursor, nan.data(), expected);
+        cursor += expected;
+    };
+    put(&record.delay, sizeof(double), sizeof(double));
+    put(&record.loss, sizeof(double), sizeof(double));
+    put(&record.actionHash, sizeof(uint64_t), sizeof(uint64_t));
+    put(&step32, sizeof(int32_t), sizeof(int32_t));
+    put(&done32, sizeof(int32_t), sizeof(int32_t));
+    put(record.state.data(), record.state.size() * sizeof(float), nodeNum * nodeNum * sizeof(float));
+    if (next)
+        put(next->state.data(), next->state.size() * sizeof(float), nodeNum * nodeNum * sizeof(float));
+    else
+        put(NULL, 0, nodeNum * nodeNum * sizeof(float));
+    put(record.action.data(), record.action.size() * sizeof(float), linkNum * sizeof(float));
+    if (statWidth) {
+        put(record.statDelay.data(), record.statDelay.size() * sizeof(float), statWidth * sizeof(float));
+        put(record.statLoss.data(), record.statLoss.size() * sizeof(float), statWidth * sizeof(float));
+    }
+
+    if (pwrite(fd, slot.data(), slotSize, dataOffset + slotNum * slotSize) != (ssize_t)slotSize)
+        throw cRuntimeError("Cannot write the dataset file '%s': %s", file.getPath().c_str(), strerror(errno));
+    slotNum++;
+    // The slot is counted only once it is written
+    if (pwrite(fd, &slotNum, sizeof(slotNum), offsetof(RlDatasetHeader, slotNum)) != sizeof(slotNum))
+        throw cRuntimeError("Cannot write the dataset file '%s': %s", file.getPath().c_str(), strerror(errno));
+    steps.erase(step);
+}
+
+/**
+ * @brief Write the rewarded steps without a next state at the exit of the process as truncated transitions
+ *
+ */
+void RlDatasetWriter::atExit()
+{
+    if (!datasetWriter)
+        return;
+    vector<int> rewarded;
+    for (auto &record : datasetWriter->steps)
+        if (record.second.rewarded)
+            rewarded.push_back(record.first);
+    // Nothing can be thrown at the exit of the process
+    try {
+        if (!rewarded.empty() && (datasetWriter->fd < 0 || datasetWriter->file.isStale()))
+            datasetWriter->openDataset();
+        for (int step : rewarded)
+            datasetWriter->writeTransition(step, DATASET_TRUNCATED);
+    } catch (cRuntimeError &e) {
+        RlLogger::logAtExit(LOG_ERROR, e.what());
+    }
+}
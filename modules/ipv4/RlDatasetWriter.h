@@ -0,0 +1,115 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 22:52:03
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 22:52:03
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlDatasetWriter.h
+ * @Description  : Offline RL dataset of the transitions of RouterRL, read by utils/dataset_file.py.
+ */
+#ifndef RLDATASETWRITER_H
+#define RLDATASETWRITER_H
+#include "RlForkedFile.h"
+#include "RlResultsWriter.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define RL_DATASET_MAGIC   0x53444c52 // "RLDS"
+#define RL_DATASET_VERSION 1
+
+#define DATASET_CONTINUE  0 // The next state is the state of the next step
+#define DATASET_LAST      1 // Last step of the simulation, there is no next state
+#define DATASET_TRUNCATED 2 // The simulation stopped before the next state, there is no next state
+
+/**
+ * Dataset file layout (little-endian):
+ *   RlDatasetHeader                    magic, version, nodeNum, linkNum, fieldNum, slotSize, slotNum
+ *   RlResultsColumn fields[fieldNum]   name, numpy type and values of each field of a slot, padded to 8 bytes
+ *   slots[slotNum]                     one transition per slot of slotSize bytes, fields after fields
+ * A slot holds delay, loss, action_hash, step, done, state and next_state (Mbits/s of each OD entry of the load
+ * matrix, as in the state), action (the numbers of the action of the agent, one per directed link, NaN if the action
+ * has fewer numbers) and, depending on the return mode, reward_delay and reward_loss of each node or OD pair. The slot
+ * size only depends on the number of nodes and links, so the slots are a numpy structured array mapped from the file.
+ * slotNum is the index of the dataset: it is updated after each slot is written, and readers ignore the bytes after
+ * the last counted slot.
+ */
+struct RlDatasetHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeNum;
+    uint32_t linkNum;
+    uint32_t fieldNum;
+    uint32_t slotSize;
+    uint64_t slotNum;
+};
+
+/**
+ * A transition is written once the reward of its step and the state of the next step are known, which may come in
+ * either order since the rewards wait for the packets in flight. Only the steps not written yet are kept in memory.
+ * An existing dataset file with the same layout is appended to, so that several simulations fill the same dataset;
+ * they must not write it at the same time. The layout is made and the file is opened at the first state, action or
+ * reward, once the routing table knows its links, e.g. the links of the convention mode registered by the configurator.
+ * There is only a single global static object, and none when the dataset is off. A child process created by fork()
+ * writes its own dataset file, see RlForkedFile. The transitions of the parent until the fork stay in its file.
+ */
+class RlDatasetWriter
+{
+public:
+    static RlDatasetWriter *getInstance() { return datasetWriter; }
+
+    /**
+     * Used to initialize the unique static instance, checks that the dataset file can be written.
+     */
+    static RlDatasetWriter *initWriter(string file_v, int nodeNum_v, int **topo, int statScope_v, int totalStep_v);
+
+    void recordState(int step, int **pkct, double stepTime);
+    void recordAction(int step, const string &action);
+    void recordReward(int step, double delay, double loss, const vector<double> &delays,
+                      const vector<double> &losses);
+
+    ~RlDatasetWriter();
+
+protected:
+    RlDatasetWriter(string file_v, int nodeNum_v, int **topo, int statScope_v, int totalStep_v);
+    static void atExit();
+    void makeLayout();
+    void openDataset();
+    void openFile(const string &path);
+    void addField(const char *name, const char *type, uint32_t width);
+    void writeTransition(int step, int done);
+
+    // Everything known about a step until its transition is written
+    struct StepRecord {
+        vector<float> state;
+        vector<float> action;
+        uint64_t actionHash = 0;
+        bool rewarded = false;
+        double delay = 0;
+        double loss = 0;
+        vector<float> statDelay;
+        vector<float> statLoss;
+    };
+
+    RlForkedFile file;
+    int fd = -1;                    // Open once the layout is made
+    int nodeNum;
+    int **topo;                     // Topology of the routing table, read when the layout is made
+    int linkNum = 0;
+    int statScope;
+    int statWidth = 0;
+    int totalStep;
+    uint64_t slotNum = 0;
+    vector<RlResultsColumn> fields; // Fields of a slot, in the order of writeTransition
+    uint32_t slotSize = 0;
+    uint32_t dataOffset = 0;        // Offset of the first slot
+    vector<char> slot;              // Slot being written
+    map<int, StepRecord> steps;     // Steps whose transition is not written yet
+
+private:
+    static RlDatasetWriter *datasetWriter;
+};
+
+#endif // RLDATASETWRITER_H
@@ -0,0 +1,285 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 14:32:10
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 14:32:10
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlEcmpRoutingTable.cc
+ * @Description  : Flow-hash ECMP routing table in RouterRL.
+ */
+#include "RlEcmpRoutingTable.h"
+
+RlEcmpRoutingTable *RlEcmpRoutingTable::eTable = NULL;
+
+/**
+ * @brief Stateless 64-bit mixing function (the finalizer of splitmix64)
+ *
+ * @param x         Value to mix
+ * @return uint64_t Mixed value
+ */
+static inline uint64_t mixHash(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+RlEcmpRoutingTable::RlEcmpRoutingTable()
+{
+}
+
+RlEcmpRoutingTable::~RlEcmpRoutingTable()
+{
+    if (zmq_socket) {
+        zmq_socket->close();
+        delete zmq_socket;
+        zmq_socket = nullptr;
+        zmq_context->close();
+        delete zmq_context;
+    }
+    if (eTable)
+        delete eTable;
+}
+
+/**
+ * @brief Used to get the unique static instance, throws an exception if the instance is not initialized
+ *
+ * @return RlEcmpRoutingTable* ECMP routing table
+ */
+RlEcmpRoutingTable *RlEcmpRoutingTable::getInstance()
+{
+    return eTable;
+}
+
+/**
+ * @brief Initialize the ECMP routing table
+ *
+ * @param num           Number of nodes in the network topology
+ * @param initTopo_v    Adjacency matrix of the network topology
+ * @param port          ZMQ communication port
+ * @param overTime_v    Timeout value
+ * @param totalStep_v   Total number of simulation steps
+ * @param simMode_v     Simulation mode
+ * @return RlEcmpRoutingTable* Initialized ECMP routing table
+ */
+RlEcmpRoutingTable *RlEcmpRoutingTable::initTable(int num, const char *initTopo_v, int port,
+                                                  double overTime_v, int totalStep_v, int simMode_v)
+{
+    if (!eTable) {
+        eTable = new RlEcmpRoutingTable();
+        eTable->setVals(port, num, initTopo_v, overTime_v, totalStep_v, simMode_v);
+        eTable->initiate();
+    }
+    return eTable;
+}
+
+/**
+ * @brief Initializes the instance, establishes ZMQ communication with the Python side based on TCP, and computes the equal-cost next hops
+ *
+ */
+void RlEcmpRoutingTable::initiate()
+{
+    RlBasicRoutingTable::initiate();
+    initTopoTable(initTopo, topo);
+    computeEqualCostNextHops();
+}
+
+void RlEcmpRoutingTable::setVals(int port, int num, const char *initTopo_v, double overTime_v,
+                                 int totalStep_v, int returnMode_v)
+{
+    zmqPort = port;
+    nodeNum = num;
+    initTopo = initTopo_v;
+    overTime = overTime_v;
+    totalStep = totalStep_v;
+    returnMode = returnMode_v;
+}
+
+/**
+ * @brief Number the directed links of the network topology row by row
+ *
+ * @param initTopo  Adjacency matrix, in the format of 0,1,1,0,...
+ * @param topo      Network topology to fill
+ */
+void RlEcmpRoutingTable::initTopoTable(string initTopo, int **topo)
+{
+    istringstream iss(initTopo);
+    string token;
+    int edgeCount = 0, row = 0, col = 0;
+    while (getline(iss, token, ',') && row < nodeNum) {
+        topo[row][col] = atoi(token.c_str()) ? edgeCount++ : -1;
+        col++;
+        if (col == nodeNum) {
+            row++;
+            col = 0;
+        }
+    }
+    edgeNum = edgeCount;
+}
+
+/**
+ * @brief Reverse BFS from every destination, the next hops of a node are all neighbors one hop closer to the destination
+ *
+ */
+void RlEcmpRoutingTable::computeEqualCostNextHops()
+{
+    nextHopOffset.assign(nodeNum * nodeNum + 1, 0);
+    nextHops.clear();
+    vector<int> hops(nodeNum);
+    vector<int> bfsQueue(nodeNum);
+    for (int dst = 0; dst < nodeNum; dst++) {
+        fill(hops.begin(), hops.end(), -1);
+        int head = 0, tail = 0;
+        hops[dst] = 0;
+        bfsQueue[tail++] = dst;
+        while (head < tail) {
+            int node = bfsQueue[head++];
+            for (int prev = 0; prev < nodeNum; prev++) {
+                if (topo[prev][node] != -1 && hops[prev] == -1) {
+                    hops[prev] = hops[node] + 1;
+                    bfsQueue[tail++] = prev;
+                }
+            }
+        }
+
+        for (int node = 0; node < nodeNum; node++) {
+            nextHopOffset[dst * nodeNum + node] = nextHops.size();
+            if (node == dst || hops[node] == -1)
+                continue;
+            for (int next = 0; next < nodeNum; next++) {
+                if (topo[node][next] != -1 && hops[next] == hops[node] - 1)
+                    nextHops.push_back(next);
+            }
+        }
+    }
+    nextHopOffset[nodeNum * nodeNum] = nextHops.size();
+}
+
+/**
+ * @brief Get the next hop of a flow, the router ID is part of the hash so that consecutive routers do not polarize
+ *
+ * @param nodeId    ID of the current node
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @param flowId    ID of the flow between the source and the destination
+ * @return int      Next hop node, -1 if the destination is unreachable
+ */
+int RlEcmpRoutingTable::getNextHop(int nodeId, int srcNode, int dstNode, int flowId)
+{
+    int begin = nextHopOffset[dstNode * nodeNum + nodeId];
+    int count = nextHopOffset[dstNode * nodeNum + nodeId + 1] - begin;
+    if (count == 0)
+        return -1;
+    if (count == 1)
+        return nextHops[begin];
+    uint64_t key = ((uint64_t)(uint32_t)srcNode << 32) | (uint32_t)dstNode;
+    uint64_t hash = mixHash(mixHash(key ^ ((uint64_t)(uint32_t)flowId << 16)) ^ (uint64_t)nodeId);
+    return nextHops[begin + hash % count];
+}
+
+int RlEcmpRoutingTable::getNextNode(int nodeId, int srcNode, int dstNode)
+{
+    return getNextHop(nodeId, srcNode, dstNode, 0);
+}
+
+/**
+ * @brief Get the path of each flow of an OD pair, flows are hashed independently at every node so they are followed one by one
+ *
+ * @param srcNode       ID of the source node
+ * @param dstNode       ID of the destination node
+ * @param flowNum       Number of flows of the OD pair
+ * @param fluidPaths    (node sequence, share) of each flow, a path that does not end at the destination is lost
+ */
+void RlEcmpRoutingTable::getFluidPaths(int srcNode, int dstNode, int flowNum,
+                                       vector<pair<vector<int>, double>> &fluidPaths)
+{
+    fluidPaths.clear();
+    for (int flowId = 0; flowId < flowNum; flowId++) {
+        vector<int> nodes(1, srcNode);
+        int node = srcNode;
+        while (node != dstNode && node != -1 && (int)nodes.size() <= nodeNum) {
+            node = getNextHop(node, srcNode, dstNode, flowId);
+            if (node != -1)
+                nodes.push_back(node);
+        }
+        fluidPaths.push_back(make_pair(nodes, 1.0 / flowNum));
+    }
+}
+
+pair<string, int> RlEcmpRoutingTable::getRoute(string path, Packet *packet)
+{
+    char pathCpy[50] = {0};
+    strncpy(pathCpy, path.c_str(), 49);
+    char *locPtr = NULL;
+    // The first token is the network name
+    strtok_r(pathCpy, ".", &locPtr);
+    char *thisNodeName = strtok_r(NULL, ".", &locPtr);
+    int thisNodeId = atoi(thisNodeName + 2);
+
+    string srcNode = packet->par("src").stringValue();
+    string dstNode = packet->par("dst").stringValue();
+    int srcNodeId = atoi(srcNode.c_str() + 2);
+    int dstNodeId = atoi(dstNode.c_str() + 2);
+
+    pair<string, int> p;
+
+    // Direct forwarding from Host to Router
+    if (thisNodeName[0] == 'H') {
+        p.first = "R[" + to_string(thisNodeId) + "]";
+        p.second = 1;
+        return p;
+    }
+
+    // Direct forwarding from Router to Host
+    if (thisNodeId == dstNodeId) {
+        p.first = dstNode;
+        int gid = 0;
+        for (int i = 0; i < nodeNum; i++) {
+            if (topo[dstNodeId][i] != -1) {
+                gid++;
+            }
+        }
+        p.second = gid + 1;
+        return p;
+    }
+
+    // Packets without a flow ID all belong to flow 0 of their OD pair
+    int flowId = packet->hasPar("flow") ? packet->par("flow").longValue() : 0;
+    int nextNodeId = getNextHop(thisNodeId, srcNodeId, dstNodeId, flowId);
+    if (nextNodeId == -1)
+        throw cRuntimeError("R[%d] has no route to R[%d]", thisNodeId, dstNodeId);
+    p.first = "R[" + to_string(nextNodeId) + "]";
+    p.second = getGateId(thisNodeId, nextNodeId);
+    countPkct(thisNodeId, nextNodeId, packet->getBitLength());
+
+    return p;
+}
+
+/**
+ * @brief Called after all packets of the current step have been sent, communicates with the ZMQ server (Python side), transfers the current
+ * step's throughput, and clears the already collected throughput data. The next hops are fixed, so the reply is ignored
+ *
+ * @param step      Current step number
+ * @param stepTime  Duration of each step
+ */
+void RlEcmpRoutingTable::updateRoutingTable(int step, double stepTime)
+{
+    updateNodeCount[step]++;
+    if (updateNodeCount[step] == nodeNum) {
+        // The last node to enter the next step update
+        string stateStr;
+        stateStr += "s@@" + to_string(step) + "@@";
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++) {
+                if (i == nodeNum - 1 && j == nodeNum - 1)
+                    stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime);
+                else
+                    stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime) + ",";
+            }
+        recordLinkLoads(step, stepTime);
+        clearPkts();
+
+        exchange(stateStr);
+        sendId = 0; // Reset packet ID for the next step
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 14:32:10
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 14:32:10
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlEcmpRoutingTable.h
+ * @Description  : Flow-hash ECMP routing table in RouterRL.
+ */
+#ifndef RLECMPROUTINGTABLE_H
+#define RLECMPROUTINGTABLE_H
+#include "RlBasicRoutingTable.h"
+
+/**
+ * Every router keeps the set of equal-cost (in hops) next hops towards each destination, computed once at startup.
+ * A packet picks one of them with a stateless hash of (src, dst, flow id, router), so all packets of a flow follow the
+ * same path and no per-packet random draw or path string is needed. The agent only observes, its actions are ignored.
+ */
+class RlEcmpRoutingTable : public RlBasicRoutingTable
+{
+public:
+    RlEcmpRoutingTable();
+    ~RlEcmpRoutingTable();
+    /**
+     * Used to get the unique static instance, throws an exception if the instance is not initialized.
+     */
+    static RlEcmpRoutingTable *getInstance();
+
+    /**
+     * Used to initialize the unique static instance, set parameters, and allocate memory for statistics variables.
+     */
+    static RlEcmpRoutingTable *initTable(int num, const char *initTopo_v, int port,
+                                         double overTime_v, int totalStep_v, int simMode_v);
+    void initiate() override;
+    void setVals(int port, int num, const char *initTopo_v, double overTime_v, int totalStep_v,
+                 int returnMode_v);
+    pair<string, int> getRoute(string path, Packet *packet) override;
+    void updateRoutingTable(int step, double stepTime) override;
+    int getNextNode(int nodeId, int srcNode, int dstNode) override;
+    int getNextHop(int nodeId, int srcNode, int dstNode, int flowId);
+    void getFluidPaths(int srcNode, int dstNode, int flowNum,
+                       vector<pair<vector<int>, double>> &fluidPaths) override;
+    void initTopoTable(string initTopo, int **topo);
+
+protected:
+    void computeEqualCostNextHops();
+
+    string initTopo = "";
+    vector<int> nextHopOffset; // Next hops of node i towards dst are nextHops[nextHopOffset[dst * nodeNum + i] ...
+    vector<int> nextHops;      // ... nextHopOffset[dst * nodeNum + i + 1]), sorted by the neighbor ID.
+
+private:
+    static RlEcmpRoutingTable *eTable;
+};
+
+#endif // RLECMPROUTINGTABLE_H
@@ -0,0 +1,372 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 18:02:37
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 18:02:37
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlFluidModel.cc
+ * @Description  : Analytic fluid model of the network for the fast-forward simulation mode of RouterRL.
+ */
+#include "RlFluidModel.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
+#define FLUID_HEADER_BYTES    28   // IPv4 and UDP headers carried on the links on top of the message
+#define FLUID_MAX_ITERATIONS  100  // Iterations of the fixed point between link loads and losses
+#define FLUID_TOLERANCE       1e-6 // Largest change of a link load, relative to its datarate, once converged
+#define FLUID_MIN_FLOW        1e-9 // Share of the demand still in flight under which hop-by-hop propagation stops
+#define HYBRID_MIN_CAPACITY   0.01 // Share of the datarate left to the packets of a link saturated by the background
+
+RlFluidModel *RlFluidModel::fluidModel = NULL;
+
+RlFluidModel::RlFluidModel(RlBasicRoutingTable *table_v, int nodeNum_v, int messageLength_v,
+                           string queueModel_v, int queueCapacity_v, int flowNum_v, int maxHops_v)
+    : table(table_v), nodeNum(nodeNum_v), messageLength(messageLength_v), queueModel(queueModel_v),
+      queueCapacity(queueCapacity_v), flowNum(flowNum_v), maxHops(maxHops_v)
+{
+}
+
+/**
+ * @brief Used to get the unique static instance, NULL if the instance is not initialized
+ *
+ * @return RlFluidModel* Fluid model
+ */
+RlFluidModel *RlFluidModel::getInstance()
+{
+    return fluidModel;
+}
+
+/**
+ * @brief Initialize the fluid model, the first host to call it sets the parameters of all hosts
+ *
+ * @param table_v           RL routing table whose routing state is followed and which receives the statistics
+ * @param network           Network module, containing the routers R[i]
+ * @param nodeNum_v         Number of routers
+ * @param messageLength_v   Length of the messages of the applications (bytes)
+ * @param queueModel_v      Queue model of the links: mm1k or md1
+ * @param queueCapacity_v   Packets waiting in the queue of an interface
+ * @param flowNum_v         Flows of each OD pair
+ * @param maxHops_v         Hops after which a flow is lost
+ * @return RlFluidModel* Initialized fluid model
+ */
+RlFluidModel *RlFluidModel::initModel(RlBasicRoutingTable *table_v, cModule *network,
+                                      int nodeNum_v, int messageLength_v, string queueModel_v,
+                                      int queueCapacity_v, int flowNum_v, int maxHops_v)
+{
+    if (!fluidModel) {
+        if (!table_v)
+            throw cRuntimeError("The fluid model needs an RL routing table");
+        if (queueModel_v != "mm1k" && queueModel_v != "md1")
+            throw cRuntimeError("Unknown fluid queue model '%s'", queueModel_v.c_str());
+        if (queueCapacity_v < 0 || messageLength_v <= 0)
+            throw cRuntimeError("Invalid fluid queue capacity %d or message length %d",
+                                queueCapacity_v, messageLength_v);
+        RlFluidModel *model = new RlFluidModel(table_v, nodeNum_v, messageLength_v, queueModel_v,
+                                               queueCapacity_v, max(1, flowNum_v), maxHops_v);
+        try {
+            model->readLinks(network);
+        } catch (...) {
+            delete model;
+            throw;
+        }
+        fluidModel = model;
+    }
+    return fluidModel;
+}
+
+/**
+ * @brief Read the datarate and the delay of the channel of every link between two routers
+ *
+ * @param network   Network module
+ */
+void RlFluidModel::readLinks(cModule *network)
+{
+    linkOf.assign(nodeNum * nodeNum, -1);
+    for (int i = 0; i < nodeNum; i++) {
+        cModule *router = network->getSubmodule("R", i);
+        if (!router)
+            throw cRuntimeError("The fluid model needs the router R[%d]", i);
+        if (!router->hasGate("pppg$o"))
+            continue;
+        for (int k = 0; k < router->gateSize("pppg$o"); k++) {
+            cGate *out = router->gate("pppg$o", k);
+            cGate *next = out->getNextGate();
+            cDatarateChannel *channel = dynamic_cast<cDatarateChannel *>(out->getChannel());
+            if (!next || !channel)
+                continue;
+            cModule *peer = next->getOwnerModule();
+            if (peer->getParentModule() != network || strcmp(peer->getName(), "R") != 0)
+                continue;
+            int j = peer->getIndex();
+            // Parallel links to the same neighbor keep the first one, as the routing tables do
+            if (j >= nodeNum || linkOf[i * nodeNum + j] != -1)
+                continue;
+            FluidLink link;
+            link.from = i;
+            link.to = j;
+            link.datarate = channel->getDatarate();
+            link.delay = channel->getDelay().dbl();
+            link.channel = channel;
+            if (link.datarate <= 0)
+                throw cRuntimeError("The channel from R[%d] to R[%d] has no datarate", i, j);
+            linkOf[i * nodeNum + j] = links.size();
+            links.push_back(link);
+        }
+    }
+}
+
+/**
+ * @brief Record the offered load of an OD pair for a step
+ *
+ * @param step  Step number
+ * @param src   ID of the source host
+ * @param dst   ID of the destination host
+ * @param rate  Offered load (Mbits/s)
+ */
+void RlFluidModel::addDemand(int step, int src, int dst, double rate)
+{
+    vector<double> &demand = demands[step % 2];
+    if (demand.empty())
+        demand.assign(nodeNum * nodeNum, 0);
+    if (src != dst && rate > 0)
+        demand[src * nodeNum + dst] += rate;
+}
+
+/**
+ * @brief Loss probability and mean sojourn time of a link under its offered load.
+ * M/M/1/K: exact, with K the queue capacity plus the packet in transmission. The overloaded case is computed on the
+ * mirrored distribution so that the powers of the load do not overflow.
+ * M/D/1: Pollaczek-Khinchine waiting time with an infinite queue, bounded by the time to drain a full queue. Only the
+ * excess of an overloaded link is lost.
+ *
+ * @param link  Link to update
+ */
+void RlFluidModel::updateQueue(FluidLink &link)
+{
+    double packetBits = (messageLength + FLUID_HEADER_BYTES) * 8.0;
+    double mu = link.datarate / packetBits;
+    double lambda = link.load / packetBits;
+    double rho = lambda / mu;
+    int k = queueCapacity + 1;
+    double wait = 1 / mu;
+    double loss = 0;
+    if (lambda > 0) {
+        if (queueModel == "md1") {
+            if (rho < 1)
+                wait = 1 / mu + rho / (2 * mu * (1 - rho));
+            else
+                loss = 1 - 1 / rho;
+            wait = rho < 1 ? min(wait, k / mu) : k / mu;
+        } else {
+            double queued;
+            if (fabs(rho - 1) < 1e-9) {
+                loss = 1.0 / (k + 1);
+                queued = k / 2.0;
+            } else if (rho < 1) {
+                double rhoK = pow(rho, k);
+                loss = (1 - rho) * rhoK / (1 - rhoK * rho);
+                queued = rho / (1 - rho) - (k + 1) * rhoK * rho / (1 - rhoK * rho);
+            } else {
+                double r = 1 / rho, rK = pow(r, k);
+                loss = (1 - r) / (1 - rK * r);
+                queued = k - (r / (1 - r) - (k + 1) * rK * r / (1 - rK * r));
+            }
+            // Little's law on the packets that enter the queue
+            wait = queued / (lambda * (1 - loss));
+        }
+    }
+    link.loss = loss;
+    link.sojourn = wait + link.delay;
+}
+
+/**
+ * @brief Propagate the load of an OD pair through the routing state under the current link losses
+ *
+ * @param src       ID of the source node
+ * @param dst       ID of the destination node
+ * @param rate      Offered load of the pair (bits/s)
+ * @param linkLoad  Offered load of each link (bits/s), the load of the pair is added to it
+ * @param delaySum  If not NULL, receives the sum of delay times rate of the delivered flow
+ * @param nodePass  If not NULL, receives the load (bits/s) passing through each router
+ * @return double   Delivered load (bits/s)
+ */
+double RlFluidModel::propagate(int src, int dst, double rate, vector<double> &linkLoad,
+                               double *delaySum, vector<double> *nodePass)
+{
+    double wireRatio = (double)(messageLength + FLUID_HEADER_BYTES) / messageLength;
+    double delivered = 0;
+
+    vector<pair<vector<int>, double>> paths;
+    table->getFluidPaths(src, dst, flowNum, paths);
+    if (!paths.empty()) {
+        for (auto &path : paths) {
+            const vector<int> &nodes = path.first;
+            double flow = rate * path.second, delay = 0;
+            for (size_t i = 0; i + 1 < nodes.size() && flow > 0; i++) {
+                if (nodePass)
+                    (*nodePass)[nodes[i]] += flow;
+                int l = linkOf[nodes[i] * nodeNum + nodes[i + 1]];
+                if (l == -1) {
+                    flow = 0;
+                    break;
+                }
+                linkLoad[l] += flow * wireRatio;
+                delay += links[l].sojourn;
+                flow *= 1 - links[l].loss;
+            }
+            if (nodes.empty() || nodes.back() != dst || flow <= 0)
+                continue;
+            if (nodePass)
+                (*nodePass)[dst] += flow;
+            delivered += flow;
+            if (delaySum)
+                *delaySum += flow * delay;
+        }
+        return delivered;
+    }
+
+    // Hop by hop: at[n] is the flow at node n after a number of hops, mass[n] the sum of its delay times its flow
+    vector<double> at(nodeNum, 0), next(nodeNum, 0), mass(nodeNum, 0), nextMass(nodeNum, 0);
+    vector<pair<int, double>> split;
+    at[src] = rate;
+    for (int hop = 0; hop <= maxHops; hop++) {
+        double inFlight = 0;
+        for (int n = 0; n < nodeNum; n++) {
+            if (at[n] <= 0)
+                continue;
+            if (nodePass)
+                (*nodePass)[n] += at[n];
+            if (n == dst) {
+                delivered += at[n];
+                if (delaySum)
+                    *delaySum += mass[n];
+                continue;
+            }
+            if (hop == maxHops)
+                continue;
+            table->getSplitRatios(n, src, dst, split);
+            for (auto &s : split) {
+                int l = linkOf[n * nodeNum + s.first];
+                if (l == -1)
+                    continue;
+                double flow = at[n] * s.second;
+                double keep = 1 - links[l].loss;
+                linkLoad[l] += flow * wireRatio;
+                next[s.first] += flow * keep;
+                nextMass[s.first] += (mass[n] * s.second + flow * links[l].sojourn) * keep;
+                inFlight += flow * keep;
+            }
+        }
+        if (inFlight <= FLUID_MIN_FLOW * rate)
+            break;
+        swap(at, next);
+        swap(mass, nextMass);
+        fill(next.begin(), next.end(), 0);
+        fill(nextMass.begin(), nextMass.end(), 0);
+    }
+    return delivered;
+}
+
+/**
+ * @brief Solve the link loads and losses under a demand, as a fixed point since the losses of a link thin the load of
+ * the following links (reduced load approximation). The links keep the solution of the previous step as a warm start
+ *
+ * @param demand    Offered load of each OD pair (Mbits/s), row-major
+ */
+void RlFluidModel::solve(const vector<double> &demand)
+{
+    vector<double> load(links.size(), 0);
+    for (int iter = 0; iter < FLUID_MAX_ITERATIONS; iter++) {
+        fill(load.begin(), load.end(), 0);
+        for (int src = 0; src < nodeNum; src++)
+            for (int dst = 0; dst < nodeNum; dst++)
+                if (demand[src * nodeNum + dst] > 0)
+                    propagate(src, dst, demand[src * nodeNum + dst] * 1000 * 1000, load, NULL,
+                              NULL);
+        double change = 0;
+        for (size_t l = 0; l < links.size(); l++) {
+            change = max(change, fabs(load[l] - links[l].load) / links[l].datarate);
+            links[l].load = load[l];
+            updateQueue(links[l]);
+        }
+        if (iter > 0 && change < FLUID_TOLERANCE)
+            break;
+    }
+}
+
+/**
+ * @brief Report the solved step to the routing table: the load of every link, and the traffic of every OD pair
+ *
+ * @param step          Step number
+ * @param stepTime      Duration of the step (s)
+ * @param demand        Offered load of each OD pair (Mbits/s), row-major
+ * @param countPairs    Whether the packets of the OD pairs are counted as sent and received
+ */
+void RlFluidModel::report(int step, double stepTime, const vector<double> &demand,
+                          bool countPairs)
+{
+    // Loads are converted to packets of the step, as the applications would have sent them
+    double packets = stepTime / (messageLength * 8.0);
+    vector<double> load(links.size(), 0);
+    vector<double> nodePass(nodeNum);
+    for (int src = 0; src < nodeNum && countPairs; src++) {
+        for (int dst = 0; dst < nodeNum; dst++) {
+            double rate = demand[src * nodeNum + dst] * 1000 * 1000;
+            if (rate <= 0)
+                continue;
+            double delaySum = 0;
+            fill(nodePass.begin(), nodePass.end(), 0);
+            double delivered = propagate(src, dst, rate, load, &delaySum, &nodePass);
+            for (auto &pass : nodePass)
+                pass *= packets;
+            table->countFluidDemand(step, src, dst, rate * packets, delivered * packets,
+                                    delivered > 0 ? delaySum / delivered : 0, nodePass);
+        }
+    }
+    for (auto &link : links)
+        table->countPkct(link.from, link.to, (int)llround(min(link.load * stepTime, (double)INT_MAX)));
+}
+
+/**
+ * @brief Solve the link loads and losses of a step, then report the traffic of every OD pair and the load of every
+ * link to the routing table
+ *
+ * @param step      Step number
+ * @param stepTime  Duration of the step (s)
+ */
+void RlFluidModel::evaluate(int step, double stepTime)
+{
+    if (step == evaluatedStep)
+        return;
+    evaluatedStep = step;
+    vector<double> &demand = demands[step % 2];
+    if (demand.empty())
+        return;
+    solve(demand);
+    report(step, stepTime, demand, true);
+    demand.assign(nodeNum * nodeNum, 0);
+}
+
+/**
+ * @brief Solve the background load of a step and leave the rest of the capacity of every link to the packets
+ *
+ * @param step          Step number
+ * @param stepTime      Duration of the step (s)
+ * @param countPairs    Whether the background OD pairs are counted as sent and received, false when the packets
+ *                      already stand for the whole load
+ */
+void RlFluidModel::applyBackground(int step, double stepTime, bool countPairs)
+{
+    if (step == evaluatedStep)
+        return;
+    evaluatedStep = step;
+    vector<double> &demand = demands[step % 2];
+    if (demand.empty())
+        demand.assign(nodeNum * nodeNum, 0);
+    solve(demand);
+    report(step, stepTime, demand, countPairs);
+    for (auto &link : links)
+        link.channel->setDatarate(
+            max(link.datarate - link.load, link.datarate * HYBRID_MIN_CAPACITY));
+    demand.assign(nodeNum * nodeNum, 0);
+}
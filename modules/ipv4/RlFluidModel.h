@@ -0,0 +1,95 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 18:02:37
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 18:02:37
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlFluidModel.h
+ * @Description  : Analytic fluid model of the network for the fast-forward simulation mode of RouterRL.
+ */
+#ifndef RLFLUIDMODEL_H
+#define RLFLUIDMODEL_H
+#include <string>
+#include <vector>
+
+#include "RlBasicRoutingTable.h"
+
+using namespace std;
+
+/**
+ * Replaces the packets of a step by fluid flows. The offered load of every OD pair is propagated through the current
+ * routing state of the RL routing table, either hop by hop with the split ratios of each node or along the paths of
+ * the pair, and every link between routers is modeled as a single queue (M/M/1/K or M/D/1) with the datarate and the
+ * delay of its NED channel. Losses thin the load of the following links, so link loads and losses are solved together
+ * as a fixed point (reduced load approximation).
+ * The results are handed to the routing table as if the packets of the step had been forwarded and received, so the
+ * states and rewards sent to the Python side have the same format as in packet mode.
+ * There is only a single global static object, shared by the applications of all hosts.
+ */
+class RlFluidModel
+{
+public:
+    static RlFluidModel *getInstance();
+
+    /**
+     * Used to initialize the unique static instance, reads the links between routers from the network module.
+     */
+    static RlFluidModel *initModel(RlBasicRoutingTable *table_v, cModule *network, int nodeNum_v,
+                                   int messageLength_v, string queueModel_v, int queueCapacity_v,
+                                   int flowNum_v, int maxHops_v);
+
+    /**
+     * Offered load (Mbits/s) of an OD pair during a step, called by the application of the source host.
+     */
+    void addDemand(int step, int src, int dst, double rate);
+
+    /**
+     * Solves the step and reports it to the routing table, only the first call of a step does the work.
+     */
+    void evaluate(int step, double stepTime);
+
+    /**
+     * Hybrid mode: solves the background load of a step and lowers the datarate of every link channel by its background
+     * load, so that the packets of the step see the remaining capacity. Only the first call of a step does the work.
+     */
+    void applyBackground(int step, double stepTime, bool countPairs);
+    bool isSolved(int step) const { return step == evaluatedStep; }
+
+protected:
+    struct FluidLink {
+        int from;
+        int to;
+        double datarate;    // bits/s
+        double delay;       // Propagation delay, s
+        double load = 0;    // Offered load, bits/s
+        double loss = 0;    // Loss probability
+        double sojourn = 0; // Mean time spent in the queue and on the wire, s
+        cDatarateChannel *channel = nullptr;
+    };
+
+    RlFluidModel(RlBasicRoutingTable *table_v, int nodeNum_v, int messageLength_v,
+                 string queueModel_v, int queueCapacity_v, int flowNum_v, int maxHops_v);
+    void readLinks(cModule *network);
+    void updateQueue(FluidLink &link);
+    double propagate(int src, int dst, double rate, vector<double> &linkLoad, double *delaySum,
+                     vector<double> *nodePass);
+    void solve(const vector<double> &demand);
+    void report(int step, double stepTime, const vector<double> &demand, bool countPairs);
+
+    RlBasicRoutingTable *table;
+    int nodeNum;
+    int messageLength;
+    string queueModel;       // mm1k or md1
+    int queueCapacity;       // Packets waiting in the queue of an interface
+    int flowNum;             // Flows of each OD pair, used by the tables that hash flows
+    int maxHops;             // Flows still in the network after maxHops hops are lost, as packets at their TTL
+    int evaluatedStep = -1;
+    vector<FluidLink> links;
+    vector<int> linkOf;      // Index in links of the link from i to j at linkOf[i * nodeNum + j], -1 if none
+    vector<double> demands[2]; // Offered load of each OD pair (Mbits/s) of the even and odd steps, row-major
+                               // (of the background only in hybrid mode)
+
+private:
+    static RlFluidModel *fluidModel;
+};
+
+#endif // RLFLUIDMODEL_H
@@ -0,0 +1,42 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 23:52:10
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 23:52:10
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlForkedFile.cc
+ * @Description  : Output file of each process of a simulation forked by the agent in RouterRL.
+ */
+#include "RlForkedFile.h"
+#include <pthread.h>
+#include <unistd.h>
+
+int RlForkedFile::forkNum = 0;
+
+/**
+ * @brief Name an output file, the fork handler is registered by the first one
+ *
+ * @param file_v    Configured file
+ */
+RlForkedFile::RlForkedFile(const string &file_v) : file(file_v), openedForks(forkNum)
+{
+    static bool registered = false;
+    if (!registered) {
+        pthread_atfork(NULL, NULL, &RlForkedFile::afterFork);
+        registered = true;
+    }
+}
+
+/**
+ * @brief Get the file of this process
+ *
+ * @return string   The configured file, suffixed by the pid in a forked child
+ */
+string RlForkedFile::getPath() const
+{
+    return forkNum ? file + "." + to_string(getpid()) : file;
+}
+
+void RlForkedFile::afterFork()
+{
+    forkNum++;
+}
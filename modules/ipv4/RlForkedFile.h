@@ -0,0 +1,42 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 23:52:10
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 23:52:10
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlForkedFile.h
+ * @Description  : Output file of each process of a simulation forked by the agent in RouterRL.
+ */
+#ifndef RLFORKEDFILE_H
+#define RLFORKEDFILE_H
+#include <string>
+
+using namespace std;
+
+/**
+ * Output file of the simulation in this process: the configured file in the simulator started by the agent, and the
+ * file suffixed by the pid in a child created by fork(). A fork only makes the file stale, and its writer opens the
+ * file of the child before its next write, so that no file is opened and no error is thrown in a fork handler. The
+ * writer still flushes its buffers before a fork, so that they are not written again by the child.
+ */
+class RlForkedFile
+{
+public:
+    RlForkedFile(const string &file_v);
+
+    // Whether the process forked since the file was opened, the file of the process must then be opened
+    bool isStale() const { return openedForks != forkNum; }
+    void setOpened() { openedForks = forkNum; }
+    const string &getFile() const { return file; }
+    string getPath() const;
+
+protected:
+    static void afterFork();
+
+    string file;
+    int openedForks;
+
+private:
+    static int forkNum; // Forks from the simulator started by the agent to this process
+};
+
+#endif // RLFORKEDFILE_H
@@ -0,0 +1,233 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 21:41:09
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 21:41:09
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlLogger.cc
+ * @Description  : Buffered logging of the simulator side of RouterRL, written by a background thread.
+ */
+#include "RlLogger.h"
+#include "RlStepProfiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <omnetpp.h>
+#include <pthread.h>
+
+using namespace omnetpp;
+
+RlLogger *RlLogger::logger = NULL;
+
+static const char *levelNames[] = {"error", "warn", "info", "debug"};
+
+/**
+ * @brief Initialize the logger, only the first call creates it
+ *
+ * @param file_v    Log file, empty to log to stdout only
+ * @param level_v   Records above this level are skipped
+ * @param console_v Whether records are copied to stdout
+ * @return RlLogger* Logger
+ */
+RlLogger *RlLogger::initLogger(string file_v, int level_v, bool console_v)
+{
+    if (!logger) {
+        pthread_atfork(&RlLogger::beforeFork, &RlLogger::afterForkParent, NULL);
+        atexit(&RlLogger::atExit);
+        logger = new RlLogger(file_v, level_v, console_v);
+    }
+    return logger;
+}
+
+/**
+ * @brief Get the level of a name: error, warn, info or debug
+ *
+ * @param name  Name of the level
+ * @return int  Level
+ */
+int RlLogger::parseLevel(const char *name)
+{
+    for (int i = LOG_ERROR; i <= LOG_DEBUG; i++)
+        if (strcmp(name, levelNames[i]) == 0)
+            return i;
+    throw cRuntimeError("Unknown log level '%s', expected error, warn, info or debug", name);
+}
+
+RlLogger::RlLogger(string file_v, int level_v, bool console_v) : file(file_v), level(level_v), console(console_v)
+{
+    if (!file.getFile().empty()) {
+        output = fopen(file.getPath().c_str(), "w");
+        if (!output)
+            throw cRuntimeError("Cannot write the log file '%s'", file.getPath().c_str());
+    }
+    buffer = new char[LOG_BUFFER_SIZE];
+    origin = RlStepProfiler::now();
+    writer = thread(&RlLogger::writerLoop, this);
+}
+
+/**
+ * @brief Format a record into the ring buffer, waits for the writer thread only if the buffer is full
+ *
+ * @param level Level of the record
+ * @param text  Text of the record
+ * @param size  Size of the text
+ */
+void RlLogger::push(int level, const char *text, size_t size)
+{
+    char prefix[80];
+    int prefixSize = snprintf(prefix, sizeof(prefix), "%.6f,%.9g,%s,\"", (RlStepProfiler::now() - origin) * 1e-9,
+                              simTime().dbl(), levelNames[level]);
+    // Escaped, a text takes at most half of the buffer
+    size = min(size, (size_t)LOG_BUFFER_SIZE / 4);
+    const char *end = text + size;
+    uint64_t total = prefixSize + size + count(text, end, '"') + 2;
+
+    uint64_t position = head.load(memory_order_relaxed);
+    while (position + total - tail.load(memory_order_acquire) > LOG_BUFFER_SIZE)
+        this_thread::yield();
+    copyIn(position, prefix, prefixSize);
+    uint64_t cursor = position + prefixSize;
+    // Double quotes are doubled, as in CSV
+    while (text < end) {
+        const char *quote = (const char *)memchr(text, '"', end - text);
+        size_t chunk = (quote ? quote + 1 : end) - text;
+        copyIn(cursor, text, chunk);
+        cursor += chunk;
+        text += chunk;
+        if (quote)
+            copyIn(cursor++, "\"", 1);
+    }
+    copyIn(cursor, "\"\n", 2);
+    // Publishes the record to the writer thread
+    head.store(position + total, memory_order_release);
+}
+
+/**
+ * @brief Print an error or a warning to stderr when logging is off, so that it is never lost
+ *
+ * @param level Level of the record
+ * @param text  Text of the record
+ */
+void RlLogger::report(int level, const string &text)
+{
+    fprintf(stderr, "%s: %s\n", levelNames[level], text.c_str());
+}
+
+/**
+ * @brief Log a record at the exit of the process, where nothing can be thrown: the record is printed to stderr if the
+ * log file of a forked child cannot be made
+ *
+ * @param level Level of the record
+ * @param text  Text of the record
+ */
+void RlLogger::logAtExit(int level, const string &text)
+{
+    try {
+        log(level, text);
+    } catch (cRuntimeError &e) {
+        report(LOG_ERROR, e.what());
+        report(level, text);
+    }
+}
+
+void RlLogger::copyIn(uint64_t position, const char *data, size_t size)
+{
+    size_t offset = position % LOG_BUFFER_SIZE;
+    size_t first = min(size, (size_t)LOG_BUFFER_SIZE - offset);
+    memcpy(buffer + offset, data, first);
+    memcpy(buffer, data + first, size - first);
+}
+
+/**
+ * @brief Write the records of the ring buffer, called by the writer thread or by the simulation thread when the writer
+ * thread cannot run
+ *
+ * @return true     Records were written
+ * @return false    The buffer was empty
+ */
+bool RlLogger::drain()
+{
+    uint64_t start = tail.load(memory_order_relaxed);
+    uint64_t end = head.load(memory_order_acquire);
+    if (start == end)
+        return false;
+    size_t offset = start % LOG_BUFFER_SIZE;
+    size_t size = end - start;
+    size_t first = min(size, (size_t)LOG_BUFFER_SIZE - offset);
+    for (FILE *stream : {output, console ? stdout : NULL}) {
+        if (!stream)
+            continue;
+        fwrite(buffer + offset, 1, first, stream);
+        fwrite(buffer, 1, size - first, stream);
+        fflush(stream);
+    }
+    tail.store(end, memory_order_release);
+    return true;
+}
+
+void RlLogger::writerLoop()
+{
+    while (!stopping.load(memory_order_acquire)) {
+        bool written;
+        {
+            lock_guard<mutex> lock(drainMutex);
+            written = drain();
+        }
+        if (!written)
+            this_thread::sleep_for(chrono::milliseconds(5));
+    }
+}
+
+/**
+ * @brief Write the remaining records at the exit of the process
+ *
+ */
+void RlLogger::atExit()
+{
+    // A forked child without records has no writer thread and nothing to write
+    if (!logger || logger->file.isStale())
+        return;
+    logger->stopping.store(true, memory_order_release);
+    if (logger->writer.joinable())
+        logger->writer.join();
+    logger->drain();
+    if (logger->output)
+        fclose(logger->output);
+    logger->output = NULL;
+}
+
+/**
+ * @brief Stop the writer thread between two writes and write the pending records, so that the child does not inherit
+ * them. The simulation thread is the one forking, so no record is added meanwhile
+ *
+ */
+void RlLogger::beforeFork()
+{
+    if (!logger)
+        return;
+    logger->drainMutex.lock();
+    logger->drain();
+}
+
+void RlLogger::afterForkParent()
+{
+    if (logger)
+        logger->drainMutex.unlock();
+}
+
+/**
+ * @brief Continue the log of a child process created by fork() in its own file, before its first record. The writer
+ * thread only exists in the parent, so the logger of the parent is leaked rather than destroyed, and a new one starts
+ * its own thread
+ *
+ */
+void RlLogger::continueAfterFork()
+{
+    RlLogger *parent = logger;
+    RlLogger *child = new RlLogger(parent->file.getFile(), parent->level, parent->console);
+    child->origin = parent->origin;
+    // The records of the parent were written before the fork
+    if (parent->output)
+        fclose(parent->output);
+    logger = child;
+}
@@ -0,0 +1,92 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 21:41:09
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 21:41:09
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlLogger.h
+ * @Description  : Buffered logging of the simulator side of RouterRL, written by a background thread.
+ */
+#ifndef RLLOGGER_H
+#define RLLOGGER_H
+#include "RlForkedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+#define LOG_ERROR 0 // Errors that do not stop the simulation
+#define LOG_WARN  1 // Unexpected situations the simulation recovers from
+#define LOG_INFO  2 // Setup of the simulation, e.g. the connection to the agent
+#define LOG_DEBUG 3 // States, actions and rewards of every step
+
+#define LOG_BUFFER_SIZE (1 << 22) // Bytes of the ring buffer between the simulation and the writer thread
+
+/**
+ * Log records are formatted by the simulation into a lock-free ring buffer with a single producer, and a background
+ * thread drains them to the log file, so that the simulation never waits for the disk unless the buffer is full. Each
+ * record is a CSV line:
+ *   wall_s,sim_s,level,"text"
+ * where wall_s is the wall time since the start of the logger. Records are copied to stdout too when console output
+ * is on. Records above the level of the logger are skipped before they are formatted. Double quotes in the texts
+ * are doubled, as in CSV, and texts are cut to a quarter of the buffer. When logging is off, errors and warnings are
+ * still printed to stderr.
+ * There is only a single global static object, and none when logging is off. A child process created by fork() writes
+ * its own log file, see RlForkedFile.
+ */
+class RlLogger
+{
+public:
+    static RlLogger *getInstance() { return logger; }
+
+    /**
+     * Used to initialize the unique static instance, opens the log file and starts the writer thread.
+     */
+    static RlLogger *initLogger(string file_v, int level_v, bool console_v);
+    static int parseLevel(const char *name);
+
+    static bool enabled(int level) { return logger && level <= logger->level; }
+    static void log(int level, const string &text)
+    {
+        if (enabled(level)) {
+            if (logger->file.isStale())
+                continueAfterFork();
+            logger->push(level, text.data(), text.size());
+        }
+        else if (!logger && level <= LOG_WARN)
+            report(level, text);
+    }
+    static void logAtExit(int level, const string &text);
+
+protected:
+    RlLogger(string file_v, int level_v, bool console_v);
+    static void beforeFork();
+    static void afterForkParent();
+    static void continueAfterFork();
+    static void atExit();
+    static void report(int level, const string &text);
+    void push(int level, const char *text, size_t size);
+    void copyIn(uint64_t position, const char *data, size_t size);
+    bool drain();
+    void writerLoop();
+
+    RlForkedFile file;
+    int level;
+    bool console;
+    FILE *output = NULL;
+    uint64_t origin = 0;       // Wall-clock origin of the log, ns
+    char *buffer;              // Ring buffer of LOG_BUFFER_SIZE bytes
+    atomic<uint64_t> head{0};  // Bytes written by the simulation, only stored by the simulation thread
+    atomic<uint64_t> tail{0};  // Bytes written to the file, only stored by the writer thread
+    atomic<bool> stopping{false};
+    mutex drainMutex;          // Held while draining, so that a fork does not copy a half-written file buffer
+    thread writer;
+
+private:
+    static RlLogger *logger;
+};
+
+#endif // RLLOGGER_H
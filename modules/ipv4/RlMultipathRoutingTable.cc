@@ -47,17 +47,19 @@ RlMultipathRoutingTable *RlMultipathRoutingTable::getInstance()
  * @param overTime_v        Timeout value
  * @param totalStep_v       Total number of simulation steps
  * @param simMode_v         Simulation mode
+ * @param candidatePathNum_v Candidate paths of each OD pair, 0 for paths given by the agent
  * @return RlMultipathRoutingTable* Initialized probability routing table
  */
 RlMultipathRoutingTable *RlMultipathRoutingTable::initTable(int num, const char *initTopo_v,
                                                             const char *initRoutingTable_v,
                                                             int port, double overTime_v,
-                                                            int totalStep_v, int simMode_v)
+                                                            int totalStep_v, int simMode_v,
+                                                            int candidatePathNum_v)
 {
     if (!multipathRoutingTable) {
         multipathRoutingTable = new RlMultipathRoutingTable();
         multipathRoutingTable->setVals(port, num, initTopo_v, initRoutingTable_v, overTime_v,
-                                       totalStep_v, simMode_v);
+                                       totalStep_v, simMode_v, candidatePathNum_v);
         multipathRoutingTable->initiate();
     }
     return multipathRoutingTable;
@@ -72,7 +74,12 @@ void RlMultipathRoutingTable::initiate()
 
     RlBasicRoutingTable::initiate();
     RlPathRoutingTable::initTopoTable(initTopo, topo);
-    initSplitRatioTable(initRoutingTable);
+    if (candidatePathNum > 0) {
+        initCatalog();
+        catalogSplit.resize(nodeNum * nodeNum);
+    } else {
+        initSplitRatioTable(initRoutingTable);
+    }
     RlPathRoutingTable::initCnts();
 }
 
@@ -80,7 +87,7 @@ void RlMultipathRoutingTable::initTopoTable(string initTopo, int **topo)
 {
     istringstream iss(initTopo);
     string token;
-    static int edgeCount, row, col = 0;
+    int edgeCount = 0, row = 0, col = 0;
     while (getline(iss, token, ',')) {
         int isConnection = std::stoi(token); // Convert string to integer
         if (isConnection) {
@@ -114,6 +121,110 @@ void RlMultipathRoutingTable::initSplitRatioTable(string initRoutingTable)
     }
 }
 
+/**
+ * @brief Parse the split ratios chosen by the agent over the candidate paths
+ *
+ * @param action    Message format: index:ratio,index:ratio;index:ratio;... one group for each OD pair in the order of the exported catalog
+ */
+void RlMultipathRoutingTable::parseCatalogSplit(string action)
+{
+    stringstream ssBuffer(action);
+    string group;
+    for (int src = 0; src < nodeNum; src++) {
+        for (int dst = 0; dst < nodeNum; dst++) {
+            if (catalog->getPathNum(src, dst) == 0)
+                continue;
+            if (!getline(ssBuffer, group, ';'))
+                return;
+            vector<pair<int, float>> &split = catalogSplit[src * nodeNum + dst];
+            split.clear();
+            stringstream ssGroup(group);
+            string item;
+            while (getline(ssGroup, item, ',')) {
+                size_t sep = item.find(':');
+                if (sep == string::npos)
+                    continue;
+                split.push_back(make_pair(atoi(item.substr(0, sep).c_str()),
+                                          atof(item.substr(sep + 1).c_str())));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Choose a candidate path for a packet according to the split ratios
+ *
+ * @param srcNode   Source node
+ * @param dstNode   Destination node
+ * @return int      Global path ID in the catalog
+ */
+int RlMultipathRoutingTable::chooseCatalogPath(int srcNode, int dstNode)
+{
+    const vector<pair<int, float>> &split = catalogSplit[srcNode * nodeNum + dstNode];
+    int index = 0;
+    float ratioSum = 0.0;
+    for (int i = 0; i < (int)split.size(); i++) {
+        ratioSum += split[i].second;
+    }
+    if (ratioSum > 0) {
+        static mt19937 gen(random_device{}());
+        uniform_real_distribution<> dis(0, ratioSum);
+        float randProb = dis(gen);
+        float curProb = 0.0;
+        index = split.back().first;
+        for (int i = 0; i < (int)split.size(); i++) {
+            curProb += split[i].second;
+            if (randProb < curProb) {
+                index = split[i].first;
+                break;
+            }
+        }
+    }
+    int pathId = catalog->getPathId(srcNode, dstNode, index);
+    return pathId == -1 ? catalog->getPathId(srcNode, dstNode, 0) : pathId;
+}
+
+/**
+ * @brief Get the split paths of an OD pair with their share of the traffic, the expectation of the random choice of getRoute
+ *
+ * @param srcNode       Source node
+ * @param dstNode       Destination node
+ * @param flowNum       Number of flows of the OD pair
+ * @param fluidPaths    (node sequence, share) of each path
+ */
+void RlMultipathRoutingTable::getFluidPaths(int srcNode, int dstNode, int flowNum,
+                                            vector<pair<vector<int>, double>> &fluidPaths)
+{
+    fluidPaths.clear();
+    float ratioSum = 0.0;
+    if (catalog) {
+        const vector<pair<int, float>> &split = catalogSplit[srcNode * nodeNum + dstNode];
+        for (auto &item : split)
+            ratioSum += item.second;
+        for (auto &item : split) {
+            int pathId = catalog->getPathId(srcNode, dstNode, item.first);
+            if (ratioSum > 0 && item.second > 0 && pathId != -1)
+                fluidPaths.push_back(make_pair(catalog->getPath(pathId), item.second / ratioSum));
+        }
+        // Without split ratios, every packet takes the first candidate path
+        if (fluidPaths.empty() && catalog->getPathId(srcNode, dstNode, 0) != -1)
+            fluidPaths.push_back(
+                make_pair(catalog->getPath(catalog->getPathId(srcNode, dstNode, 0)), 1.0));
+        return;
+    }
+    auto it = splitRatio.find(make_pair(srcNode, dstNode));
+    if (it != splitRatio.end()) {
+        for (auto &item : it->second)
+            ratioSum += item.second;
+        for (auto &item : it->second)
+            if (ratioSum > 0 && item.second > 0)
+                fluidPaths.push_back(
+                    make_pair(parsePathNodes(item.first), item.second / ratioSum));
+    }
+    if (fluidPaths.empty())
+        fluidPaths.push_back(make_pair(parsePathNodes(findInitPath(srcNode, dstNode)), 1.0));
+}
+
 pair<string, int> RlMultipathRoutingTable::getRoute(string path, Packet *packet)
 {
     char pathCpy[50] = {0};
@@ -131,7 +242,17 @@ pair<string, int> RlMultipathRoutingTable::getRoute(string path, Packet *packet)
     pair<string, int> p;
 
     // Direct forwarding from Host to Router
-    if (thisNodeName[0] == 'H') {
+    if (thisNodeName[0] == 'H' && catalog) {
+        packet->addPar("pathId").setLongValue(chooseCatalogPath(srcNodeId, dstNodeId));
+        p.first = "R[" + to_string(thisNodeId) + "]";
+        p.second = 1;
+        int step = packet->par("step").longValue();
+        if (packetSendNum[srcNodeId][dstNodeId].size() <= step) {
+            packetSendNum[srcNodeId][dstNodeId].resize(step + 1); // Initialize to 0
+        }
+        packetSendNum[srcNodeId][dstNodeId][step] += getPacketWeight(packet);
+        return p;
+    } else if (thisNodeName[0] == 'H') {
         // Assign split paths to the packet
         vector<pair<string, float>> pktSplitInfo = splitRatio[pktInfo];
         float ratioSum = 0.0;
@@ -177,7 +298,7 @@ pair<string, int> RlMultipathRoutingTable::getRoute(string path, Packet *packet)
         if (packetSendNum[srcNodeId][dstNodeId].size() <= step) {
             packetSendNum[srcNodeId][dstNodeId].resize(step + 1); // Initialize to 0
         }
-        packetSendNum[srcNodeId][dstNodeId][step]++;
+        packetSendNum[srcNodeId][dstNodeId][step] += getPacketWeight(packet);
         return p;
     } else if (thisNodeId == dstNodeId) { // Direct forwarding from Router to Host
         p.first = dstNode;
@@ -218,34 +339,30 @@ void RlMultipathRoutingTable::updateRoutingTable(int step, double stepTime)
                 else
                     stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime) + ",";
             }
+        recordLinkLoads(step, stepTime);
         clearPkts();
 
-        const char *reqData = stateStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmq_socket->send(request, zmq::send_flags::none);
-        zmq::message_t reply;
-        auto res = zmq_socket->recv(reply, zmq::recv_flags::none);
-        char *buffer = new char[reply.size() + 1];
-        memset(buffer, 0, reply.size() + 1);
-        memcpy(buffer, reply.data(), reply.size());
-
-        // Message format: src,dst,path,ratio;src,dst,path,ratio;...
-        splitRatio.clear();
-        string splitItem;
-        stringstream ssBuffer(buffer);
-        while (getline(ssBuffer, splitItem, ';')) {
-            vector<string> items;
-            stringstream ssItem(splitItem);
-            string item;
-            while (getline(ssItem, item, ',')) {
-                items.push_back(item);
+        string replyStr = exchange(stateStr);
+
+        if (catalog) {
+            // Message format: index:ratio,index:ratio;index:ratio;...
+            parseCatalogSplit(replyStr);
+        } else {
+            // Message format: src,dst,path,ratio;src,dst,path,ratio;...
+            splitRatio.clear();
+            string splitItem;
+            stringstream ssBuffer(replyStr);
+            while (getline(ssBuffer, splitItem, ';')) {
+                vector<string> items;
+                stringstream ssItem(splitItem);
+                string item;
+                while (getline(ssItem, item, ',')) {
+                    items.push_back(item);
+                }
+                splitRatio[make_pair(atoi(items[0].c_str()), atoi(items[1].c_str()))].push_back(
+                    make_pair(items[2], atof(items[3].c_str())));
             }
-            splitRatio[make_pair(atoi(items[0].c_str()), atoi(items[1].c_str()))].push_back(
-                make_pair(items[2], atof(items[3].c_str())));
         }
         sendId = 0; // Reset packet ID for the next step
-        delete buffer;
     }
 }
\ No newline at end of file
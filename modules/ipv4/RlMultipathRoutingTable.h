@@ -29,15 +29,22 @@ public:
     static RlMultipathRoutingTable *getInstance();
     static RlMultipathRoutingTable *initTable(int num, const char *initTopo_v,
                                               const char *initRoutingTable_v, int port,
-                                              double overTime_v, int totalStep_v, int simMode_v);
+                                              double overTime_v, int totalStep_v, int simMode_v,
+                                              int candidatePathNum_v = 0);
     void initiate() override;
     void updateRoutingTable(int step, double stepTime) override;
     pair<string, int> getRoute(string path, Packet *packet) override;
     void initTopoTable(string initTopo, int **topo);
     void initSplitRatioTable(string initRoutingTable);
+    void parseCatalogSplit(string action);
+    int chooseCatalogPath(int srcNode, int dstNode);
+    void getFluidPaths(int srcNode, int dstNode, int flowNum,
+                       vector<pair<vector<int>, double>> &fluidPaths) override;
 
 protected:
     unordered_map<pair<int, int>, vector<pair<string, float>>, pair_hash_in_split> splitRatio;
+    vector<vector<pair<int, float>>>
+        catalogSplit; // Split ratios over the candidate path indices of each OD pair, used with the catalog.
 
 private:
     static RlMultipathRoutingTable *multipathRoutingTable;
@@ -0,0 +1,208 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 09:12:40
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 09:12:40
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlPathCatalog.cc
+ * @Description  : Candidate path catalog of all OD pairs in RouterRL.
+ */
+#include "RlPathCatalog.h"
+#include <algorithm>
+#include <queue>
+#include <set>
+
+RlPathCatalog::RlPathCatalog(int nodeNum, int **topo) : nodeNum(nodeNum), topo(topo)
+{
+}
+
+/**
+ * @brief Compute the k shortest loopless paths of every OD pair and assign global path IDs
+ *
+ * @param k     Max number of candidate paths for each OD pair
+ */
+void RlPathCatalog::build(int k)
+{
+    paths.clear();
+    odOffset.assign(nodeNum * nodeNum + 1, 0);
+    for (int src = 0; src < nodeNum; src++) {
+        for (int dst = 0; dst < nodeNum; dst++) {
+            odOffset[src * nodeNum + dst] = paths.size();
+            if (src == dst)
+                continue;
+            for (auto &path : findKShortestPaths(src, dst, k)) {
+                paths.push_back(path);
+            }
+        }
+    }
+    odOffset[nodeNum * nodeNum] = paths.size();
+}
+
+/**
+ * @brief Breadth-first search for the shortest path in hop count, skipping the blocked nodes and edges
+ *
+ * @param src           Source node
+ * @param dst           Destination node
+ * @param blockedNodes  Nodes that can not be used, size nodeNum
+ * @param blockedEdges  Directed edges that can not be used, indexed by from * nodeNum + to
+ * @return vector<int>  Node sequence of the path, empty if dst is unreachable
+ */
+vector<int> RlPathCatalog::findShortestPath(int src, int dst, const vector<char> &blockedNodes,
+                                            const vector<char> &blockedEdges) const
+{
+    vector<int> parent(nodeNum, -1);
+    vector<char> visited(nodeNum, 0);
+    queue<int> nodes;
+    nodes.push(src);
+    visited[src] = 1;
+    while (!nodes.empty() && !visited[dst]) {
+        int node = nodes.front();
+        nodes.pop();
+        for (int next = 0; next < nodeNum; next++) {
+            if (topo[node][next] == -1 || visited[next] || blockedNodes[next]
+                || blockedEdges[node * nodeNum + next])
+                continue;
+            visited[next] = 1;
+            parent[next] = node;
+            nodes.push(next);
+        }
+    }
+
+    vector<int> path;
+    if (!visited[dst])
+        return path;
+    for (int node = dst; node != -1; node = parent[node]) {
+        path.push_back(node);
+    }
+    reverse(path.begin(), path.end());
+    return path;
+}
+
+/**
+ * @brief Yen's algorithm for the k shortest loopless paths between two nodes
+ *
+ * @param src   Source node
+ * @param dst   Destination node
+ * @param k     Max number of paths
+ * @return vector<vector<int>> Paths ordered by hop count
+ */
+vector<vector<int>> RlPathCatalog::findKShortestPaths(int src, int dst, int k) const
+{
+    vector<vector<int>> shortestPaths;
+    vector<char> blockedNodes(nodeNum, 0);
+    vector<char> blockedEdges(nodeNum * nodeNum, 0);
+
+    vector<int> firstPath = findShortestPath(src, dst, blockedNodes, blockedEdges);
+    if (firstPath.empty())
+        return shortestPaths;
+    shortestPaths.push_back(firstPath);
+
+    // Candidates ordered by hop count first, then by node sequence to keep the result deterministic
+    set<pair<int, vector<int>>> candidates;
+    while ((int)shortestPaths.size() < k) {
+        const vector<int> lastPath = shortestPaths.back();
+        for (size_t i = 0; i + 1 < lastPath.size(); i++) {
+            int spurNode = lastPath[i];
+
+            // Block the next edge of every found path sharing the same root path
+            for (auto &path : shortestPaths) {
+                if (path.size() > i + 1 && equal(lastPath.begin(), lastPath.begin() + i + 1,
+                                                 path.begin())) {
+                    blockedEdges[path[i] * nodeNum + path[i + 1]] = 1;
+                }
+            }
+            // Block the nodes of the root path so that the spur path is loopless
+            for (size_t j = 0; j < i; j++) {
+                blockedNodes[lastPath[j]] = 1;
+            }
+
+            vector<int> spurPath = findShortestPath(spurNode, dst, blockedNodes, blockedEdges);
+            if (!spurPath.empty()) {
+                vector<int> totalPath(lastPath.begin(), lastPath.begin() + i);
+                totalPath.insert(totalPath.end(), spurPath.begin(), spurPath.end());
+                candidates.insert(make_pair((int)totalPath.size(), totalPath));
+            }
+
+            fill(blockedNodes.begin(), blockedNodes.end(), 0);
+            fill(blockedEdges.begin(), blockedEdges.end(), 0);
+        }
+
+        if (candidates.empty())
+            break;
+        shortestPaths.push_back(candidates.begin()->second);
+        candidates.erase(candidates.begin());
+    }
+    return shortestPaths;
+}
+
+int RlPathCatalog::getPathNum(int src, int dst) const
+{
+    return odOffset[src * nodeNum + dst + 1] - odOffset[src * nodeNum + dst];
+}
+
+/**
+ * @brief Get the global path ID of a candidate path
+ *
+ * @param src       Source node
+ * @param dst       Destination node
+ * @param index     Index of the path among the candidates of the OD pair
+ * @return int      Global path ID, -1 if the OD pair has no such candidate
+ */
+int RlPathCatalog::getPathId(int src, int dst, int index) const
+{
+    if (index < 0 || index >= getPathNum(src, dst))
+        return -1;
+    return odOffset[src * nodeNum + dst] + index;
+}
+
+int RlPathCatalog::getPathLength(int pathId) const
+{
+    return paths[pathId].size() - 1;
+}
+
+const vector<int> &RlPathCatalog::getPath(int pathId) const
+{
+    return paths[pathId];
+}
+
+/**
+ * @brief Get the next hop of a node on a catalog path
+ *
+ * @param pathId        Global path ID
+ * @param currentNode   ID of the current node
+ * @return int          Next hop node, -1 if the current node is not on the path
+ */
+int RlPathCatalog::getNextNode(int pathId, int currentNode) const
+{
+    const vector<int> &path = paths[pathId];
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        if (path[i] == currentNode)
+            return path[i + 1];
+    }
+    return -1;
+}
+
+string RlPathCatalog::toString() const
+{
+    string catalogStr;
+    for (int src = 0; src < nodeNum; src++) {
+        for (int dst = 0; dst < nodeNum; dst++) {
+            int pathNum = getPathNum(src, dst);
+            if (pathNum == 0)
+                continue;
+            if (!catalogStr.empty())
+                catalogStr += ";";
+            catalogStr += to_string(src) + "," + to_string(dst) + ",";
+            for (int i = 0; i < pathNum; i++) {
+                const vector<int> &path = paths[odOffset[src * nodeNum + dst] + i];
+                if (i)
+                    catalogStr += "|";
+                for (size_t j = 0; j < path.size(); j++) {
+                    if (j)
+                        catalogStr += ".";
+                    catalogStr += to_string(path[j]);
+                }
+            }
+        }
+    }
+    return catalogStr;
+}
@@ -0,0 +1,53 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 09:12:40
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 09:12:40
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlPathCatalog.h
+ * @Description  : Candidate path catalog of all OD pairs in RouterRL.
+ */
+#ifndef RLPATHCATALOG_H
+#define RLPATHCATALOG_H
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Stores up to k loopless candidate paths for every OD pair, computed once at startup with Yen's algorithm.
+ * Each path gets a global path ID, so packets only need to carry an integer instead of the whole path string,
+ * and actions only need to refer to paths by their index within the OD pair.
+ */
+class RlPathCatalog
+{
+public:
+    RlPathCatalog(int nodeNum, int **topo);
+
+    /**
+     * Computes the k shortest (in hop count) loopless paths for every OD pair.
+     */
+    void build(int k);
+
+    int getPathNum(int src, int dst) const;
+    int getPathId(int src, int dst, int index) const;
+    int getPathLength(int pathId) const;
+    int getNextNode(int pathId, int currentNode) const;
+    const vector<int> &getPath(int pathId) const;
+
+    /**
+     * Serializes the catalog for the Python side, in the format of src,dst,path|path|...;src,dst,path|...
+     */
+    string toString() const;
+
+protected:
+    vector<int> findShortestPath(int src, int dst, const vector<char> &blockedNodes,
+                                 const vector<char> &blockedEdges) const;
+    vector<vector<int>> findKShortestPaths(int src, int dst, int k) const;
+
+    int nodeNum;
+    int **topo;                 // Network topology, -1 for no link between nodes.
+    vector<vector<int>> paths;  // Node sequence of each path, indexed by the global path ID.
+    vector<int> odOffset;       // Global ID of the first path of each OD pair, size nodeNum * nodeNum + 1.
+};
+
+#endif // RLPATHCATALOG_H
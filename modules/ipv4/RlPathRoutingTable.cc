@@ -24,6 +24,8 @@ RlPathRoutingTable::~RlPathRoutingTable()
         zmq_context->close();
         delete zmq_context;
     }
+    if (catalog)
+        delete catalog;
     if (pathRoutingTable)
         delete pathRoutingTable;
 }
@@ -47,16 +49,18 @@ RlPathRoutingTable *RlPathRoutingTable::getInstance()
  * @param overTime_v        Timeout value
  * @param totalStep_v       Total number of simulation steps
  * @param simMode_v         Simulation mode
+ * @param candidatePathNum_v Candidate paths of each OD pair, 0 for paths given by the agent
  * @return RlPathRoutingTable* Initialized probability routing table
  */
 RlPathRoutingTable *RlPathRoutingTable::initTable(int num, const char *initTopo_v,
                                                   const char *initRoutingTable_v, int port,
-                                                  double overTime_v, int totalStep_v, int simMode_v)
+                                                  double overTime_v, int totalStep_v, int simMode_v,
+                                                  int candidatePathNum_v)
 {
     if (!pathRoutingTable) {
         pathRoutingTable = new RlPathRoutingTable();
         pathRoutingTable->setVals(port, num, initTopo_v, initRoutingTable_v, overTime_v,
-                                  totalStep_v, simMode_v);
+                                  totalStep_v, simMode_v, candidatePathNum_v);
         pathRoutingTable->initiate();
     }
     return pathRoutingTable;
@@ -71,13 +75,16 @@ void RlPathRoutingTable::initiate()
 
     RlBasicRoutingTable::initiate();
     initTopoTable(initTopo, topo);
-    initPathsTable(initRoutingTable);
+    if (candidatePathNum > 0)
+        initCatalog();
+    else
+        initPathsTable(initRoutingTable);
     initCnts();
 }
 
 void RlPathRoutingTable::setVals(int port, int num, const char *initTopo_v,
                                  const char *initRoutingTable_v, double overTime_v, int totalStep_v,
-                                 int returnMode_v)
+                                 int returnMode_v, int candidatePathNum_v)
 {
     zmqPort = port;
     nodeNum = num;
@@ -86,13 +93,14 @@ void RlPathRoutingTable::setVals(int port, int num, const char *initTopo_v,
     overTime = overTime_v;
     totalStep = totalStep_v;
     returnMode = returnMode_v;
+    candidatePathNum = candidatePathNum_v;
 }
 
 void RlPathRoutingTable::initTopoTable(string initTopo, int **topo)
 {
     istringstream iss(initTopo);
     string token;
-    static int edgeCount, row, col = 0;
+    int edgeCount = 0, row = 0, col = 0;
     while (getline(iss, token, ',')) {
         int isConnection = std::stoi(token); // Convert string to integer
         if (isConnection) {
@@ -126,13 +134,46 @@ void RlPathRoutingTable::initPathsTable(string initRoutingTable)
     }
 }
 
+/**
+ * @brief Build the candidate path catalog and export it to the Python side, every OD pair uses its first candidate path until the first action arrives
+ *
+ */
+void RlPathRoutingTable::initCatalog()
+{
+    catalog = new RlPathCatalog(nodeNum, topo);
+    catalog->build(candidatePathNum);
+    pathChoice.assign(nodeNum * nodeNum, 0);
+    // Message format: c@@0@@src,dst,path|path|...;src,dst,path|path|...
+    exchange("c@@0@@" + catalog->toString());
+}
+
+/**
+ * @brief Parse the path indices chosen by the agent
+ *
+ * @param action    Message format: index,index,...; one index for each OD pair in the order of the exported catalog
+ */
+void RlPathRoutingTable::parsePathChoice(string action)
+{
+    stringstream ssBuffer(action);
+    string item;
+    for (int src = 0; src < nodeNum; src++) {
+        for (int dst = 0; dst < nodeNum; dst++) {
+            if (catalog->getPathNum(src, dst) == 0)
+                continue;
+            if (!getline(ssBuffer, item, ','))
+                return;
+            pathChoice[src * nodeNum + dst] = atoi(item.c_str());
+        }
+    }
+}
+
 void RlPathRoutingTable::initCnts()
 {
     delayWithPath.resize(nodeNum);
     for (int i = 0; i < nodeNum; ++i) {
         delayWithPath[i].resize(nodeNum);
         for (int j = 0; j < nodeNum; ++j) {
-            delayWithPath[i][j].resize(totalStep);
+            delayWithPath[i][j].assign(totalStep, make_pair(0.0, 0.0));
         }
     }
 
@@ -145,7 +186,7 @@ void RlPathRoutingTable::initCnts()
     // Initialize each element to 0
     for (int i = 0; i < nodeNum; ++i) {
         for (int j = 0; j < nodeNum; ++j) {
-            packetSendNum[i][j] = vector<int>(totalStep, 0);
+            packetSendNum[i][j] = vector<double>(totalStep, 0);
         }
     }
 }
@@ -168,7 +209,13 @@ pair<string, int> RlPathRoutingTable::getRoute(string path, Packet *packet)
 
     // Direct forwarding from Host to Router
     if (thisNodeName[0] == 'H') {
-        if (paths[pktInfo] != "") {
+        if (catalog) {
+            int pathId = catalog->getPathId(srcNodeId, dstNodeId,
+                                            pathChoice[srcNodeId * nodeNum + dstNodeId]);
+            if (pathId == -1)
+                pathId = catalog->getPathId(srcNodeId, dstNodeId, 0);
+            packet->addPar("pathId").setLongValue(pathId);
+        } else if (paths[pktInfo] != "") {
             packet->addPar("path").setStringValue(paths[pktInfo].c_str());
         } else {
             string pathItem;
@@ -192,7 +239,7 @@ pair<string, int> RlPathRoutingTable::getRoute(string path, Packet *packet)
         if (packetSendNum[srcNodeId][dstNodeId].size() <= step) {
             packetSendNum[srcNodeId][dstNodeId].resize(step + 1); // Initialize to 0
         }
-        packetSendNum[srcNodeId][dstNodeId][step]++;
+        packetSendNum[srcNodeId][dstNodeId][step] += getPacketWeight(packet);
         return p;
     } else if (thisNodeId == dstNodeId) { // Direct forwarding from Router to Host
         p.first = dstNode;
@@ -223,6 +270,9 @@ pair<string, int> RlPathRoutingTable::getRoute(string path, Packet *packet)
  */
 int RlPathRoutingTable::getNextHop(int currentNode, Packet *packet)
 {
+    if (catalog)
+        return catalog->getNextNode(packet->par("pathId").longValue(), currentNode);
+
     string path = packet->par("path").stringValue();
     vector<int> nodes;
     string node;
@@ -280,36 +330,31 @@ void RlPathRoutingTable::updateRoutingTable(int step, double stepTime)
                 else
                     stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime) + ",";
             }
+        recordLinkLoads(step, stepTime);
         clearPkts();
 
-        const char *reqData = stateStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmq_socket->send(request, zmq::send_flags::none);
-
-        zmq::message_t reply;
-        auto res = zmq_socket->recv(reply, zmq::recv_flags::none);
-        char *buffer = new char[reply.size() + 1];
-        memset(buffer, 0, reply.size() + 1);
-        memcpy(buffer, reply.data(), reply.size());
-
-        // Message format: src,dst,path;src,dst,path;...
-        paths.clear();
-        string pathItem;
-        stringstream ssBuffer(buffer);
-        while (getline(ssBuffer, pathItem, ';')) {
-            vector<string> items;
-            stringstream ssItem(pathItem);
-            string item;
-            while (getline(ssItem, item, ',')) {
-                items.push_back(item);
+        string replyStr = exchange(stateStr);
+
+        if (catalog) {
+            // Message format: index,index,...
+            parsePathChoice(replyStr);
+        } else {
+            // Message format: src,dst,path;src,dst,path;...
+            paths.clear();
+            string pathItem;
+            stringstream ssBuffer(replyStr);
+            while (getline(ssBuffer, pathItem, ';')) {
+                vector<string> items;
+                stringstream ssItem(pathItem);
+                string item;
+                while (getline(ssItem, item, ',')) {
+                    items.push_back(item);
+                }
+                paths[make_pair(atoi(items[0].c_str()), atoi(items[1].c_str()))] = items[2];
             }
-            paths[make_pair(atoi(items[0].c_str()), atoi(items[1].c_str()))] = items[2];
         }
 
         sendId = 0; // Reset packet ID for the next step
-        delete buffer;
     }
 }
 
@@ -319,68 +364,143 @@ void RlPathRoutingTable::countPktDelay(Packet *packet, double delay)
     string dstNode = packet->par("dst").stringValue();
     int srcNodeId = atoi(srcNode.c_str() + 2);
     int dstNodeId = atoi(dstNode.c_str() + 2);
-    int pktId = packet->par("id").longValue();
     int step = packet->par("step").longValue();
-    // If delayWithStep[step] is empty, initialize delayWithStep[step] with the current delay as the first element
-    if (delayWithStep.size() < (step + 1)) {
-        vector<double> delayVec;
-        delayVec.push_back(delay);
-        delayWithStep.push_back(delayVec);
+    int weight = getPacketWeight(packet);
+    pkArrivedOfStep[step] += weight;
+    delaySumOfStep[step] += delay * weight;
+    if (returnMode == 1) {
+        delayWithPath[srcNodeId][dstNodeId][step].first += delay * weight;
+        delayWithPath[srcNodeId][dstNodeId][step].second += weight;
+    }
+}
+
+/**
+ * @brief Parse a path of the agent into its nodes
+ *
+ * @param path          Path in the format node.node.node
+ * @return vector<int>  Node sequence
+ */
+vector<int> RlPathRoutingTable::parsePathNodes(const string &path)
+{
+    vector<int> nodes;
+    string node;
+    stringstream ss(path);
+    while (getline(ss, node, '.')) {
+        nodes.push_back(atoi(node.c_str()));
     }
-    // If delayWithStep[step] already has values, insert directly
-    else {
-        delayWithStep[step].push_back(delay);
+    return nodes;
+}
+
+/**
+ * @brief Find the initial path of an OD pair, used until the agent gives one
+ *
+ * @param srcNode   Source node
+ * @param dstNode   Destination node
+ * @return string   Path in the format node.node.node, empty if there is none
+ */
+string RlPathRoutingTable::findInitPath(int srcNode, int dstNode)
+{
+    string pathItem;
+    stringstream ssBuffer(initRoutingTable);
+    while (getline(ssBuffer, pathItem, ';')) {
+        vector<string> items;
+        stringstream ssItem(pathItem);
+        string item;
+        while (getline(ssItem, item, ',')) {
+            items.push_back(item);
+        }
+        if (items.size() > 2 && atoi(items[0].c_str()) == srcNode
+            && atoi(items[1].c_str()) == dstNode)
+            return items[2];
     }
+    return "";
+}
+
+/**
+ * @brief Get the path of an OD pair for the fluid model, chosen in the same way as for the packets in getRoute
+ *
+ * @param srcNode       Source node
+ * @param dstNode       Destination node
+ * @param flowNum       Number of flows of the OD pair
+ * @param fluidPaths    The single path of the pair with all its traffic
+ */
+void RlPathRoutingTable::getFluidPaths(int srcNode, int dstNode, int flowNum,
+                                       vector<pair<vector<int>, double>> &fluidPaths)
+{
+    fluidPaths.clear();
+    if (catalog) {
+        int pathId =
+            catalog->getPathId(srcNode, dstNode, pathChoice[srcNode * nodeNum + dstNode]);
+        if (pathId == -1)
+            pathId = catalog->getPathId(srcNode, dstNode, 0);
+        if (pathId != -1)
+            fluidPaths.push_back(make_pair(catalog->getPath(pathId), 1.0));
+        return;
+    }
+    auto it = paths.find(make_pair(srcNode, dstNode));
+    string path = (it != paths.end() && it->second != "") ? it->second
+                                                          : findInitPath(srcNode, dstNode);
+    // An OD pair without path keeps an empty path, so its traffic is lost instead of being routed hop by hop
+    fluidPaths.push_back(make_pair(parsePathNodes(path), 1.0));
+}
+
+/**
+ * @brief Count the packets of an OD pair solved by the fluid model, per OD pair in distributed mode
+ *
+ * @param step      Step number
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @param sent      Packets sent by the pair during the step
+ * @param arrived   Packets of the pair received
+ * @param delay     Mean delay of the received packets
+ * @param nodePass  Packets of the pair passing through each router
+ */
+void RlPathRoutingTable::countFluidDemand(int step, int srcNode, int dstNode, double sent,
+                                          double arrived, double delay,
+                                          const vector<double> &nodePass)
+{
+    countFluidPackets(step, sent, arrived, delay);
     if (returnMode == 1) {
-        delayWithPath[srcNodeId][dstNodeId][step].push_back(delay);
+        packetSendNum[srcNode][dstNode][step] += sent;
+        delayWithPath[srcNode][dstNode][step].first += delay * arrived;
+        delayWithPath[srcNode][dstNode][step].second += arrived;
     }
 }
 
 void RlPathRoutingTable::endStep(int step)
 {
     string reqStr = "r@@" + to_string(step) + "@@";
+    vector<double> odDelays, odLosses;
     if (returnMode == 1) {
         for (int src = 0; src < nodeNum; src++) {
             for (int dst = 0; dst < nodeNum; dst++) {
                 double delay = 0.0, loss_rate = 0.0;
                 if (src != dst) {
-                    if (!(delayWithPath[src][dst][step].empty())) {
-                        for (int i = 0; i < delayWithPath[src][dst][step].size(); i++) {
-                            delay += delayWithPath[src][dst][step][i];
-                        }
-                        delay /= delayWithPath[src][dst][step].size();
+                    pair<double, double> &arrived = delayWithPath[src][dst][step];
+                    if (arrived.second) {
+                        delay = arrived.first / arrived.second;
                         loss_rate =
-                            1.0
-                            - delayWithPath[src][dst][step].size() / packetSendNum[src][dst][step];
+                            1.0 - (double)arrived.second / packetSendNum[src][dst][step];
                     } else {
                         loss_rate = 1.0;
                     }
                 }
                 reqStr += to_string(delay) + "," + to_string(loss_rate) + "/";
+                odDelays.push_back(delay);
+                odLosses.push_back(loss_rate);
             }
         }
     }
     double globalAvgDelay = 0.0;
-    if (delayWithStep[step].size()) {
-        for (int i = 0; i < delayWithStep[step].size(); i++) {
-            globalAvgDelay += delayWithStep[step][i];
-        }
-
-        globalAvgDelay /= delayWithStep[step].size();
-    }
+    if (pkArrivedOfStep[step])
+        globalAvgDelay = delaySumOfStep[step] / pkArrivedOfStep[step];
     double globalLossRate = 1.0;
     if (pkNumOfStep[step] != 0)
-        globalLossRate -= (double)(delayWithStep[step].size()) / (double)(pkNumOfStep[step]);
+        globalLossRate -= (double)(pkArrivedOfStep[step]) / (double)(pkNumOfStep[step]);
     // The final data is global information
     reqStr += to_string(globalAvgDelay) + "," + to_string(globalLossRate);
-    cout << reqStr << endl;
-    const char *reqData = reqStr.c_str();
-    const size_t reqLen = strlen(reqData);
-    zmq::message_t request{reqLen};
-    memcpy(request.data(), reqData, reqLen);
-    zmq_socket->send(request, zmq::send_flags::none);
-    zmq::message_t reply;
-    auto res = zmq_socket->recv(reply, zmq::recv_flags::none);
+    exchange(reqStr);
+    recordReward(step, globalAvgDelay, globalLossRate, odDelays, odLosses);
 
     stepFinished[step] = true;
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #ifndef RLPATHROUTINGTABLE_H
 #define RLPATHROUTINGTABLE_H
 #include "RlBasicRoutingTable.h"
+#include "RlPathCatalog.h"
 
 struct pair_hash_in_path {
     template <class T1, class T2>
@@ -29,24 +30,39 @@ public:
     static RlPathRoutingTable *getInstance();
     static RlPathRoutingTable *initTable(int num, const char *initTopo_v,
                                          const char *initRoutingTable_v, int port,
-                                         double overTime_v, int totalStep_v, int simMode_v);
+                                         double overTime_v, int totalStep_v, int simMode_v,
+                                         int candidatePathNum_v = 0);
     void initiate() override;
     void setVals(int port, int num, const char *initTopo_v, const char *initRoutingTable_v,
-                 double overTime_v, int totalStep_v, int returnMode_v);
+                 double overTime_v, int totalStep_v, int returnMode_v, int candidatePathNum_v = 0);
     void updateRoutingTable(int step, double stepTime) override;
     pair<string, int> getRoute(string path, Packet *packet) override;
     int getNextHop(int nodeId, Packet *packet);
     void initTopoTable(string initTopo, int **topo);
     void initPathsTable(string initRoutingTable);
     void initCnts();
+    void initCatalog();
+    void parsePathChoice(string action);
     void countPktDelay(Packet *packet, double delay) override;
     void endStep(int step) override;
+    void getFluidPaths(int srcNode, int dstNode, int flowNum,
+                       vector<pair<vector<int>, double>> &fluidPaths) override;
+    void countFluidDemand(int step, int srcNode, int dstNode, double sent, double arrived,
+                          double delay, const vector<double> &nodePass) override;
 
 protected:
+    static vector<int> parsePathNodes(const string &path);
+    string findInitPath(int srcNode, int dstNode);
+
     string initTopo = "";
     unordered_map<pair<int, int>, string, pair_hash_in_path> paths;
-    vector<vector<vector<vector<double>>>> delayWithPath;
-    vector<vector<vector<int>>> packetSendNum;
+    vector<vector<vector<pair<double, double>>>>
+        delayWithPath; // (sum of the delays, number of received packets) of each OD pair and step, weighted for packet trains,
+                       // fractional in fluid mode
+    vector<vector<vector<double>>> packetSendNum; // Packets sent by each OD pair in each step, fractional in fluid mode
+    int candidatePathNum = 0;         // Candidate paths of each OD pair, 0 for paths given by the agent.
+    RlPathCatalog *catalog = nullptr; // Candidate path catalog, only built when candidatePathNum > 0.
+    vector<int> pathChoice;           // Index of the chosen candidate path of each OD pair.
 
 private:
     static RlPathRoutingTable *pathRoutingTable;
@@ -115,7 +115,7 @@ void RlProbabilisticRoutingTable::initTopoTable(string initRoutingTable, int **t
 {
     std::istringstream iss(initRoutingTable.substr(1, initRoutingTable.size() - 2));
     std::string token;
-    static int edgeCount, row, col = 0;
+    int edgeCount = 0, row = 0, col = 0;
     while (std::getline(iss, token, ',')) {
         int isConnection = std::stoi(token); // Convert string to integer
         if (isConnection) {
@@ -171,6 +171,32 @@ int RlProbabilisticRoutingTable::getNextNode(int nodeId, int srcNode, int dstNod
     }
 }
 
+/**
+ * @brief Get the share of the traffic sent to each next node, the probabilities of the roulette wheel of getNextNode
+ *
+ * @param nodeId    ID of the current node
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @param split     (next node, share) of the traffic
+ */
+void RlProbabilisticRoutingTable::getSplitRatios(int nodeId, int srcNode, int dstNode,
+                                                 vector<pair<int, double>> &split)
+{
+    split.clear();
+    if (allProb[nodeId][dstNode]) {
+        split.push_back(make_pair(dstNode, 1.0));
+        return;
+    }
+    float probSum = 0.0;
+    for (int i = 0; i < nodeNum; i++)
+        probSum += allProb[nodeId][i];
+    if (probSum <= 0)
+        return;
+    for (int i = 0; i < nodeNum; i++)
+        if (allProb[nodeId][i] > 0)
+            split.push_back(make_pair(i, allProb[nodeId][i] / probSum));
+}
+
 /**
  * @brief Called after all packets of the current step have been sent, communicates with the ZMQ server (Python side), transfers the current step's throughput, obtains the weights of nodes for the next step, calculates the corresponding forwarding probabilities, and clears the already collected throughput data
  *
@@ -190,19 +216,11 @@ void RlProbabilisticRoutingTable::updateRoutingTable(int step, double stepTime)
                 else
                     stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime) + ",";
             }
+        recordLinkLoads(step, stepTime);
         clearPkts();
-        cout << stateStr << endl;
-        const char *reqData = stateStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmq_socket->send(request, zmq::send_flags::none);
-
-        zmq::message_t reply;
-        auto res = zmq_socket->recv(reply, zmq::recv_flags::none);
-        char *buffer = new char[reply.size() + 1];
-        memset(buffer, 0, reply.size() + 1);
-        memcpy(buffer, reply.data(), reply.size());
+        string replyStr = exchange(stateStr);
+        char *buffer = new char[replyStr.size() + 1];
+        memcpy(buffer, replyStr.c_str(), replyStr.size() + 1);
         // The received data contains (edgeNum * 2) weights, assembled into a probability table in the inet side
         char *od_prob;
         double *weights = new double[edgeNum * 2];
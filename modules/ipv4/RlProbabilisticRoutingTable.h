@@ -40,6 +40,8 @@ public:
 
     void updateRoutingTable(int step, double stepTime) override;
     int getNextNode(int nodeId, int srcNode, int dstNode) override;
+    void getSplitRatios(int nodeId, int srcNode, int dstNode,
+                        vector<pair<int, double>> &split) override;
     void initProbTable(string initRoutingTable, float **Prob);
     void initTopoTable(string initRoutingTable, int **topo);
 
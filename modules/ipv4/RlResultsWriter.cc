@@ -0,0 +1,278 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 22:14:36
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 22:14:36
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlResultsWriter.cc
+ * @Description  : Columnar file of the per-step results of RouterRL, read by utils/results_file.py.
+ */
+#include "RlResultsWriter.h"
+#include "RlLogger.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <omnetpp.h>
+#include <pthread.h>
+
+using namespace omnetpp;
+
+RlResultsWriter *RlResultsWriter::resultsWriter = NULL;
+
+/**
+ * @brief Initialize the results writer, only the first call creates it
+ *
+ * @param file_v        Results file
+ * @param groupSteps_v  Rows of a row group
+ * @param nodeNum_v     Number of nodes
+ * @param topo          Topology of the routing table, -1 for no link, read at the first state or reward
+ * @param statScope_v   Delay and loss columns besides the global ones, RESULTS_GLOBAL, RESULTS_NODE or RESULTS_OD
+ * @return RlResultsWriter* Results writer
+ */
+RlResultsWriter *RlResultsWriter::initWriter(string file_v, int groupSteps_v, int nodeNum_v, int **topo,
+                                             int statScope_v)
+{
+    if (!resultsWriter) {
+        if (groupSteps_v <= 0)
+            throw cRuntimeError("Invalid resultsGroupSteps %d, it must be > 0", groupSteps_v);
+        pthread_atfork(&RlResultsWriter::beforeFork, NULL, NULL);
+        atexit(&RlResultsWriter::atExit);
+        resultsWriter = new RlResultsWriter(file_v, groupSteps_v, nodeNum_v, topo, statScope_v);
+    }
+    return resultsWriter;
+}
+
+RlResultsWriter::RlResultsWriter(string file_v, int groupSteps_v, int nodeNum_v, int **topo_v, int statScope_v)
+    : file(file_v), groupSteps(groupSteps_v), nodeNum(nodeNum_v), statScope(statScope_v), topo(topo_v)
+{
+    if (statScope == RESULTS_NODE)
+        statWidth = nodeNum;
+    else if (statScope == RESULTS_OD)
+        statWidth = nodeNum * nodeNum;
+    openFile(file.getPath());
+}
+
+void RlResultsWriter::addColumn(vector<RlResultsColumn> &columns, const char *name, const char *type, uint32_t width)
+{
+    RlResultsColumn column = {};
+    strncpy(column.name, name, sizeof(column.name) - 1);
+    memcpy(column.type, type, 3);
+    column.width = width;
+    columns.push_back(column);
+}
+
+/**
+ * @brief Open a results file, with its header if the links are already known
+ *
+ * @param path  Results file
+ */
+void RlResultsWriter::openFile(const string &path)
+{
+    output.open(path, ios::out | ios::trunc | ios::binary);
+    if (!output)
+        throw cRuntimeError("Cannot write the results file '%s'", path.c_str());
+    file.setOpened();
+    if (headerWritten)
+        writeHeader();
+}
+
+/**
+ * @brief Read the links of the topology, then write the header, the columns and the links
+ *
+ */
+void RlResultsWriter::writeHeader()
+{
+    links.clear();
+    for (int i = 0; i < nodeNum; i++)
+        for (int j = 0; j < nodeNum; j++)
+            if (topo[i][j] != -1)
+                links.push_back(make_pair(i, j));
+
+    // Same order as writeGroup
+    vector<RlResultsColumn> columns;
+    addColumn(columns, "delay", "<f8", 1);
+    addColumn(columns, "loss", "<f8", 1);
+    addColumn(columns, "action_hash", "<u8", 1);
+    addColumn(columns, "step", "<i4", 1);
+    addColumn(columns, "link_load", "<f4", links.size());
+    if (statScope == RESULTS_NODE) {
+        addColumn(columns, "node_delay", "<f4", statWidth);
+        addColumn(columns, "node_loss", "<f4", statWidth);
+    } else if (statScope == RESULTS_OD) {
+        addColumn(columns, "od_delay", "<f4", statWidth);
+        addColumn(columns, "od_loss", "<f4", statWidth);
+    }
+
+    RlResultsHeader header = {RL_RESULTS_MAGIC, RL_RESULTS_VERSION, (uint32_t)nodeNum, (uint32_t)links.size(),
+                              (uint32_t)groupSteps, (uint32_t)columns.size()};
+    output.write((const char *)&header, sizeof(header));
+    output.write((const char *)columns.data(), columns.size() * sizeof(RlResultsColumn));
+    for (auto &link : links) {
+        uint16_t ends[2] = {link.first, link.second};
+        output.write((const char *)ends, sizeof(ends));
+    }
+    pad();
+    output.flush();
+    headerWritten = true;
+}
+
+void RlResultsWriter::pad()
+{
+    static const char zeros[8] = {0};
+    long position = output.tellp();
+    if (position % 8)
+        output.write(zeros, 8 - position % 8);
+}
+
+/**
+ * @brief Keep the link loads of a step until its reward, called by updateRoutingTable before the loads are cleared
+ *
+ * @param step      Step of the state
+ * @param pkct      Bits sent on each link during the step
+ * @param stepTime  Duration of the step
+ */
+void RlResultsWriter::recordState(int step, int **pkct, double stepTime)
+{
+    if (file.isStale())
+        reopen();
+    if (!headerWritten)
+        writeHeader();
+    StepState &state = states[step];
+    state.linkLoad.resize(links.size());
+    for (size_t i = 0; i < links.size(); i++)
+        state.linkLoad[i] = (float)(double(pkct[links[i].first][links[i].second]) / 1000 / 1000 / stepTime);
+}
+
+/**
+ * @brief Keep the hash of the action applied after the state of a step
+ *
+ * @param step      Step of the state
+ * @param action    Reply of the agent to the state
+ */
+void RlResultsWriter::recordAction(int step, const string &action)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : action) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    states[step].actionHash = hash;
+}
+
+/**
+ * @brief Complete the row of a step with its reward, and write the row group once it is full
+ *
+ * @param step      Step of the reward
+ * @param delay     Global average delay
+ * @param loss      Global loss rate
+ * @param delays    Average delay of each node or OD pair of the scope, empty for RESULTS_GLOBAL
+ * @param losses    Loss rate of each node or OD pair of the scope, empty for RESULTS_GLOBAL
+ */
+void RlResultsWriter::recordReward(int step, double delay, double loss, const vector<double> &delays,
+                                   const vector<double> &losses)
+{
+    if (file.isStale())
+        reopen();
+    if (!headerWritten)
+        writeHeader();
+    stepColumn.push_back(step);
+    delayColumn.push_back(delay);
+    lossColumn.push_back(loss);
+
+    auto state = states.find(step);
+    if (state != states.end() && state->second.linkLoad.size() == links.size()) {
+        linkLoadColumn.insert(linkLoadColumn.end(), state->second.linkLoad.begin(), state->second.linkLoad.end());
+        actionColumn.push_back(state->second.actionHash);
+    } else {
+        linkLoadColumn.insert(linkLoadColumn.end(), links.size(), NAN);
+        actionColumn.push_back(state != states.end() ? state->second.actionHash : 0);
+    }
+    if (state != states.end())
+        states.erase(state);
+
+    for (int i = 0; i < statWidth; i++) {
+        statDelayColumn.push_back(i < (int)delays.size() ? (float)delays[i] : NAN);
+        statLossColumn.push_back(i < (int)losses.size() ? (float)losses[i] : NAN);
+    }
+
+    if ((int)stepColumn.size() >= groupSteps)
+        writeGroup();
+}
+
+template <typename T> void RlResultsWriter::writeColumn(const vector<T> &values)
+{
+    output.write((const char *)values.data(), values.size() * sizeof(T));
+}
+
+/**
+ * @brief Write the buffered rows as a row group, nothing if there is none
+ *
+ */
+void RlResultsWriter::writeGroup()
+{
+    if (stepColumn.empty())
+        return;
+    RlResultsGroup group = {(uint32_t)stepColumn.size(), 0};
+    output.write((const char *)&group, sizeof(group));
+    writeColumn(delayColumn);
+    writeColumn(lossColumn);
+    writeColumn(actionColumn);
+    writeColumn(stepColumn);
+    writeColumn(linkLoadColumn);
+    if (statWidth) {
+        writeColumn(statDelayColumn);
+        writeColumn(statLossColumn);
+    }
+    pad();
+    output.flush();
+
+    delayColumn.clear();
+    lossColumn.clear();
+    actionColumn.clear();
+    stepColumn.clear();
+    linkLoadColumn.clear();
+    statDelayColumn.clear();
+    statLossColumn.clear();
+}
+
+/**
+ * @brief Write the rows of the parent before a fork, so that they are only in its file
+ *
+ */
+void RlResultsWriter::beforeFork()
+{
+    if (resultsWriter)
+        resultsWriter->writeGroup();
+}
+
+/**
+ * @brief Continue the results of a child process created by fork() in its own file. The states of the steps not
+ * rewarded yet are kept, their rows are written by the child
+ *
+ */
+void RlResultsWriter::reopen()
+{
+    output.close();
+    openFile(file.getPath());
+}
+
+/**
+ * @brief Write the last, partial row group at the exit of the process, after the header if no step was recorded
+ *
+ */
+void RlResultsWriter::atExit()
+{
+    if (!resultsWriter)
+        return;
+    if (resultsWriter->file.isStale()) {
+        // Nothing can be thrown at the exit of the process
+        try {
+            resultsWriter->reopen();
+        } catch (cRuntimeError &e) {
+            RlLogger::logAtExit(LOG_ERROR, e.what());
+            return;
+        }
+    }
+    if (!resultsWriter->headerWritten)
+        resultsWriter->writeHeader();
+    resultsWriter->writeGroup();
+}
@@ -0,0 +1,126 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 22:14:36
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 22:14:36
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlResultsWriter.h
+ * @Description  : Columnar file of the per-step results of RouterRL, read by utils/results_file.py.
+ */
+#ifndef RLRESULTSWRITER_H
+#define RLRESULTSWRITER_H
+#include "RlForkedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define RL_RESULTS_MAGIC   0x53524c52 // "RLRS"
+#define RL_RESULTS_VERSION 1
+
+#define RESULTS_GLOBAL 0 // Global delay and loss only, the global return mode
+#define RESULTS_NODE   1 // Delay and loss of the packets through each router, the distributed return mode
+#define RESULTS_OD     2 // Delay and loss of each OD pair, the distributed return mode of the path tables
+
+/**
+ * Results file layout (little-endian):
+ *   RlResultsHeader                    magic, version, nodeNum, linkNum, groupSteps, columnNum
+ *   RlResultsColumn columns[columnNum] name, numpy type and values per row of each column
+ *   uint16_t links[linkNum][2]         source and destination router of each directed link, padded to 8 bytes
+ *   row groups                         RlResultsGroup, then the values of each column for all rows of the group,
+ *                                      column after column, padded to 8 bytes
+ * The columns are step, delay, loss, action_hash (FNV-1a of the action of the agent), link_load (Mbits/s of each link
+ * during the step, as in the state) and, depending on the return mode, node_delay and node_loss or od_delay and
+ * od_loss (row-major OD matrix). Columns of 8-byte values come first, so that every column is aligned in the file.
+ */
+struct RlResultsHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeNum;
+    uint32_t linkNum;
+    uint32_t groupSteps;
+    uint32_t columnNum;
+};
+
+struct RlResultsColumn {
+    char name[20];
+    char type[4]; // numpy type string, e.g. "<f8"
+    uint32_t width;
+    uint32_t reserved;
+};
+
+struct RlResultsGroup {
+    uint32_t rowNum;
+    uint32_t reserved;
+};
+
+/**
+ * Rows are buffered in memory and written as a row group every groupSteps rewards, so that the memory of the writer is
+ * bounded by one row group and the states of the steps not rewarded yet. The header is written at the first state or
+ * reward, once the routing table knows its links, e.g. the links of the convention mode registered by the
+ * configurator. The link loads and the action of a step are kept from its state until its reward, which completes the
+ * row. Rows are in the order of the rewards. A row group is only complete once its last column is written, readers
+ * stop at the first incomplete one.
+ * There is only a single global static object, and none when the results file is off. A child process created by
+ * fork() writes its own results file, see RlForkedFile. The rows of the parent until the fork stay in its file.
+ */
+class RlResultsWriter
+{
+public:
+    static RlResultsWriter *getInstance() { return resultsWriter; }
+
+    /**
+     * Used to initialize the unique static instance, opens the results file.
+     */
+    static RlResultsWriter *initWriter(string file_v, int groupSteps_v, int nodeNum_v, int **topo, int statScope_v);
+
+    void recordState(int step, int **pkct, double stepTime);
+    void recordAction(int step, const string &action);
+    void recordReward(int step, double delay, double loss, const vector<double> &delays,
+                      const vector<double> &losses);
+    void writeGroup();
+
+protected:
+    RlResultsWriter(string file_v, int groupSteps_v, int nodeNum_v, int **topo, int statScope_v);
+    static void beforeFork();
+    static void atExit();
+    void openFile(const string &path);
+    void reopen();
+    void writeHeader();
+    void addColumn(vector<RlResultsColumn> &columns, const char *name, const char *type, uint32_t width);
+    template <typename T> void writeColumn(const vector<T> &values);
+    void pad();
+
+    // Link loads and action of a step between its state and its reward
+    struct StepState {
+        vector<float> linkLoad;
+        uint64_t actionHash = 0;
+    };
+
+    RlForkedFile file;
+    ofstream output;
+    int groupSteps;
+    int nodeNum;
+    int statScope;
+    int statWidth = 0;                      // Values per row of the delay and loss columns of the scope
+    int **topo;                             // Topology of the routing table, read when the header is written
+    bool headerWritten = false;
+    vector<pair<uint16_t, uint16_t>> links; // Directed links, in the row-major order of the adjacency matrix
+    unordered_map<int, StepState> states;   // States of the steps not rewarded yet
+
+    // Columns of the current row group
+    vector<double> delayColumn;
+    vector<double> lossColumn;
+    vector<uint64_t> actionColumn;
+    vector<int32_t> stepColumn;
+    vector<float> linkLoadColumn;
+    vector<float> statDelayColumn;
+    vector<float> statLossColumn;
+
+private:
+    static RlResultsWriter *resultsWriter;
+};
+
+#endif // RLRESULTSWRITER_H
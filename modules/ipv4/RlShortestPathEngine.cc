@@ -0,0 +1,319 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 11:20:42
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 13:16:50
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlShortestPathEngine.cc
+ * @Description  : All-pairs weighted shortest path computation in RouterRL.
+ */
+#include "RlShortestPathEngine.h"
+#include "RlThreadPool.h"
+#include <functional>
+#include <limits>
+#include <queue>
+
+typedef priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>>
+    DistHeap;
+
+static const double INF_DIST = numeric_limits<double>::infinity();
+
+RlShortestPathEngine::RlShortestPathEngine(int nodeNum, int **topo) : nodeNum(nodeNum)
+{
+    for (int i = 0; i < nodeNum; i++) {
+        for (int j = 0; j < nodeNum; j++) {
+            if (topo[i][j] >= edgeNum)
+                edgeNum = topo[i][j] + 1;
+        }
+    }
+    edgeFrom.assign(edgeNum, -1);
+    edgeTo.assign(edgeNum, -1);
+
+    outOffset.assign(nodeNum + 1, 0);
+    for (int i = 0; i < nodeNum; i++) {
+        outOffset[i] = outNode.size();
+        for (int j = 0; j < nodeNum; j++) {
+            if (topo[i][j] != -1) {
+                outNode.push_back(j);
+                outEdge.push_back(topo[i][j]);
+                edgeFrom[topo[i][j]] = i;
+                edgeTo[topo[i][j]] = j;
+            }
+        }
+    }
+    outOffset[nodeNum] = outNode.size();
+
+    inOffset.assign(nodeNum + 1, 0);
+    for (int j = 0; j < nodeNum; j++) {
+        inOffset[j] = inNode.size();
+        for (int i = 0; i < nodeNum; i++) {
+            if (topo[i][j] != -1) {
+                inNode.push_back(i);
+                inEdge.push_back(topo[i][j]);
+            }
+        }
+    }
+    inOffset[nodeNum] = inNode.size();
+
+    curWeights.assign(edgeNum, 1.0);
+    nextTo.assign(nodeNum * nodeNum, -1);
+    distTo.assign(nodeNum * nodeNum, INF_DIST);
+}
+
+/**
+ * @brief Recompute the shortest path trees of all destinations
+ *
+ * @param weights   Weight of each directed link, indexed by the link number in topo
+ */
+void RlShortestPathEngine::compute(const vector<double> &weights)
+{
+    curWeights = weights;
+    vector<vector<pair<int, int>>> changedByDst(nodeNum);
+    RlThreadPool::getInstance()->parallelFor(
+        nodeNum, [&](int dst) { computeDestination(dst, changedByDst[dst]); });
+    collectChanges(changedByDst);
+    computed = true;
+}
+
+/**
+ * @brief Apply new link weights and repair the shortest path trees affected by them
+ *
+ * @param weights   Weight of each directed link, indexed by the link number in topo
+ * @return int      Number of destinations whose tree was touched
+ */
+int RlShortestPathEngine::update(const vector<double> &weights)
+{
+    if (!computed) {
+        compute(weights);
+        return nodeNum;
+    }
+
+    vector<EdgeChange> changes;
+    for (int e = 0; e < edgeNum; e++) {
+        if (weights[e] != curWeights[e] && edgeFrom[e] != -1)
+            changes.push_back({edgeFrom[e], edgeTo[e], curWeights[e], weights[e]});
+    }
+    if (changes.empty()) {
+        changedNextHops.clear();
+        return 0;
+    }
+    if (changes.size() > fullRecomputeRatio * edgeNum) {
+        compute(weights);
+        return nodeNum;
+    }
+
+    curWeights = weights;
+    vector<vector<pair<int, int>>> changedByDst(nodeNum);
+    vector<char> touched(nodeNum, 0);
+    RlThreadPool::getInstance()->parallelFor(nodeNum, [&](int dst) {
+        touched[dst] = repairDestination(dst, changes, changedByDst[dst]);
+    });
+    collectChanges(changedByDst);
+
+    int touchedNum = 0;
+    for (int dst = 0; dst < nodeNum; dst++) {
+        touchedNum += touched[dst];
+    }
+    return touchedNum;
+}
+
+/**
+ * @brief Next hop of a node towards a destination under the current distances, ties go to the smallest neighbor ID
+ *
+ * @param dst   Destination node
+ * @param node  Current node
+ * @return int  Next hop node, -1 if the destination is unreachable
+ */
+int RlShortestPathEngine::chooseNextHop(int dst, int node) const
+{
+    const double *dist = &distTo[dst * nodeNum];
+    int best = -1;
+    double bestDist = INF_DIST;
+    // Out links are sorted by neighbor ID, so the first minimum wins the tie
+    for (int k = outOffset[node]; k < outOffset[node + 1]; k++) {
+        double d = dist[outNode[k]] + curWeights[outEdge[k]];
+        if (d < bestDist) {
+            bestDist = d;
+            best = outNode[k];
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Reverse Dijkstra from a destination, fills the tree of the destination
+ *
+ * @param dst       Destination node
+ * @param changed   Nodes whose next hop changed are appended here
+ */
+void RlShortestPathEngine::computeDestination(int dst, vector<pair<int, int>> &changed)
+{
+    double *dist = &distTo[dst * nodeNum];
+    int *next = &nextTo[dst * nodeNum];
+    for (int i = 0; i < nodeNum; i++) {
+        dist[i] = INF_DIST;
+    }
+
+    DistHeap heap;
+    dist[dst] = 0;
+    heap.push(make_pair(0.0, dst));
+    while (!heap.empty()) {
+        double nodeDist = heap.top().first;
+        int node = heap.top().second;
+        heap.pop();
+        if (nodeDist > dist[node])
+            continue;
+        for (int k = inOffset[node]; k < inOffset[node + 1]; k++) {
+            double prevDist = nodeDist + curWeights[inEdge[k]];
+            if (prevDist < dist[inNode[k]]) {
+                dist[inNode[k]] = prevDist;
+                heap.push(make_pair(prevDist, inNode[k]));
+            }
+        }
+    }
+
+    for (int i = 0; i < nodeNum; i++) {
+        int nextHop = (i == dst) ? -1 : chooseNextHop(dst, i);
+        if (nextHop != next[i]) {
+            next[i] = nextHop;
+            changed.push_back(make_pair(i, dst));
+        }
+    }
+}
+
+/**
+ * @brief Repair the tree of a destination after some link weights changed
+ *
+ * @param dst       Destination node
+ * @param changes   Changed links with their old and new weights, curWeights already holds the new ones
+ * @param changed   Nodes whose next hop changed are appended here
+ * @return bool     Whether the tree was affected by the changes
+ */
+bool RlShortestPathEngine::repairDestination(int dst, const vector<EdgeChange> &changes,
+                                             vector<pair<int, int>> &changed)
+{
+    double *dist = &distTo[dst * nodeNum];
+    int *next = &nextTo[dst * nodeNum];
+
+    // Only heavier tree links and lighter links that beat (or tie with a smaller ID) the current next hop matter
+    bool affected = false;
+    for (auto &change : changes) {
+        if (change.newWeight > change.oldWeight && next[change.from] == change.to) {
+            affected = true;
+        } else if (change.newWeight < change.oldWeight) {
+            double d = dist[change.to] + change.newWeight;
+            if (d < dist[change.from] || (d == dist[change.from] && change.to < next[change.from]))
+                affected = true;
+        }
+        if (affected)
+            break;
+    }
+    if (!affected)
+        return false;
+
+    vector<char> inSubtree(nodeNum, 0); // Nodes whose tree path uses a heavier link
+    vector<char> touched(nodeNum, 0);   // Nodes whose distance changed or whose out links changed
+    vector<int> stack;
+
+    // Heavier tree links: collect the subtrees hanging below them before any next hop changes
+    for (auto &change : changes) {
+        if (change.newWeight > change.oldWeight && next[change.from] == change.to
+            && !inSubtree[change.from]) {
+            inSubtree[change.from] = 1;
+            stack.push_back(change.from);
+        }
+    }
+    vector<int> subtree;
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        subtree.push_back(node);
+        for (int k = inOffset[node]; k < inOffset[node + 1]; k++) {
+            int child = inNode[k];
+            if (next[child] == node && !inSubtree[child]) {
+                inSubtree[child] = 1;
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // Subtree nodes restart from the best link leaving the subtree
+    DistHeap heap;
+    for (int node : subtree) {
+        dist[node] = INF_DIST;
+        touched[node] = 1;
+    }
+    for (int node : subtree) {
+        for (int k = outOffset[node]; k < outOffset[node + 1]; k++) {
+            if (inSubtree[outNode[k]])
+                continue;
+            double d = dist[outNode[k]] + curWeights[outEdge[k]];
+            if (d < dist[node])
+                dist[node] = d;
+        }
+        if (dist[node] < INF_DIST)
+            heap.push(make_pair(dist[node], node));
+    }
+
+    // Lighter links lower the distance of their tails
+    for (auto &change : changes) {
+        touched[change.from] = 1;
+        if (change.newWeight < change.oldWeight) {
+            double d = dist[change.to] + change.newWeight;
+            if (d < dist[change.from]) {
+                dist[change.from] = d;
+                heap.push(make_pair(d, change.from));
+            }
+        }
+    }
+
+    // All remaining labels are lengths of existing paths, so settling from the queued nodes gives the exact distances
+    while (!heap.empty()) {
+        double nodeDist = heap.top().first;
+        int node = heap.top().second;
+        heap.pop();
+        if (nodeDist > dist[node])
+            continue;
+        touched[node] = 1;
+        for (int k = inOffset[node]; k < inOffset[node + 1]; k++) {
+            int prev = inNode[k];
+            double prevDist = nodeDist + curWeights[inEdge[k]];
+            if (prevDist < dist[prev]) {
+                dist[prev] = prevDist;
+                heap.push(make_pair(prevDist, prev));
+            }
+        }
+    }
+
+    // Next hops can only change at touched nodes and at the nodes pointing to them
+    vector<char> recheck(touched);
+    for (int node = 0; node < nodeNum; node++) {
+        if (!touched[node])
+            continue;
+        for (int k = inOffset[node]; k < inOffset[node + 1]; k++) {
+            recheck[inNode[k]] = 1;
+        }
+    }
+    for (int node = 0; node < nodeNum; node++) {
+        if (!recheck[node] || node == dst)
+            continue;
+        int nextHop = chooseNextHop(dst, node);
+        if (nextHop != next[node]) {
+            next[node] = nextHop;
+            changed.push_back(make_pair(node, dst));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Merge the next hop changes of all destinations in destination order
+ *
+ * @param changedByDst  Next hop changes of each destination
+ */
+void RlShortestPathEngine::collectChanges(const vector<vector<pair<int, int>>> &changedByDst)
+{
+    changedNextHops.clear();
+    for (auto &changed : changedByDst) {
+        changedNextHops.insert(changedNextHops.end(), changed.begin(), changed.end());
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 11:20:42
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 13:16:50
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlShortestPathEngine.h
+ * @Description  : All-pairs weighted shortest path computation in RouterRL.
+ */
+#ifndef RLSHORTESTPATHENGINE_H
+#define RLSHORTESTPATHENGINE_H
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Computes the next hop of every (node, destination) pair from one weight per directed link, indexed by the link
+ * numbers stored in topo. A shortest path tree is kept for every destination, and the result is kept as a next-hop
+ * matrix so that forwarding is a single lookup.
+ *
+ * When only a few weights change, only the trees affected by them are repaired in the style of Ramalingam-Reps:
+ * subtrees hanging below a heavier tree link are recomputed, and lighter links are propagated from their tail.
+ * Ties are always broken towards the neighbor with the smallest ID, so repaired trees are identical to recomputed ones.
+ * Destinations are processed in parallel on RlThreadPool.
+ */
+class RlShortestPathEngine
+{
+public:
+    RlShortestPathEngine(int nodeNum, int **topo);
+
+    /**
+     * Recomputes all trees from scratch.
+     */
+    void compute(const vector<double> &weights);
+
+    /**
+     * Applies new weights, repairing only the affected trees. Falls back to compute() for the first call and for
+     * large changes. Returns the number of destinations whose tree was touched.
+     */
+    int update(const vector<double> &weights);
+
+    int getNextNode(int nodeId, int dstNode) const { return nextTo[dstNode * nodeNum + nodeId]; }
+    double getDistance(int srcNode, int dstNode) const { return distTo[dstNode * nodeNum + srcNode]; }
+    const vector<double> &getWeights() const { return curWeights; }
+
+    /**
+     * (node, destination) pairs whose next hop changed in the last compute() or update() call.
+     */
+    const vector<pair<int, int>> &getChangedNextHops() const { return changedNextHops; }
+
+    double fullRecomputeRatio = 0.25; // Changed links above this share of all links trigger a full recompute.
+
+protected:
+    struct EdgeChange {
+        int from;
+        int to;
+        double oldWeight;
+        double newWeight;
+    };
+
+    void computeDestination(int dst, vector<pair<int, int>> &changed);
+    bool repairDestination(int dst, const vector<EdgeChange> &changes,
+                           vector<pair<int, int>> &changed);
+    int chooseNextHop(int dst, int node) const;
+    void collectChanges(const vector<vector<pair<int, int>>> &changedByDst);
+
+    int nodeNum;
+    int edgeNum = 0;
+    bool computed = false;
+    vector<int> outOffset, outNode, outEdge; // Out links of node i are out*[outOffset[i] ... outOffset[i + 1]).
+    vector<int> inOffset, inNode, inEdge;    // In links of node i are in*[inOffset[i] ... inOffset[i + 1]).
+    vector<int> edgeFrom, edgeTo;            // End nodes of each link number.
+    vector<double> curWeights;               // Weights the trees are currently built on.
+    vector<int> nextTo;     // Next hop of node i towards dst at nextTo[dst * nodeNum + i], -1 if unreachable.
+    vector<double> distTo;  // Distance from node i to dst at distTo[dst * nodeNum + i].
+    vector<pair<int, int>> changedNextHops;
+};
+
+#endif // RLSHORTESTPATHENGINE_H
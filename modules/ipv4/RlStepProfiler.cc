@@ -0,0 +1,98 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 20:34:52
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 20:34:52
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlStepProfiler.cc
+ * @Description  : Wall-clock breakdown of each step of the simulation in RouterRL.
+ */
+#include "RlStepProfiler.h"
+#include <ctime>
+#include <omnetpp.h>
+
+using namespace omnetpp;
+
+RlStepProfiler *RlStepProfiler::stepProfiler = NULL;
+
+/**
+ * @brief Initialize the profiler, only the first call creates it
+ *
+ * @param file_v    Profile file, one line per step
+ * @return RlStepProfiler* Step profiler
+ */
+RlStepProfiler *RlStepProfiler::initProfiler(string file_v)
+{
+    if (!stepProfiler)
+        stepProfiler = new RlStepProfiler(file_v);
+    return stepProfiler;
+}
+
+RlStepProfiler::RlStepProfiler(string file_v) : file(file_v)
+{
+    openFile(file.getPath());
+    lastSwitch = stepStart = now();
+}
+
+/**
+ * @brief Open a profile file and write its header
+ *
+ * @param path  Profile file
+ */
+void RlStepProfiler::openFile(const string &path)
+{
+    output.open(path, ios::out | ios::trunc);
+    if (!output)
+        throw cRuntimeError("Cannot write the profile file '%s'", path.c_str());
+    file.setOpened();
+    output << "step,wall_s,events,events_s,agent_s,messages_s,lookup_s" << endl;
+}
+
+uint64_t RlStepProfiler::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Charge the time since the last switch to the current category and continue in another one
+ *
+ * @param category  Category of the code that follows
+ * @return int      Previous category, to switch back to
+ */
+int RlStepProfiler::switchTo(int category)
+{
+    uint64_t time = now();
+    spent[current] += time - lastSwitch;
+    lastSwitch = time;
+    int previous = current;
+    current = category;
+    return previous;
+}
+
+/**
+ * @brief Write the breakdown of the time since the previous reward and start a new interval
+ *
+ * @param step      Step of the reward
+ * @param eventNum  Event number of the simulation
+ */
+void RlStepProfiler::endStep(int step, long long eventNum)
+{
+    // Lines are flushed at every step, so the lines of the parent are only in its file
+    if (file.isStale()) {
+        output.close();
+        openFile(file.getPath());
+    }
+    uint64_t time = now();
+    spent[current] += time - lastSwitch;
+    lastSwitch = time;
+    output << step << "," << (time - stepStart) * 1e-9 << "," << eventNum - stepStartEvent;
+    for (int i = 0; i < PROFILE_CATEGORY_NUM; i++) {
+        output << "," << spent[i] * 1e-9;
+        spent[i] = 0;
+    }
+    // Flushed at every step, so that the profile of a stopped run is complete and a fork does not write it twice
+    output << endl;
+    stepStart = time;
+    stepStartEvent = eventNum;
+}
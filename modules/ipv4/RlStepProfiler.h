@@ -0,0 +1,89 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 20:34:52
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 20:34:52
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlStepProfiler.h
+ * @Description  : Wall-clock breakdown of each step of the simulation in RouterRL.
+ */
+#ifndef RLSTEPPROFILER_H
+#define RLSTEPPROFILER_H
+#include "RlForkedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+#define PROFILE_EVENTS   0 // Event processing of OMNeT++ and INET, everything that is not in another category
+#define PROFILE_AGENT    1 // Blocked on the agent, from sending a request to receiving its reply
+#define PROFILE_MESSAGES 2 // Formatting states and rewards and parsing actions in updateRoutingTable and endStep
+#define PROFILE_LOOKUP   3 // Routing table lookups of the IP layer
+#define PROFILE_CATEGORY_NUM 4
+
+/**
+ * Charges the wall time of the simulation to the category the simulation is in: categories are switched around the
+ * code they cover, and nested categories are exclusive, e.g. the agent wait inside endStep is not counted as messages.
+ * The time between two rewards is one line of the profile file:
+ *   step,wall_s,events,events_s,agent_s,messages_s,lookup_s
+ * where step is the step of the reward and events the events processed in the interval.
+ * There is only a single global static object, and none when profiling is off. A child process created by fork()
+ * writes its own profile file, see RlForkedFile.
+ */
+class RlStepProfiler
+{
+public:
+    static RlStepProfiler *getInstance() { return stepProfiler; }
+
+    /**
+     * Used to initialize the unique static instance, opens the profile file and starts charging time to events.
+     */
+    static RlStepProfiler *initProfiler(string file_v);
+
+    // CLOCK_MONOTONIC in ns, read from the vDSO without a system call
+    static uint64_t now();
+    int switchTo(int category);
+    void endStep(int step, long long eventNum);
+
+protected:
+    RlStepProfiler(string file_v);
+    void openFile(const string &path);
+
+    RlForkedFile file;
+    ofstream output;
+    int current = PROFILE_EVENTS;
+    uint64_t lastSwitch = 0;      // Time of the last switch of category, ns
+    uint64_t stepStart = 0;       // Time of the previous reward, ns
+    long long stepStartEvent = 0; // Event number at the previous reward
+    uint64_t spent[PROFILE_CATEGORY_NUM] = {0}; // Time charged to each category since the previous reward, ns
+
+private:
+    static RlStepProfiler *stepProfiler;
+};
+
+/**
+ * Charges the time of a scope to a category, and gives the time back to the previous category at its end. Costs a
+ * pointer test when profiling is off.
+ */
+class RlProfileScope
+{
+public:
+    RlProfileScope(int category) : profiler(RlStepProfiler::getInstance())
+    {
+        if (profiler)
+            previous = profiler->switchTo(category);
+    }
+    ~RlProfileScope()
+    {
+        if (profiler)
+            profiler->switchTo(previous);
+    }
+    RlProfileScope(const RlProfileScope &) = delete;
+    RlProfileScope &operator=(const RlProfileScope &) = delete;
+
+protected:
+    RlStepProfiler *profiler;
+    int previous = PROFILE_EVENTS;
+};
+
+#endif // RLSTEPPROFILER_H
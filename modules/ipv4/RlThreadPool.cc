@@ -0,0 +1,145 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 11:02:15
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 11:02:15
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlThreadPool.cc
+ * @Description  : Thread pool for parallel route computation in RouterRL.
+ */
+#include "RlThreadPool.h"
+#include <pthread.h>
+
+RlThreadPool *RlThreadPool::threadPool = NULL;
+
+/**
+ * @brief Get the unique static instance, one worker for each hardware thread except the calling one
+ *
+ * @return RlThreadPool* Thread pool
+ */
+RlThreadPool *RlThreadPool::getInstance()
+{
+    if (!threadPool) {
+        static bool forkHandled = false;
+        if (!forkHandled) {
+            pthread_atfork(NULL, NULL, &RlThreadPool::afterFork);
+            forkHandled = true;
+        }
+        int hardwareThreads = thread::hardware_concurrency();
+        threadPool = new RlThreadPool(hardwareThreads > 1 ? hardwareThreads - 1 : 0);
+    }
+    return threadPool;
+}
+
+/**
+ * @brief Forget the pool in a child process created by fork(): its workers only exist in the parent and its mutex may
+ * have been copied while held by one of them, so it is leaked rather than destroyed
+ *
+ */
+void RlThreadPool::afterFork()
+{
+    threadPool = NULL;
+}
+
+RlThreadPool::RlThreadPool(int threadNum)
+{
+    for (int i = 0; i < threadNum; i++) {
+        workers.emplace_back(&RlThreadPool::workerLoop, this);
+    }
+}
+
+RlThreadPool::~RlThreadPool()
+{
+    {
+        lock_guard<mutex> lock(poolMutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+int RlThreadPool::getThreadNum() const
+{
+    return workers.size() + 1;
+}
+
+/**
+ * @brief Take tasks of the current parallelFor call until none is left
+ *
+ */
+void RlThreadPool::runTasks()
+{
+    int index;
+    while ((index = nextIndex.fetch_add(1)) < taskNum) {
+        try {
+            (*currentTask)(index);
+        } catch (...) {
+            lock_guard<mutex> lock(poolMutex);
+            if (!firstError)
+                firstError = current_exception();
+        }
+    }
+}
+
+void RlThreadPool::workerLoop()
+{
+    long seenGeneration = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(poolMutex);
+            taskReady.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+        runTasks();
+        {
+            lock_guard<mutex> lock(poolMutex);
+            busyWorkers--;
+        }
+        taskDone.notify_one();
+    }
+}
+
+/**
+ * @brief Run tasks in parallel and wait for all of them
+ *
+ * @param num   Number of tasks
+ * @param task  Task to run, called with the task index
+ */
+void RlThreadPool::parallelFor(int num, const function<void(int)> &task)
+{
+    if (num <= 0)
+        return;
+    // Not worth waking up the workers for a single task
+    if (workers.empty() || num == 1) {
+        for (int i = 0; i < num; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(poolMutex);
+        currentTask = &task;
+        taskNum = num;
+        nextIndex = 0;
+        busyWorkers = workers.size();
+        firstError = nullptr;
+        generation++;
+    }
+    taskReady.notify_all();
+    runTasks();
+
+    exception_ptr error;
+    {
+        unique_lock<mutex> lock(poolMutex);
+        taskDone.wait(lock, [&]() { return busyWorkers == 0; });
+        currentTask = nullptr;
+        error = firstError;
+        firstError = nullptr;
+    }
+    if (error)
+        rethrow_exception(error);
+}
@@ -0,0 +1,63 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 11:02:15
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 11:02:15
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlThreadPool.h
+ * @Description  : Thread pool for parallel route computation in RouterRL.
+ */
+#ifndef RLTHREADPOOL_H
+#define RLTHREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A fixed set of worker threads that live for the whole simulation, so that route computation at every step boundary
+ * does not pay for thread creation. Only used for work outside the OMNeT++ event loop (no EV logging, no module access).
+ * There is only a single global static object, created on first use. A child process created by fork() starts its own
+ * workers on first use, since the threads of the parent are not copied.
+ */
+class RlThreadPool
+{
+public:
+    static RlThreadPool *getInstance();
+
+    /**
+     * Runs task(0) ... task(num - 1) on the workers and the calling thread, and returns when all of them are finished.
+     * The first exception thrown by a task is rethrown in the calling thread.
+     */
+    void parallelFor(int num, const function<void(int)> &task);
+    int getThreadNum() const;
+
+    RlThreadPool(int threadNum);
+    ~RlThreadPool();
+
+protected:
+    static void afterFork();
+    void workerLoop();
+    void runTasks();
+
+    vector<thread> workers;
+    mutex poolMutex;
+    condition_variable taskReady;
+    condition_variable taskDone;
+    const function<void(int)> *currentTask = nullptr;
+    atomic<int> nextIndex{0};   // Index of the next task to be taken by a thread.
+    int taskNum = 0;            // Number of tasks in the current parallelFor call.
+    int busyWorkers = 0;        // Workers still running tasks of the current parallelFor call.
+    long generation = 0;        // Increased for every parallelFor call, wakes up the workers.
+    bool stopping = false;
+    exception_ptr firstError;
+
+private:
+    static RlThreadPool *threadPool;
+};
+
+#endif // RLTHREADPOOL_H
@@ -0,0 +1,220 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 21:06:17
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 21:06:17
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlTracer.cc
+ * @Description  : Trace of the step lifecycle of RouterRL in the trace-event JSON format of Chrome and Perfetto.
+ */
+#include "RlTracer.h"
+#include "RlStepProfiler.h"
+#include <cstdio>
+#include <omnetpp.h>
+#include <pthread.h>
+
+using namespace omnetpp;
+
+RlTracer *RlTracer::tracer = NULL;
+
+/**
+ * @brief Initialize the tracer, only the first call creates it
+ *
+ * @param file_v                Trace file
+ * @param packetSampleRate_v    Share of the received packets whose lifetime is traced
+ * @return RlTracer*            Tracer
+ */
+RlTracer *RlTracer::initTracer(string file_v, double packetSampleRate_v)
+{
+    if (!tracer) {
+        pthread_atfork(&RlTracer::beforeFork, NULL, NULL);
+        tracer = new RlTracer(file_v, packetSampleRate_v);
+    }
+    return tracer;
+}
+
+RlTracer::RlTracer(string file_v, double packetSampleRate_v) : file(file_v)
+{
+    if (packetSampleRate_v < 0 || packetSampleRate_v > 1)
+        throw cRuntimeError("The packet sample rate of the trace must be in [0, 1], got %g", packetSampleRate_v);
+    packetThreshold = (uint64_t)(packetSampleRate_v * 4294967296.0);
+    origin = RlStepProfiler::now();
+    openFile(file.getPath());
+}
+
+/**
+ * @brief Open a trace file and name its timelines and fixed tracks
+ *
+ * @param path  Trace file
+ */
+void RlTracer::openFile(const string &path)
+{
+    output.open(path, ios::out | ios::trunc);
+    if (!output)
+        throw cRuntimeError("Cannot write the trace file '%s'", path.c_str());
+    file.setOpened();
+    output << "[";
+    firstEvent = true;
+    namedHosts.clear();
+
+    char event[256];
+    const pair<int, const char *> processes[] = {{TRACE_WALL_PID, "wall clock"}, {TRACE_SIM_PID, "simulated time"}};
+    for (auto &process : processes) {
+        snprintf(event, sizeof(event), R"({"ph":"M","pid":%d,"name":"process_name","args":{"name":"%s"}})",
+                 process.first, process.second);
+        writeEvent(event);
+    }
+    const int tracks[][2] = {
+        {TRACE_WALL_PID, TRACE_TABLE_TID}, {TRACE_SIM_PID, TRACE_STEP_TID}, {TRACE_SIM_PID, TRACE_PACKET_TID}};
+    const char *trackNames[] = {"routing table", "steps", "packets"};
+    for (int i = 0; i < 3; i++) {
+        snprintf(event, sizeof(event),
+                 R"({"ph":"M","pid":%d,"tid":%d,"name":"thread_name","args":{"name":"%s"}},)"
+                 R"({"ph":"M","pid":%d,"tid":%d,"name":"thread_sort_index","args":{"sort_index":%d}})",
+                 tracks[i][0], tracks[i][1], trackNames[i], tracks[i][0], tracks[i][1], i - 3);
+        writeEvent(event);
+    }
+}
+
+/**
+ * @brief Flush the events of the parent before a fork, so that the child does not write them again
+ *
+ */
+void RlTracer::beforeFork()
+{
+    if (tracer)
+        tracer->output.flush();
+}
+
+/**
+ * @brief Continue the trace of a child process created by fork() in its own file, with the same wall-clock origin
+ *
+ */
+void RlTracer::reopen()
+{
+    output.close();
+    openFile(file.getPath());
+}
+
+void RlTracer::writeEvent(const char *event)
+{
+    if (!firstEvent)
+        output << ",";
+    output << "\n" << event;
+    firstEvent = false;
+}
+
+/**
+ * @brief Trace a wall-clock span on the routing table track
+ *
+ * @param name  Name of the span
+ * @param start Start of the span, ns of RlStepProfiler::now()
+ * @param end   End of the span, ns of RlStepProfiler::now()
+ * @param step  Step of the span, -1 if it has none
+ */
+void RlTracer::wallSpan(const char *name, uint64_t start, uint64_t end, int step)
+{
+    if (file.isStale()) {
+        // Called by the destructor of RlTraceScope, which must not throw: the span is dropped and the next event
+        // raises the error
+        try {
+            reopen();
+        } catch (cRuntimeError &e) {
+            return;
+        }
+    }
+    char event[256];
+    snprintf(event, sizeof(event),
+             R"({"ph":"X","pid":%d,"tid":%d,"name":"%s","ts":%.3f,"dur":%.3f,"args":{"step":%d,"sim_s":%.9g}})",
+             TRACE_WALL_PID, TRACE_TABLE_TID, name, wallUs(start), (end - start) * 1e-3, step, simTime().dbl());
+    writeEvent(event);
+}
+
+/**
+ * @brief Trace the step of a host on its simulated-time track, from its start to the call of countNodeEndInStep
+ *
+ * @param host      Index of the host
+ * @param hostName  Name of the host, for its track
+ * @param step      Step of the host
+ * @param start     Start of the step, simulated time in s
+ * @param end       End of the step, simulated time in s
+ */
+void RlTracer::hostStep(int host, const char *hostName, int step, double start, double end)
+{
+    if (file.isStale())
+        reopen();
+    char event[256];
+    if (host >= (int)namedHosts.size())
+        namedHosts.resize(host + 1, false);
+    if (!namedHosts[host]) {
+        snprintf(event, sizeof(event), R"({"ph":"M","pid":%d,"tid":%d,"name":"thread_name","args":{"name":"%s"}})",
+                 TRACE_SIM_PID, host, hostName);
+        writeEvent(event);
+        namedHosts[host] = true;
+    }
+    snprintf(event, sizeof(event),
+             R"({"ph":"X","pid":%d,"tid":%d,"name":"step %d","ts":%.3f,"dur":%.3f,"args":{"step":%d,"wall_us":%.3f}})",
+             TRACE_SIM_PID, host, step, start * 1e6, (end - start) * 1e6, step, wallUs(RlStepProfiler::now()));
+    writeEvent(event);
+}
+
+/**
+ * @brief Trace an event of a step at the current time, on the steps track of the simulated time and on the routing
+ * table track of the wall clock
+ *
+ * @param name  Name of the event
+ * @param step  Step of the event
+ */
+void RlTracer::instant(const char *name, int step)
+{
+    if (file.isStale())
+        reopen();
+    char event[384];
+    double wall = wallUs(RlStepProfiler::now());
+    double sim = simTime().dbl();
+    snprintf(event, sizeof(event),
+             R"({"ph":"i","s":"t","pid":%d,"tid":%d,"name":"%s","ts":%.3f,"args":{"step":%d,"wall_us":%.3f}},)"
+             R"({"ph":"i","s":"t","pid":%d,"tid":%d,"name":"%s","ts":%.3f,"args":{"step":%d,"sim_s":%.9g}})",
+             TRACE_SIM_PID, TRACE_STEP_TID, name, sim * 1e6, step, wall, TRACE_WALL_PID, TRACE_TABLE_TID, name, wall,
+             step, sim);
+    writeEvent(event);
+}
+
+/**
+ * @brief Trace the lifetime of a received packet as an async span of the packets track, overlapping packets get their
+ * own rows. Lost packets are not traced
+ *
+ * @param id        Message ID of the packet
+ * @param name      Name of the packet
+ * @param src       Source host
+ * @param dst       Destination host
+ * @param step      Step of the packet
+ * @param created   Creation time, simulated time in s
+ * @param arrived   Arrival time, simulated time in s
+ */
+void RlTracer::packetLife(long id, const char *name, const char *src, const char *dst, int step, double created,
+                          double arrived)
+{
+    if (file.isStale())
+        reopen();
+    char event[512];
+    snprintf(event, sizeof(event),
+             R"({"ph":"b","cat":"packet","id":%ld,"pid":%d,"tid":%d,"name":"%s","ts":%.3f,)"
+             R"("args":{"src":"%s","dst":"%s","step":%d}},)"
+             R"({"ph":"e","cat":"packet","id":%ld,"pid":%d,"tid":%d,"name":"%s","ts":%.3f,"args":{"wall_us":%.3f}})",
+             id, TRACE_SIM_PID, TRACE_PACKET_TID, name, created * 1e6, src, dst, step, id, TRACE_SIM_PID,
+             TRACE_PACKET_TID, name, arrived * 1e6, wallUs(RlStepProfiler::now()));
+    writeEvent(event);
+}
+
+RlTraceScope::RlTraceScope(const char *name_v, int step_v)
+    : tracer(RlTracer::getInstance()), name(name_v), step(step_v)
+{
+    if (tracer)
+        start = RlStepProfiler::now();
+}
+
+RlTraceScope::~RlTraceScope()
+{
+    if (tracer)
+        tracer->wallSpan(name, start, RlStepProfiler::now(), step);
+}
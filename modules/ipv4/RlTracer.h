@@ -0,0 +1,91 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 21:06:17
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 21:06:17
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlTracer.h
+ * @Description  : Trace of the step lifecycle of RouterRL in the trace-event JSON format of Chrome and Perfetto.
+ */
+#ifndef RLTRACER_H
+#define RLTRACER_H
+#include "RlForkedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define TRACE_WALL_PID   1      // Wall-clock timeline: messages of the routing table and waits for the agent
+#define TRACE_SIM_PID    2      // Simulated-time timeline: steps of the hosts, step closures and packet lifetimes
+#define TRACE_TABLE_TID  0      // Track of the routing table in the wall-clock timeline
+#define TRACE_STEP_TID   100000 // Track of the step closures in the simulated-time timeline, hosts use their index
+#define TRACE_PACKET_TID 100001 // Track of the sampled packets in the simulated-time timeline
+
+/**
+ * Writes the step lifecycle as a JSON array of trace events, which chrome://tracing and ui.perfetto.dev open as two
+ * timelines: the wall-clock one, with updateRoutingTable, endStep and the waits for the agent nested in them, and the
+ * simulated-time one, with the steps of every host, the rewards and timeouts of the steps and sampled packets from
+ * their creation to their arrival. Every event also carries the time of the other clock in its arguments, wall_us or
+ * sim_s, so that a stall of one timeline can be found in the other. The array is left open, which both viewers accept,
+ * so that the trace of a stopped run can be read.
+ * There is only a single global static object, and none when tracing is off. A child process created by fork() writes
+ * its own trace file, see RlForkedFile.
+ */
+class RlTracer
+{
+public:
+    static RlTracer *getInstance() { return tracer; }
+
+    /**
+     * Used to initialize the unique static instance, opens the trace file and names the timelines.
+     */
+    static RlTracer *initTracer(string file_v, double packetSampleRate_v);
+
+    void wallSpan(const char *name, uint64_t start, uint64_t end, int step);
+    void hostStep(int host, const char *hostName, int step, double start, double end);
+    void instant(const char *name, int step);
+    // Packets are sampled on their message ID, so that the choice is the same in every run
+    bool samplePacket(long id) const { return (uint32_t)((uint64_t)id * 2654435761ULL) < packetThreshold; }
+    void packetLife(long id, const char *name, const char *src, const char *dst, int step, double created,
+                    double arrived);
+    void flush() { output.flush(); }
+
+protected:
+    RlTracer(string file_v, double packetSampleRate_v);
+    static void beforeFork();
+    void openFile(const string &path);
+    void reopen();
+    void writeEvent(const char *event);
+    double wallUs(uint64_t time) const { return (time - origin) * 1e-3; }
+
+    RlForkedFile file;
+    ofstream output;
+    bool firstEvent = true;
+    uint64_t origin = 0;          // Wall-clock origin of the trace, ns
+    uint64_t packetThreshold = 0; // Packets whose 32-bit hashed ID is below the threshold are traced
+    vector<bool> namedHosts;      // Hosts whose track is already named
+
+private:
+    static RlTracer *tracer;
+};
+
+/**
+ * Traces the wall-clock span of a scope on the routing table track. Costs a pointer test when tracing is off.
+ */
+class RlTraceScope
+{
+public:
+    RlTraceScope(const char *name_v, int step_v = -1);
+    ~RlTraceScope();
+    RlTraceScope(const RlTraceScope &) = delete;
+    RlTraceScope &operator=(const RlTraceScope &) = delete;
+
+protected:
+    RlTracer *tracer;
+    const char *name;
+    int step;
+    uint64_t start = 0;
+};
+
+#endif // RLTRACER_H
@@ -0,0 +1,159 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 11:41:08
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 13:22:04
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlWeightedShortestPathRoutingTable.cc
+ * @Description  : Weighted shortest path routing table in RouterRL.
+ */
+#include "RlWeightedShortestPathRoutingTable.h"
+
+RlWeightedShortestPathRoutingTable *RlWeightedShortestPathRoutingTable::wTable = NULL;
+
+RlWeightedShortestPathRoutingTable::RlWeightedShortestPathRoutingTable()
+{
+}
+
+RlWeightedShortestPathRoutingTable::~RlWeightedShortestPathRoutingTable()
+{
+    if (zmq_socket) {
+        zmq_socket->close();
+        delete zmq_socket;
+        zmq_socket = nullptr;
+        zmq_context->close();
+        delete zmq_context;
+    }
+    if (engine)
+        delete engine;
+    if (wTable)
+        delete wTable;
+}
+
+/**
+ * @brief Used to get the unique static instance, throws an exception if the instance is not initialized
+ *
+ * @return RlWeightedShortestPathRoutingTable* Weighted shortest path routing table
+ */
+RlWeightedShortestPathRoutingTable *RlWeightedShortestPathRoutingTable::getInstance()
+{
+    return wTable;
+}
+
+/**
+ * @brief Initialize the weighted shortest path routing table
+ *
+ * @param num                   Number of nodes in the network topology
+ * @param initTopo_v            Adjacency matrix of the network topology
+ * @param initRoutingTable_v    Initial link weights, all links use weight 1 if empty
+ * @param port                  ZMQ communication port
+ * @param overTime_v            Timeout value
+ * @param totalStep_v           Total number of simulation steps
+ * @param simMode_v             Simulation mode
+ * @return RlWeightedShortestPathRoutingTable* Initialized weighted shortest path routing table
+ */
+RlWeightedShortestPathRoutingTable *
+RlWeightedShortestPathRoutingTable::initTable(int num, const char *initTopo_v,
+                                              const char *initRoutingTable_v, int port,
+                                              double overTime_v, int totalStep_v, int simMode_v)
+{
+    if (!wTable) {
+        wTable = new RlWeightedShortestPathRoutingTable();
+        wTable->setVals(port, num, initTopo_v, initRoutingTable_v, overTime_v, totalStep_v,
+                        simMode_v);
+        wTable->initiate();
+    }
+    return wTable;
+}
+
+/**
+ * @brief Initializes the instance, establishes ZMQ communication with the Python side based on TCP, and allocates memory for statistics variables
+ *
+ */
+void RlWeightedShortestPathRoutingTable::initiate()
+{
+    RlBasicRoutingTable::initiate();
+    initTopoTable(initTopo, topo);
+    engine = new RlShortestPathEngine(nodeNum, topo);
+    weights.assign(edgeNum, 1.0);
+    parseLinkWeights(initRoutingTable, weights);
+    engine->compute(weights);
+}
+
+void RlWeightedShortestPathRoutingTable::setVals(int port, int num, const char *initTopo_v,
+                                                 const char *initRoutingTable_v, double overTime_v,
+                                                 int totalStep_v, int returnMode_v)
+{
+    zmqPort = port;
+    nodeNum = num;
+    initTopo = initTopo_v;
+    initRoutingTable = initRoutingTable_v;
+    overTime = overTime_v;
+    totalStep = totalStep_v;
+    returnMode = returnMode_v;
+}
+
+/**
+ * @brief Number the directed links of the network topology row by row
+ *
+ * @param initTopo  Adjacency matrix, in the format of 0,1,1,0,...
+ * @param topo      Network topology to fill
+ */
+void RlWeightedShortestPathRoutingTable::initTopoTable(string initTopo, int **topo)
+{
+    istringstream iss(initTopo);
+    string token;
+    int edgeCount = 0, row = 0, col = 0;
+    while (getline(iss, token, ',') && row < nodeNum) {
+        topo[row][col] = atoi(token.c_str()) ? edgeCount++ : -1;
+        col++;
+        if (col == nodeNum) {
+            row++;
+            col = 0;
+        }
+    }
+    edgeNum = edgeCount;
+}
+
+/**
+ * @brief Get the next hop on the shortest path towards the destination
+ *
+ * @param nodeId    ID of the current node
+ * @param srcNode   ID of the source node
+ * @param dstNode   ID of the destination node
+ * @return int      Next hop node
+ */
+int RlWeightedShortestPathRoutingTable::getNextNode(int nodeId, int srcNode, int dstNode)
+{
+    return engine->getNextNode(nodeId, dstNode);
+}
+
+/**
+ * @brief Called after all packets of the current step have been sent, communicates with the ZMQ server (Python side), transfers the current step's throughput, obtains the link weights for the next step, recomputes the next hops, and clears the already collected throughput data
+ *
+ * @param step      Current step number
+ * @param stepTime  Duration of each step
+ */
+void RlWeightedShortestPathRoutingTable::updateRoutingTable(int step, double stepTime)
+{
+    updateNodeCount[step]++;
+    if (updateNodeCount[step] == nodeNum) {
+        // The last node to enter the next step update
+        string stateStr;
+        stateStr += "s@@" + to_string(step) + "@@";
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++) {
+                if (i == nodeNum - 1 && j == nodeNum - 1)
+                    stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime);
+                else
+                    stateStr += to_string(double(pkct[i][j]) / 1000 / 1000 / stepTime) + ",";
+            }
+        recordLinkLoads(step, stepTime);
+        clearPkts();
+
+        // The received data contains edgeNum weights, one for each directed link
+        parseLinkWeights(exchange(stateStr), weights);
+        // Only the shortest path trees affected by the changed weights are repaired
+        engine->update(weights);
+        sendId = 0; // Reset packet ID for the next step
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 11:41:08
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 11:41:08
+ * @FilePath     : /root/RouterRL/modules/ipv4/RlWeightedShortestPathRoutingTable.h
+ * @Description  : Weighted shortest path routing table in RouterRL.
+ */
+#ifndef RLWEIGHTEDSHORTESTPATHROUTINGTABLE_H
+#define RLWEIGHTEDSHORTESTPATHROUTINGTABLE_H
+#include "RlBasicRoutingTable.h"
+#include "RlShortestPathEngine.h"
+
+/**
+ * The agent sends one weight for each directed link, and the simulator forwards every packet along the shortest path
+ * under these weights. Next hops of all node pairs are recomputed in C++ once per step.
+ */
+class RlWeightedShortestPathRoutingTable : public RlBasicRoutingTable
+{
+public:
+    RlWeightedShortestPathRoutingTable();
+    ~RlWeightedShortestPathRoutingTable();
+    /**
+     * Used to get the unique static instance, throws an exception if the instance is not initialized.
+     */
+    static RlWeightedShortestPathRoutingTable *getInstance();
+
+    /**
+     * Used to initialize the unique static instance, set parameters, and allocate memory for statistics variables.
+     */
+    static RlWeightedShortestPathRoutingTable *initTable(int num, const char *initTopo_v,
+                                                         const char *initRoutingTable_v, int port,
+                                                         double overTime_v, int totalStep_v,
+                                                         int simMode_v);
+    void initiate() override;
+    void setVals(int port, int num, const char *initTopo_v, const char *initRoutingTable_v,
+                 double overTime_v, int totalStep_v, int returnMode_v);
+    void updateRoutingTable(int step, double stepTime) override;
+    int getNextNode(int nodeId, int srcNode, int dstNode) override;
+    void initTopoTable(string initTopo, int **topo);
+
+protected:
+    string initTopo = "";
+    vector<double> weights;                 // Weight of each directed link, indexed by the link number in topo.
+    RlShortestPathEngine *engine = nullptr; // Next hops under the current weights.
+
+private:
+    static RlWeightedShortestPathRoutingTable *wTable;
+};
+
+#endif // RLWEIGHTEDSHORTESTPATHROUTINGTABLE_H
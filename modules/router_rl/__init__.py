@@ -1,13 +1,17 @@
 from .base_env import BaseEnv
 from .conventional_env import ConventionalEnv
+from .ecmp_env import EcmpEnv
 from .multipath_env import MultipathEnv
 from .path_env import PathEnv
 from .probabilistic_env import ProbabilisticEnv
+from .weighted_env import WeightedEnv
 
 __all__ = [
     "BaseEnv",
     "ConventionalEnv",
+    "EcmpEnv",
     "MultipathEnv",
     "PathEnv",
     "ProbabilisticEnv",
+    "WeightedEnv",
 ]
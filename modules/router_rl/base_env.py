@@ -7,14 +7,66 @@ FilePath     : /root/RouterRL/modules/router_rl/base_env.py
 Description  : Interface file of our KDN-based network simulator.
 """
 
+import copy
 import os
+import signal
 import sys
 import subprocess
 import re
+import time
 from typing import Union, Tuple, List
 import zmq
 
 
+class ForkedProcess:
+    """Simulator process forked from another one, with the part of the subprocess.Popen interface used by the envs."""
+
+    def __init__(self, pid: int):
+        self.pid = pid
+
+    def terminate(self) -> None:
+        """Stop the forked simulator."""
+        try:
+            os.kill(self.pid, signal.SIGTERM)
+        except ProcessLookupError:
+            pass
+
+    def exited(self) -> bool:
+        """Whether the forked simulator exited. It is only reaped by the simulator it was forked from, which may be
+        blocked on its own request, so a zombie counts as exited.
+
+        Returns:
+            bool: True if the process is gone or a zombie.
+        """
+        try:
+            with open(f"/proc/{self.pid}/stat") as stat:
+                # The state follows the command name, which is in parentheses and may contain any character
+                return stat.read().rsplit(")", 1)[1].split()[0] in ("Z", "X")
+        except FileNotFoundError:
+            if os.path.isdir("/proc/self"):
+                return True
+        # Without /proc, only a reaped process is seen as exited
+        try:
+            os.kill(self.pid, 0)
+        except ProcessLookupError:
+            return True
+        return False
+
+    def wait(self, timeout: float = None) -> None:
+        """Wait until the forked simulator exits, even if the simulator it was forked from has not reaped it yet.
+
+        Args:
+            timeout (float, optional): Seconds to wait, forever if None.
+        """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            if self.exited():
+                return
+            if deadline is not None and time.monotonic() > deadline:
+                raise subprocess.TimeoutExpired(f"pid {self.pid}", timeout)
+            time.sleep(0.01)
+
+
 class BaseEnv:
     """Base class for network simulator interface."""
 
@@ -150,6 +202,24 @@ class BaseEnv:
             msg = req[2][:-1]
         return s_or_r, step, msg
 
+    def receive_catalog(self) -> dict:
+        """Receive the candidate path catalog computed by the network simulator.
+
+        Returns:
+            dict: Candidate paths of each OD pair, in the format of {(src, dst): [[node, ...], ...]}.
+        """
+        request = self.socket.recv().decode()
+        catalog = {}
+        for od_item in request.split("@@")[2].split(";"):
+            if not od_item:
+                continue
+            src, dst, paths = od_item.split(",")
+            catalog[(int(src), int(dst))] = [
+                [int(node) for node in path.split(".")] for path in paths.split("|")
+            ]
+        self.socket.send_string("catalog received")
+        return catalog
+
     def make_action(self, action: str) -> None:
         """Send message to network simulator by socket.
 
@@ -161,3 +231,30 @@ class BaseEnv:
     def reward_rcvd(self) -> None:
         """Get reward and return the received message."""
         self.socket.send_string("reward received")
+
+    def fork(self, num: int) -> List["BaseEnv"]:
+        """Fork the simulator into num children sharing its current state (events, packets in flight, routing state
+        and statistics), e.g. to branch several episodes from the same warmed-up network.
+        Must be called while a request of the simulator is pending, i.e. after get_obs() and before the reply to it.
+        The request is sent again by every child and by this simulator, which stays at this point until it is answered,
+        so it can be forked again later as a snapshot.
+
+        Args:
+            num (int): Number of children.
+
+        Returns:
+            List[BaseEnv]: Env of each child, closed like any other env.
+        """
+        children = []
+        for _ in range(num):
+            child = copy.copy(self)
+            child.socket = self.context.socket(zmq.REP)
+            child.socket.setsockopt(zmq.RCVTIMEO, 30000)
+            child.port = child.socket.bind_to_random_port("tcp://127.0.0.1")
+            children.append(child)
+        self.socket.send_string("fork@@" + ",".join(str(child.port) for child in children))
+        for child in children:
+            # The child announces its pid before sending the pending request again
+            child.process = ForkedProcess(int(child.socket.recv().decode().split("@@")[1]))
+            child.socket.send_string("fork received")
+        return children
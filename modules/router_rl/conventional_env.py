@@ -2,11 +2,15 @@
 Author       : LIN Guocheng
 Date         : 2024-05-08 11:34:22
 LastEditors  : LIN Guocheng
-LastEditTime : 2024-09-24 08:33:08
+LastEditTime : 2026-10-18 14:05:37
 FilePath     : /root/RouterRL/modules/router_rl/conventional_env.py
 Description  : Interface file of our KDN-based network simulator.
 """
 
+import os
+import re
+import sys
+import subprocess
 from .base_env import BaseEnv
 
 
@@ -22,5 +26,75 @@ class ConventionalEnv(BaseEnv):
         seed: int = 0,
         ned_path: str = "config/ned",
         log_path: str = "logs/inet.out",
+        reprogram_routes: bool = False,
     ):
         super().__init__(network, flow_rate, total_step, routing_mode, seed, ned_path, log_path)
+        self.reprogram_routes = reprogram_routes
+        if self.reprogram_routes:
+            # One weight for each directed link, numbered row by row in the adjacency matrix
+            self.edge_num = self.count_directed_links(os.path.join(ned_path, f"{network}.ned"))
+            self.routing_table = [1.0] * self.edge_num
+
+    def count_directed_links(self, ned_path: str) -> int:
+        """Count the directed links between routers in ned files.
+
+        Args:
+            ned_path (str): Path of ned file to count.
+
+        Returns:
+            int: Number of directed links.
+        """
+        with open(ned_path, "r", encoding="utf-8") as file:
+            ned_content = file.read()
+        connections = re.findall(r"R\[(\d+)\].*? <--> C <--> R\[(\d+)\].*?;", ned_content)
+        links = set()
+        for conn in connections:
+            i, j = map(int, conn)
+            links.add((i, j))
+            links.add((j, i))
+        return len(links)
+
+    def start_sim(self, log_path: str) -> None:
+        """Start network simulator.
+
+        Args:
+            log_path (str): Path for saving simulator logs.
+        """
+        with open(log_path, "w", encoding="utf-8") as out:
+            self.process = subprocess.Popen(
+                [
+                    f"{os.getenv('__omnetpp_root_dir')}/bin/opp_run_release",
+                    "-l",
+                    f"{os.getenv('INET_ROOT')}/bin/../src/../src/INET",
+                    "-x",
+                    "inet.applications.voipstream;inet.common.selfdoc;inet.emulation;"
+                    "inet.examples.emulation;inet.examples.voipstream;"
+                    "inet.linklayer.configurator.gatescheduling.z3;inet.showcases.emulation;"
+                    "inet.showcases.visualizer.osg;inet.transportlayer.tcp_lwip;"
+                    "inet.visualizer.osg",
+                    "-n",
+                    f"{os.getenv('INET_ROOT')}/examples:{os.getenv('INET_ROOT')}/showcases:"
+                    f"{os.getenv('INET_ROOT')}/src:{os.getenv('INET_ROOT')}/tests/validation:"
+                    f"{os.getenv('INET_ROOT')}/tests/networks:"
+                    f"{os.getenv('INET_ROOT')}/tutorials:",
+                    f"--image-path={os.getenv('INET_ROOT')}/images",
+                    "config/omnetpp.ini",
+                    "--num-rngs=1",
+                    f"--seed-0-mt={self.seed}",
+                    f"--ned-path={self.ned_path}",
+                    f"--network={self.network}",
+                    '--**.app[0].returnMode="global"',
+                    f'--**.app[0].routingMode="{self.routing_mode}"',
+                    f'--**.configurator.routingMode="{self.routing_mode}"',
+                    f"--**.app[0].flowRate={self.flow_rate}",
+                    '--**.app[0].initRoutingTable=""',
+                    '--**.app[0].topoTable=""',
+                    f"--**.app[0].reprogramRoutes={'true' if self.reprogram_routes else 'false'}",
+                    f"--**.app[0].nodeNum={self.node_num}",
+                    f"--**.app[0].totalStep={self.total_step+100}",
+                    f"--**.app[0].zmqPort={self.port}",
+                ],
+                stdin=None,
+                stdout=out,
+                stderr=sys.stderr,
+            )
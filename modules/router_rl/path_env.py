@@ -24,13 +24,21 @@ class PathEnv(BaseEnv):
         seed: int = 0,
         ned_path: str = "config/ned",
         log_path: str = "logs/inet.out",
+        candidate_path_num: int = 0,
     ):
         self.return_mode = return_mode
+        self.candidate_path_num = candidate_path_num
+        self.catalog = {}
         super().__init__(network, flow_rate, total_step, routing_mode, seed, ned_path, log_path)
         self.console = Console()
         self.node_num, self.topo = self.init_ned_info(os.path.join(ned_path, f"{network}.ned"))
         self.topo_str = ",".join([",".join(map(str, row)) for row in self.topo])
-        self.routing_table = self.get_shortest_paths()
+        if self.candidate_path_num > 0:
+            # Candidate paths are computed by the simulator and received in reset()
+            self.max_candidate_path_num = self.candidate_path_num
+            self.routing_table = ""
+        else:
+            self.routing_table = self.get_shortest_paths()
 
     def init_ned_info(self, ned_path: str) -> Tuple[int, List[List[int]]]:
         """Initialize network basic information from ned files.
@@ -137,6 +145,10 @@ class PathEnv(BaseEnv):
         """Reset simulator."""
         self.close()
         self.start_sim(self.log_path)
+        if self.candidate_path_num > 0:
+            self.catalog = self.receive_catalog()
+            # Every OD pair starts from its first candidate path
+            self.routing_table = ",".join(["0"] * len(self.catalog))
         self.console.log("===> Env resetted!")
 
     def start_sim(self, log_path: str) -> None:
@@ -145,6 +157,7 @@ class PathEnv(BaseEnv):
         Args:
             log_path (str): Path for saving simulator logs.
         """
+        init_routing_table = "" if self.candidate_path_num > 0 else self.routing_table
         with open(log_path, "w", encoding="utf-8") as out:
             self.process = subprocess.Popen(
                 [
@@ -172,8 +185,9 @@ class PathEnv(BaseEnv):
                     f'--**.app[0].routingMode="{self.routing_mode}"',
                     f'--**.configurator.routingMode="{self.routing_mode}"',
                     f"--**.app[0].flowRate={self.flow_rate}",
-                    f'--**.app[0].initRoutingTable="{self.routing_table}"',
+                    f'--**.app[0].initRoutingTable="{init_routing_table}"',
                     f'--**.app[0].topoTable="{self.topo_str}"',
+                    f"--**.app[0].candidatePathNum={self.candidate_path_num}",
                     f"--**.app[0].nodeNum={self.node_num}",
                     f"--**.app[0].totalStep={self.total_step+100}",  # Warm-up period
                     f"--**.app[0].zmqPort={self.port}",
@@ -0,0 +1,223 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 16:05:37
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 16:05:37
+ * @FilePath     : /root/RouterRL/modules/udpapp/RlTrafficMatrix.cc
+ * @Description  : Per-step traffic matrices driving RlUdpApp in RouterRL.
+ */
+#include "RlTrafficMatrix.h"
+#include <algorithm>
+#include <fstream>
+#include <omnetpp.h>
+#include <sstream>
+
+using namespace omnetpp;
+
+#define BIMODAL_ELEPHANT_PROB 0.2   // Share of elephant pairs in the bimodal model
+#define BIMODAL_ELEPHANT_MEAN 10.0  // Mean load of an elephant pair, relative to a mouse pair
+#define HOTSPOT_NODE_RATIO    0.1   // Share of hosts that are hotspots in the hotspot model
+#define HOTSPOT_LOAD_RATIO    0.5   // Share of the total load sent to the hotspots
+
+RlTrafficMatrix *RlTrafficMatrix::trafficMatrix = NULL;
+
+RlTrafficMatrix::RlTrafficMatrix(int nodeNum_v, string model_v, double flowRate_v, string file_v,
+                                 double density_v, int seed_v)
+    : nodeNum(nodeNum_v), model(model_v), flowRate(flowRate_v), file(file_v), density(density_v),
+      seed(seed_v)
+{
+}
+
+/**
+ * @brief Used to get the unique static instance, NULL if the instance is not initialized
+ *
+ * @return RlTrafficMatrix* Traffic matrix
+ */
+RlTrafficMatrix *RlTrafficMatrix::getInstance()
+{
+    return trafficMatrix;
+}
+
+/**
+ * @brief Initialize the traffic matrix, the first host to call it sets the parameters of all hosts
+ *
+ * @param nodeNum_v     Number of hosts
+ * @param model_v       Traffic model: uniform, gravity, bimodal, hotspot or file
+ * @param flowRate_v    Load of each OD pair in the uniform matrix (Mbits/s), sets the total load of generated models
+ * @param file_v        Matrix file of the file model, one step per line with nodeNum * nodeNum loads in row-major order
+ * @param density_v     Probability that an OD pair is active in a step of the gravity, bimodal and hotspot models
+ * @param seed_v        Seed of the generated models
+ * @return RlTrafficMatrix* Initialized traffic matrix
+ */
+RlTrafficMatrix *RlTrafficMatrix::initMatrix(int nodeNum_v, string model_v, double flowRate_v,
+                                             string file_v, double density_v, int seed_v)
+{
+    if (!trafficMatrix) {
+        if (model_v != "uniform" && model_v != "gravity" && model_v != "bimodal"
+            && model_v != "hotspot" && model_v != "file")
+            throw cRuntimeError("Unknown traffic model '%s'", model_v.c_str());
+        if (!(density_v > 0 && density_v <= 1))
+            throw cRuntimeError("Invalid traffic density %f, it must be in (0, 1]", density_v);
+        trafficMatrix =
+            new RlTrafficMatrix(nodeNum_v, model_v, flowRate_v, file_v, density_v, seed_v);
+        if (model_v == "file")
+            trafficMatrix->loadFile();
+    }
+    return trafficMatrix;
+}
+
+/**
+ * @brief Read the matrices of the file model, loads are separated by commas or spaces and lines starting with # are skipped
+ *
+ */
+void RlTrafficMatrix::loadFile()
+{
+    ifstream in(file);
+    if (!in)
+        throw cRuntimeError("Cannot open traffic matrix file '%s'", file.c_str());
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        for (auto &c : line)
+            if (c == ',')
+                c = ' ';
+        istringstream iss(line);
+        vector<double> matrix;
+        double rate;
+        while (iss >> rate) {
+            if (rate < 0)
+                throw cRuntimeError("Negative load %f in traffic matrix file '%s'", rate,
+                                    file.c_str());
+            matrix.push_back(rate);
+        }
+        if (matrix.empty())
+            continue;
+        if ((int)matrix.size() != nodeNum * nodeNum)
+            throw cRuntimeError("Traffic matrix %d of '%s' has %d loads, %d expected",
+                                (int)fileMatrices.size(), file.c_str(), (int)matrix.size(),
+                                nodeNum * nodeNum);
+        for (int i = 0; i < nodeNum; i++)
+            matrix[i * nodeNum + i] = 0;
+        fileMatrices.push_back(matrix);
+    }
+    if (fileMatrices.empty())
+        throw cRuntimeError("Traffic matrix file '%s' contains no matrix", file.c_str());
+}
+
+/**
+ * @brief Get the load of an OD pair, the matrix of the last requested step is kept since all hosts ask for the same step
+ *
+ * @param step      Step number
+ * @param src       ID of the source host
+ * @param dst       ID of the destination host
+ * @return double   Load of the OD pair (Mbits/s)
+ */
+double RlTrafficMatrix::getRate(int step, int src, int dst)
+{
+    if (model == "file")
+        return fileMatrices[step % fileMatrices.size()][src * nodeNum + dst];
+    if (step != cachedStep) {
+        generate(step, cachedMatrix);
+        cachedStep = step;
+    }
+    return cachedMatrix[src * nodeNum + dst];
+}
+
+/**
+ * @brief Generate the matrix of a step, the random numbers only depend on the seed and the step
+ *
+ * @param step      Step number
+ * @param matrix    Matrix to fill, row-major
+ */
+void RlTrafficMatrix::generate(int step, vector<double> &matrix)
+{
+    matrix.assign(nodeNum * nodeNum, 0);
+    mt19937_64 gen(((uint64_t)(uint32_t)seed << 32) | (uint32_t)step);
+
+    if (model == "uniform") {
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++)
+                matrix[i * nodeNum + j] = i == j ? 0 : flowRate;
+        return;
+    }
+
+    if (model == "gravity") {
+        // The load of a pair is proportional to the outgoing mass of the source and the incoming mass of the destination
+        exponential_distribution<double> mass(1.0);
+        vector<double> outMass(nodeNum), inMass(nodeNum);
+        for (int i = 0; i < nodeNum; i++) {
+            outMass[i] = mass(gen);
+            inMass[i] = mass(gen);
+        }
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++)
+                if (i != j)
+                    matrix[i * nodeNum + j] = outMass[i] * inMass[j];
+    } else if (model == "bimodal") {
+        // Most pairs are mice, a few are elephants carrying several times more traffic
+        bernoulli_distribution isElephant(BIMODAL_ELEPHANT_PROB);
+        normal_distribution<double> elephant(BIMODAL_ELEPHANT_MEAN, BIMODAL_ELEPHANT_MEAN * 0.15);
+        normal_distribution<double> mouse(1.0, 0.15);
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++)
+                if (i != j)
+                    matrix[i * nodeNum + j] =
+                        max(0.0, isElephant(gen) ? elephant(gen) : mouse(gen));
+    } else if (model == "hotspot") {
+        // A fixed share of the load goes to a few hotspot destinations, the rest is spread over all pairs
+        int hotNum = max(1, (int)(nodeNum * HOTSPOT_NODE_RATIO + 0.5));
+        vector<int> nodes(nodeNum);
+        for (int i = 0; i < nodeNum; i++)
+            nodes[i] = i;
+        shuffle(nodes.begin(), nodes.end(), gen);
+        vector<bool> isHot(nodeNum, false);
+        for (int k = 0; k < hotNum; k++)
+            isHot[nodes[k]] = true;
+        int hotPairs = 0, pairs = nodeNum * (nodeNum - 1);
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++)
+                if (i != j && isHot[j])
+                    hotPairs++;
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++)
+                if (i != j)
+                    matrix[i * nodeNum + j] = (1 - HOTSPOT_LOAD_RATIO) / pairs
+                                              + (isHot[j] ? HOTSPOT_LOAD_RATIO / hotPairs : 0);
+    }
+    sparsify(gen, matrix);
+    scaleToTotal(matrix);
+}
+
+/**
+ * @brief Deactivate each OD pair with probability 1 - density
+ *
+ * @param gen       Random number generator of the step
+ * @param matrix    Matrix to sparsify
+ */
+void RlTrafficMatrix::sparsify(mt19937_64 &gen, vector<double> &matrix)
+{
+    if (density >= 1)
+        return;
+    bernoulli_distribution isActive(density);
+    for (auto &rate : matrix)
+        if (rate > 0 && !isActive(gen))
+            rate = 0;
+}
+
+/**
+ * @brief Scale the matrix so that its total load equals the uniform all-to-all matrix
+ *
+ * @param matrix    Matrix to scale
+ */
+void RlTrafficMatrix::scaleToTotal(vector<double> &matrix)
+{
+    double sum = 0;
+    for (auto rate : matrix)
+        sum += rate;
+    if (sum <= 0)
+        return;
+    double scale = flowRate * nodeNum * (nodeNum - 1) / sum;
+    for (auto &rate : matrix)
+        rate *= scale;
+}
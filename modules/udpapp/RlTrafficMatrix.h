@@ -0,0 +1,61 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 16:05:37
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 16:05:37
+ * @FilePath     : /root/RouterRL/modules/udpapp/RlTrafficMatrix.h
+ * @Description  : Per-step traffic matrices driving RlUdpApp in RouterRL.
+ */
+#ifndef RLTRAFFICMATRIX_H
+#define RLTRAFFICMATRIX_H
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Offered load of every OD pair (in Mbits/s) for each step. Generated models are scaled to the same total load as the
+ * uniform all-to-all matrix with flowRate on every pair, so results of different models are comparable. Matrices are
+ * generated from the seed and the step only, so that every host sees the same matrix whatever the order of its calls.
+ * There is only a single global static object, shared by the applications of all hosts.
+ */
+class RlTrafficMatrix
+{
+public:
+    static RlTrafficMatrix *getInstance();
+
+    /**
+     * Used to initialize the unique static instance, the model is one of uniform, gravity, bimodal, hotspot or file.
+     */
+    static RlTrafficMatrix *initMatrix(int nodeNum_v, string model_v, double flowRate_v,
+                                       string file_v, double density_v, int seed_v);
+
+    /**
+     * Offered load from the source host to the destination host during the step, 0 if the pair is inactive.
+     */
+    double getRate(int step, int src, int dst);
+
+protected:
+    RlTrafficMatrix(int nodeNum_v, string model_v, double flowRate_v, string file_v,
+                    double density_v, int seed_v);
+    void loadFile();
+    void generate(int step, vector<double> &matrix);
+    void sparsify(mt19937_64 &gen, vector<double> &matrix);
+    void scaleToTotal(vector<double> &matrix);
+
+    int nodeNum;
+    string model;
+    double flowRate;               // Load of each pair in the uniform matrix, which sets the total load
+    string file;
+    double density;                // Probability that an OD pair is active in a step of a generated model
+    int seed;
+    vector<vector<double>> fileMatrices; // Matrices of the file, one per line, reused cyclically
+    int cachedStep = -1;
+    vector<double> cachedMatrix;   // Matrix of cachedStep, row-major: cachedMatrix[src * nodeNum + dst]
+
+private:
+    static RlTrafficMatrix *trafficMatrix;
+};
+
+#endif // RLTRAFFICMATRIX_H
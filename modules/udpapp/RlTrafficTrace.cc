@@ -0,0 +1,167 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 16:48:12
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 16:48:12
+ * @FilePath     : /root/RouterRL/modules/udpapp/RlTrafficTrace.cc
+ * @Description  : Memory-mapped traffic matrix trace replayed by RlUdpApp in RouterRL.
+ */
+#include "RlTrafficTrace.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <omnetpp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace omnetpp;
+
+RlTrafficTrace *RlTrafficTrace::trafficTrace = NULL;
+
+RlTrafficTrace::RlTrafficTrace(string file_v, int nodeNum_v, int startStep_v)
+    : file(file_v), nodeNum(nodeNum_v), startStep(startStep_v)
+{
+}
+
+RlTrafficTrace::~RlTrafficTrace()
+{
+    if (mapping)
+        munmap((void *)mapping, mappingSize);
+}
+
+/**
+ * @brief Used to get the unique static instance, NULL if the instance is not initialized
+ *
+ * @return RlTrafficTrace* Traffic trace
+ */
+RlTrafficTrace *RlTrafficTrace::getInstance()
+{
+    return trafficTrace;
+}
+
+/**
+ * @brief Initialize the traffic trace, the first host to call it maps the file for all hosts
+ *
+ * @param file_v        Path of the binary trace file
+ * @param nodeNum_v     Number of hosts, must match the trace
+ * @param startStep_v   Trace step replayed by the first simulation step
+ * @return RlTrafficTrace* Initialized traffic trace
+ */
+RlTrafficTrace *RlTrafficTrace::openTrace(string file_v, int nodeNum_v, int startStep_v)
+{
+    if (!trafficTrace) {
+        RlTrafficTrace *trace = new RlTrafficTrace(file_v, nodeNum_v, startStep_v);
+        try {
+            trace->mapFile();
+        } catch (...) {
+            delete trace;
+            throw;
+        }
+        trafficTrace = trace;
+    }
+    return trafficTrace;
+}
+
+/**
+ * @brief Map the trace file and check the header and the step index, the demands themselves are not touched
+ *
+ */
+void RlTrafficTrace::mapFile()
+{
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw cRuntimeError("Cannot open traffic trace '%s'", file.c_str());
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RlTraceHeader)) {
+        close(fd);
+        throw cRuntimeError("Traffic trace '%s' is too short", file.c_str());
+    }
+    mappingSize = st.st_size;
+    void *addr = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        throw cRuntimeError("Cannot map traffic trace '%s'", file.c_str());
+    mapping = (const char *)addr;
+
+    const RlTraceHeader *header = (const RlTraceHeader *)mapping;
+    if (header->magic != RL_TRACE_MAGIC || header->version != RL_TRACE_VERSION)
+        throw cRuntimeError("'%s' is not a version %d traffic trace", file.c_str(),
+                            RL_TRACE_VERSION);
+    if ((int)header->nodeNum != nodeNum)
+        throw cRuntimeError("Traffic trace '%s' has %u nodes, the network has %d", file.c_str(),
+                            header->nodeNum, nodeNum);
+    size_t demandBegin = sizeof(RlTraceHeader) + ((size_t)header->stepNum + 1) * sizeof(uint64_t);
+    if (header->stepNum == 0 || header->stepNum > INT32_MAX || mappingSize < demandBegin)
+        throw cRuntimeError("Traffic trace '%s' has no valid step index", file.c_str());
+    stepNum = header->stepNum;
+    stepOffset = (const uint64_t *)(mapping + sizeof(RlTraceHeader));
+    for (int i = 0; i <= stepNum; i++) {
+        uint64_t offset = stepOffset[i];
+        if (offset < demandBegin || offset > mappingSize
+            || (offset - demandBegin) % sizeof(RlTraceDemand)
+            || (i > 0 && offset < stepOffset[i - 1]))
+            throw cRuntimeError("Invalid offset of step %d in traffic trace '%s'", i, file.c_str());
+    }
+    startStep = ((startStep % stepNum) + stepNum) % stepNum;
+    checkedSteps.assign(stepNum, false);
+}
+
+/**
+ * @brief Check that the demands of a trace step are sorted by source and then by destination, and inside the network
+ *
+ * @param traceStep Trace step to check
+ */
+void RlTrafficTrace::checkStep(int traceStep)
+{
+    const RlTraceDemand *first = (const RlTraceDemand *)(mapping + stepOffset[traceStep]);
+    const RlTraceDemand *last = (const RlTraceDemand *)(mapping + stepOffset[traceStep + 1]);
+    for (const RlTraceDemand *demand = first; demand != last; demand++) {
+        if (demand->src >= nodeNum || demand->dst >= nodeNum)
+            throw cRuntimeError("Demand %u->%u of step %d in traffic trace '%s' is outside of %d nodes", demand->src,
+                                demand->dst, traceStep, file.c_str(), nodeNum);
+        if (demand != first && (demand->src < demand[-1].src ||
+                                (demand->src == demand[-1].src && demand->dst <= demand[-1].dst)))
+            throw cRuntimeError("Demands of step %d in traffic trace '%s' are not sorted by source and destination, "
+                                "write the trace with utils/traffic_trace.py",
+                                traceStep, file.c_str());
+    }
+    checkedSteps[traceStep] = true;
+}
+
+/**
+ * @brief Ask the kernel to read the pages of a trace step in advance, so that the step boundary does not wait for the disk
+ *
+ * @param traceStep Trace step to prefetch
+ */
+void RlTrafficTrace::prefetchStep(int traceStep)
+{
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t begin = stepOffset[traceStep] / pageSize * pageSize;
+    size_t end = stepOffset[traceStep + 1];
+    if (end > begin)
+        madvise((void *)(mapping + begin), end - begin, MADV_WILLNEED);
+}
+
+/**
+ * @brief Get the demands of a source during a simulation step, the step after it is prefetched
+ *
+ * @param step  Simulation step number
+ * @param src   ID of the source host
+ * @return pair<const RlTraceDemand *, const RlTraceDemand *> Demands of the source, sorted by destination
+ */
+pair<const RlTraceDemand *, const RlTraceDemand *> RlTrafficTrace::getDemands(int step, int src)
+{
+    int traceStep = (startStep + step) % stepNum;
+    if (prefetchedStep != traceStep) {
+        prefetchStep((traceStep + 1) % stepNum);
+        prefetchedStep = traceStep;
+    }
+    if (!checkedSteps[traceStep])
+        checkStep(traceStep);
+    const RlTraceDemand *first = (const RlTraceDemand *)(mapping + stepOffset[traceStep]);
+    const RlTraceDemand *last = (const RlTraceDemand *)(mapping + stepOffset[traceStep + 1]);
+    auto bySrc = [](const RlTraceDemand &demand, int node) { return demand.src < node; };
+    first = lower_bound(first, last, src, bySrc);
+    last = lower_bound(first, last, src + 1, bySrc);
+    return make_pair(first, last);
+}
@@ -0,0 +1,88 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 16:48:12
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 16:48:12
+ * @FilePath     : /root/RouterRL/modules/udpapp/RlTrafficTrace.h
+ * @Description  : Memory-mapped traffic matrix trace replayed by RlUdpApp in RouterRL.
+ */
+#ifndef RLTRAFFICTRACE_H
+#define RLTRAFFICTRACE_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+#define RL_TRACE_MAGIC   0x54544c52 // "RLTT"
+#define RL_TRACE_VERSION 1
+
+/**
+ * Binary trace layout (little-endian), written by utils/traffic_trace.py:
+ *   RlTraceHeader                  magic, version, nodeNum, stepNum
+ *   uint64_t stepOffset[stepNum+1] byte offset of the first demand of each step, the last one is the end of the file
+ *   RlTraceDemand demands[]        demands of each step, sorted by source and then by destination
+ */
+struct RlTraceHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeNum;
+    uint32_t stepNum;
+};
+
+struct RlTraceDemand {
+    uint16_t src;
+    uint16_t dst;
+    float rate; // Offered load of the OD pair during the step, in Mbits/s
+};
+
+/**
+ * The trace is mapped with mmap and never parsed: the demands of a source in a step are found by a binary search in
+ * the step, and only the pages of the steps that are replayed are read from the disk. The order of the demands of a
+ * step, which the binary search relies on, is checked the first time the step is replayed. The simulation step s replays
+ * the trace step (startStep + s) modulo the number of steps of the trace.
+ * There is only a single global static object, shared by the applications of all hosts.
+ */
+class RlTrafficTrace
+{
+public:
+    static RlTrafficTrace *getInstance();
+
+    /**
+     * Used to initialize the unique static instance, maps the trace file and checks its header and step index.
+     */
+    static RlTrafficTrace *openTrace(string file_v, int nodeNum_v, int startStep_v);
+
+    /**
+     * Demands of a source during a simulation step, as a range [first, second) inside the mapping.
+     */
+    pair<const RlTraceDemand *, const RlTraceDemand *> getDemands(int step, int src);
+    int getStepNum() const { return stepNum; }
+
+    ~RlTrafficTrace();
+    RlTrafficTrace(const RlTrafficTrace &) = delete;
+    RlTrafficTrace &operator=(const RlTrafficTrace &) = delete;
+
+protected:
+    RlTrafficTrace(string file_v, int nodeNum_v, int startStep_v);
+    void mapFile();
+    void prefetchStep(int traceStep);
+    void checkStep(int traceStep);
+
+    string file;
+    int nodeNum;
+    int startStep;
+    int stepNum = 0;
+    int prefetchedStep = -1;          // Last trace step whose pages were requested in advance
+    vector<bool> checkedSteps;        // Trace steps whose demands are known to be sorted
+    const char *mapping = nullptr;    // Whole file, read-only
+    size_t mappingSize = 0;
+    const uint64_t *stepOffset = nullptr;
+
+private:
+    static RlTrafficTrace *trafficTrace;
+};
+
+#endif // RLTRAFFICTRACE_H
@@ -12,10 +12,19 @@
 #include "inet/common/TimeTag_m.h"
 #include "inet/networklayer/common/FragmentationTag_m.h"
 #include "inet/networklayer/common/L3AddressResolver.h"
+#include "inet/networklayer/common/NetworkInterface.h"
+#include "inet/networklayer/contract/IInterfaceTable.h"
 #include "inet/networklayer/ipv4/RlConventionalRoutingTable.h"
 #include "inet/networklayer/ipv4/RlProbabilisticRoutingTable.h"
 #include "inet/networklayer/ipv4/RlMultipathRoutingTable.h"
 #include "inet/networklayer/ipv4/RlPathRoutingTable.h"
+#include "inet/networklayer/ipv4/RlWeightedShortestPathRoutingTable.h"
+#include "inet/networklayer/ipv4/RlEcmpRoutingTable.h"
+
+#define TRAIN_MAX_BYTES         65000 // Largest train payload, the IPv4 total length is 16 bits
+#define TRAIN_HEADER_BYTES      28    // IPv4 and UDP headers of a train, which must fit in the MTU with its payload
+#define TRAIN_MIN_PER_STEP      10    // Trains sent by an OD pair at the mean load in a step, at least
+#define TRAIN_EVENTS_PER_PACKET 30    // Estimated events of a packet end to end, until the first step is measured
 
 namespace inet
 {
@@ -25,6 +34,7 @@ Define_Module(RlUdpApp);
 RlUdpApp::~RlUdpApp()
 {
     cancelAndDelete(selfMsg);
+    cancelAndDelete(stepMsg);
 }
 
 /**
@@ -63,11 +73,36 @@ void RlUdpApp::initialize(int stage)
         }
         routingMode = par("routingMode").stringValue();
         topoTable = par("topoTable");
+        candidatePathNum = par("candidatePathNum");
+        reprogramRoutes = par("reprogramRoutes");
+        flowsPerPair = par("flowsPerPair");
+        trafficModel = par("trafficModel").stringValue();
+        senderNode = atoi(getParentModule()->getFullName() + 2);
+        destAddrs.assign(nodeNum, L3Address());
+        if (trafficModel == "trace")
+            trafficTrace = RlTrafficTrace::openTrace(par("trafficTraceFile").stringValue(), nodeNum,
+                                                     par("trafficTraceStartStep"));
+        else if (!trafficModel.empty())
+            trafficMatrix = RlTrafficMatrix::initMatrix(nodeNum, trafficModel, flowRate,
+                                                        par("trafficMatrixFile").stringValue(),
+                                                        par("trafficDensity"), par("trafficSeed"));
+        simMode = par("simMode").stringValue();
+        stepTraffic = !trafficModel.empty() || simMode == "hybrid";
+        if (stepTraffic) {
+            odInterval.assign(nodeNum, 0);
+            odPacketNum.assign(nodeNum, 0);
+        }
+
+        // Packet trains: one simulated packet stands for trainLength packets to cut the number of events at high load,
+        // they are sized once the MTUs of the interfaces are known
+        trainLength = par("trainLength");
+        eventBudget = par("eventBudget");
 
         unordered_map<string, function<void()>> initFunctions = {
             {"convention",
              [&]() {
-                 RlConventionalRoutingTable::initTable(nodeNum, zmqPort, overTime, totalStep);
+                 RlConventionalRoutingTable::initTable(nodeNum, zmqPort, overTime, totalStep,
+                                                       reprogramRoutes);
              }},
             {"probabilistic",
              [&]() {
@@ -77,12 +112,25 @@ void RlUdpApp::initialize(int stage)
             {"multipath",
              [&]() {
                  RlMultipathRoutingTable::initTable(nodeNum, topoTable, initRoutingTable, zmqPort,
-                                                    overTime, totalStep, returnModeId);
+                                                    overTime, totalStep, returnModeId,
+                                                    candidatePathNum);
              }},
             {"singlepath",
              [&]() {
                  RlPathRoutingTable::initTable(nodeNum, topoTable, initRoutingTable, zmqPort,
-                                               overTime, totalStep, returnModeId);
+                                               overTime, totalStep, returnModeId,
+                                               candidatePathNum);
+             }},
+            {"weighted",
+             [&]() {
+                 RlWeightedShortestPathRoutingTable::initTable(nodeNum, topoTable, initRoutingTable,
+                                                               zmqPort, overTime, totalStep,
+                                                               returnModeId);
+             }},
+            {"ecmp",
+             [&]() {
+                 RlEcmpRoutingTable::initTable(nodeNum, topoTable, zmqPort, overTime, totalStep,
+                                               returnModeId);
              }},
         };
 
@@ -105,13 +153,87 @@ void RlUdpApp::initialize(int stage)
              []() {
                  return static_cast<RlBasicRoutingTable *>(RlPathRoutingTable::getInstance());
              }},
+            {"weighted",
+             []() {
+                 return static_cast<RlBasicRoutingTable *>(
+                     RlWeightedShortestPathRoutingTable::getInstance());
+             }},
+            {"ecmp",
+             []() { return static_cast<RlBasicRoutingTable *>(RlEcmpRoutingTable::getInstance()); }},
         };
 
+        // Log of the simulator side, shared by all hosts
+        const char *logFile = par("logFile");
+        if (logFile[0] || par("logConsole").boolValue())
+            RlLogger::initLogger(logFile, RlLogger::parseLevel(par("logLevel")), par("logConsole").boolValue());
+
+        // Wall-clock breakdown of every step, shared by all hosts
+        const char *profileFile = par("profileFile");
+        if (profileFile[0])
+            RlStepProfiler::initProfiler(profileFile);
+        // Timeline of the step lifecycle, shared by all hosts
+        const char *traceFile = par("traceFile");
+        if (traceFile[0])
+            RlTracer::initTracer(traceFile, par("tracePacketSampleRate").doubleValue());
+        // Replies of the agent recorded, or replayed without the agent, before the routing table connects to it
+        const char *actionTraceFile = par("actionTraceFile");
+        if (actionTraceFile[0]) {
+            string actionTraceMode = par("actionTraceMode").stringValue();
+            string actionTraceCheck = par("actionTraceCheck").stringValue();
+            unordered_map<string, int> traceModes = {{"record", ACTION_TRACE_RECORD}, {"replay", ACTION_TRACE_REPLAY}};
+            unordered_map<string, int> traceChecks = {
+                {"none", ACTION_CHECK_NONE}, {"warn", ACTION_CHECK_WARN}, {"error", ACTION_CHECK_ERROR}};
+            if (!traceModes.count(actionTraceMode) || !traceChecks.count(actionTraceCheck))
+                throw cRuntimeError("Invalid actionTraceMode '%s' or actionTraceCheck '%s'", actionTraceMode.c_str(),
+                                    actionTraceCheck.c_str());
+            RlActionTrace::initTrace(actionTraceFile, traceModes[actionTraceMode], traceChecks[actionTraceCheck],
+                                     nodeNum);
+        }
+
         if (initFunctions.count(routingMode)) {
             initFunctions[routingMode]();
             routingTable = getInstanceFunctions[routingMode]();
         }
 
+        // Per-step results for offline analysis and transitions for offline RL, shared by all hosts
+        const char *resultsFile = par("resultsFile");
+        const char *datasetFile = par("datasetFile");
+        if ((resultsFile[0] || datasetFile[0]) && routingTable) {
+            int statScope = RESULTS_GLOBAL;
+            if (returnModeId == 1)
+                statScope = (routingMode == "singlepath" || routingMode == "multipath") ? RESULTS_OD : RESULTS_NODE;
+            if (resultsFile[0])
+                RlResultsWriter::initWriter(resultsFile, par("resultsGroupSteps"), nodeNum, routingTable->topo,
+                                            statScope);
+            if (datasetFile[0])
+                RlDatasetWriter::initWriter(datasetFile, nodeNum, routingTable->topo, statScope, totalStep);
+        }
+
+        if (simMode == "fluid" || simMode == "hybrid") {
+            int timeToLive = par("timeToLive");
+            RlFluidModel *model = RlFluidModel::initModel(
+                routingTable, getSimulation()->getSystemModule(), nodeNum, messageLength,
+                par("fluidQueueModel").stringValue(), par("fluidQueueCapacity"), flowsPerPair,
+                timeToLive == -1 ? 32 : timeToLive);
+            if (simMode == "fluid")
+                fluidModel = model;
+            else
+                backgroundModel = model;
+        } else if (simMode != "packet") {
+            throw cRuntimeError("Unknown simMode '%s'", simMode.c_str());
+        }
+        if (backgroundModel) {
+            // Either the listed OD pairs are all sent as packets, or a sample of the packets of every pair
+            parseHybridPairs(par("hybridPairs"));
+            if (!hybridPairs) {
+                double sampleRate = par("hybridSampleRate");
+                if (sampleRate <= 0 || sampleRate > 1)
+                    throw cRuntimeError("Invalid hybridSampleRate %g, it must be in (0, 1]",
+                                        sampleRate);
+                sampleWeight = max(1, (int)lround(1 / sampleRate));
+            }
+        }
+
         localPort = par("localPort");
         destPort = par("destPort");
         startTime = par("startTime");
@@ -121,33 +243,54 @@ void RlUdpApp::initialize(int stage)
             throw cRuntimeError("Invalid startTime/stopTime parameters");
         selfMsg = new cMessage("sendTimer");
         overtimeSelfMsg = new cMessage("overtime");
-        randDst = getDstNode();
+        stepMsg = new cMessage("stepTimer");
+    } else if (stage == INITSTAGE_APPLICATION_LAYER) {
+        sizeTrains();
     }
 }
 
 /**
-     * @brief Randomly gets the destination node for packet transmission, called before sending the packet
+     * @brief Bound the packet trains by the smallest MTU of the network, since fragments do not carry the parameters of
+     * the train, and choose their length from the offered load with eventBudget
      *
-     * @return int ID of the destination node
      */
-int RlUdpApp::getDstNode()
+void RlUdpApp::sizeTrains()
 {
-    // Get the current time in microseconds
-    auto now = std::chrono::system_clock::now();
-    auto now_us = std::chrono::time_point_cast<std::chrono::microseconds>(now);
-    auto value = now_us.time_since_epoch();
-    long micros = value.count();
-    // Use the microsecond value as the random seed
-    std::mt19937 gen(micros);
-    // Get the current node, i.e., the source node
-    string sender = getParentModule()->getFullName();
-    int senderNode = atoi(sender.c_str() + 2);
-    int dst = senderNode;
-    while (dst == senderNode) {
-        std::uniform_int_distribution<int> dist(0, nodeNum - 1);
-        dst = dist(gen);
+    int mtu = getNetworkMtu();
+    int mtuTrainLength = max(1, min(TRAIN_MAX_BYTES, mtu - TRAIN_HEADER_BYTES) / messageLength);
+    maxTrainLength =
+        max(1, min(mtuTrainLength, (int)(stepTime / (TRAIN_MIN_PER_STEP * sendInterval))));
+    if (trainLength < 1 || trainLength > mtuTrainLength)
+        throw cRuntimeError("Invalid trainLength %d, it must be in [1, %d] for the smallest interface mtu of %dB",
+                            trainLength, mtuTrainLength, mtu);
+    if (eventBudget > 0) {
+        // Offered packets per second of the whole network, the traffic matrices have the same total load
+        double packetRate = nodeNum * (nodeNum - 1) / sendInterval;
+        trainLength = min(maxTrainLength,
+                          max(1, (int)ceil(packetRate * TRAIN_EVENTS_PER_PACKET / eventBudget)));
     }
-    return dst;
+}
+
+/**
+     * @brief Get the smallest MTU of the interfaces of the network, loopbacks excluded, which bounds the packets that
+     * cross it without fragmentation
+     *
+     * @return int Smallest MTU in bytes, INT_MAX if no interface is found
+     */
+int RlUdpApp::getNetworkMtu()
+{
+    int mtu = INT_MAX;
+    for (cModule::SubmoduleIterator it(getSimulation()->getSystemModule()); !it.end(); ++it) {
+        IInterfaceTable *interfaceTable = dynamic_cast<IInterfaceTable *>((*it)->getSubmodule("interfaceTable"));
+        if (!interfaceTable)
+            continue;
+        for (int i = 0; i < interfaceTable->getNumInterfaces(); i++) {
+            NetworkInterface *networkInterface = interfaceTable->getInterface(i);
+            if (!networkInterface->isLoopback() && networkInterface->getMtu() > 0)
+                mtu = min(mtu, networkInterface->getMtu());
+        }
+    }
+    return mtu;
 }
 
 /**
@@ -207,43 +350,58 @@ void RlUdpApp::setSocketOptions()
      */
 void RlUdpApp::sendPacket()
 {
-    string sender = getParentModule()->getFullName(); // Current node, i.e., the source node
-    int senderNode = atoi(sender.c_str() + 2);
-
     for (int dst = 0; dst < nodeNum; dst++) {
         if (dst == senderNode)
             continue;
-
-        string destName = "H[" + to_string(dst) + "]";
-        int sendId = routingTable->getSendId();
-        string pkName = routingMode + par("returnMode").stringValue();
-        Packet *packet = new Packet(pkName.c_str());
-        // Variables carried by the packet include the step, packet ID, source node, and destination node
-        packet->addPar("step").setLongValue(stepNum);
-        packet->addPar("src").setStringValue(sender.c_str());
-        packet->addPar("dst").setStringValue(destName.c_str());
-        packet->addPar("id").setLongValue(sendId);
-        sendPacketId++;
-
-        if (dontFragment)
-            packet->addTag<FragmentationReq>()->setDontFragment(true);
-        const auto &payload = makeShared<ApplicationPacket>();
-
-        payload->setChunkLength(B((int)messageLength));
-        payload->setSequenceNumber(numSent);
-        payload->addTag<CreationTimeTag>()->setCreationTime(simTime());
-        packet->insertAtBack(payload);
-
-        L3Address destAddr;
-        const char *dn = destName.c_str();
-        cStringTokenizer tokenizer(dn);
-        const char *token = tokenizer.nextToken();
-        L3AddressResolver().tryResolve(token, destAddr);
-        emit(packetSentSignal, packet);
-
-        socket.sendTo(packet, destAddr, destPort); // Send packet via socket
-        numSent++;
+        sendPacketTo(dst, flowRound % flowsPerPair);
     }
+    flowRound++;
+}
+
+/**
+     * @brief Sends a packet to the host of a destination node
+     *
+     * @param dst       ID of the destination node
+     * @param flowId    ID of the flow of the packet between this node and the destination
+     */
+void RlUdpApp::sendPacketTo(int dst, int flowId)
+{
+    string sender = getParentModule()->getFullName(); // Current node, i.e., the source node
+    string destName = "H[" + to_string(dst) + "]";
+    int sendId = routingTable->getSendId();
+    string pkName = routingMode + par("returnMode").stringValue();
+    Packet *packet = new Packet(pkName.c_str());
+    // Variables carried by the packet include the step, packet ID, source node, and destination node
+    packet->addPar("step").setLongValue(stepNum);
+    packet->addPar("src").setStringValue(sender.c_str());
+    packet->addPar("dst").setStringValue(destName.c_str());
+    packet->addPar("id").setLongValue(sendId);
+    if (flowsPerPair > 1)
+        packet->addPar("flow").setLongValue(flowId);
+    // A train is accounted by the routing table as the trainLength packets it stands for, and a sampled packet of the
+    // hybrid mode as the sampleWeight packets of the full load
+    int weight = trainLength * sampleWeight;
+    if (weight > 1)
+        packet->addPar("weight").setLongValue(weight);
+    sendPacketId += weight;
+
+    if (dontFragment)
+        packet->addTag<FragmentationReq>()->setDontFragment(true);
+    const auto &payload = makeShared<ApplicationPacket>();
+
+    payload->setChunkLength(B((int)messageLength * trainLength));
+    payload->setSequenceNumber(numSent);
+    payload->addTag<CreationTimeTag>()->setCreationTime(simTime());
+    packet->insertAtBack(payload);
+
+    // Host addresses do not change during the simulation, so each one is resolved only once
+    L3Address &destAddr = destAddrs[dst];
+    if (destAddr.isUnspecified())
+        L3AddressResolver().tryResolve(destName.c_str(), destAddr);
+    emit(packetSentSignal, packet);
+
+    socket.sendTo(packet, destAddr, destPort); // Send packet via socket
+    numSent++;
 }
 
 /**
@@ -256,7 +414,18 @@ void RlUdpApp::processStart()
     const char *localAddress = par("localAddress");
     socket.bind(*localAddress ? L3AddressResolver().resolve(localAddress) : L3Address(), localPort);
     setSocketOptions();
+    stepStartEvent = getSimulation()->getEventNumber();
 
+    if (fluidModel) {
+        timerStep = simTime();
+        startFluidStep();
+        return;
+    }
+    if (stepTraffic) {
+        timerStep = simTime();
+        startStepTraffic();
+        return;
+    }
     selfMsg->setKind(SEND);
     processSend();
 }
@@ -277,9 +446,15 @@ void RlUdpApp::processSend()
         simtime_t timeC = simTime() - timerStep;
         if (timeC > stepTime) {
             routingTable->recordPktNum(sendPacketId, stepNum);
+            traceStepEnd();
             routingTable->countNodeEndInStep(stepNum, simTime().dbl());
-            routingTable->updateRoutingTable(stepNum, timeC.dbl());
+            {
+                RlProfileScope scope(PROFILE_MESSAGES);
+                RlTraceScope trace("updateRoutingTable", stepNum);
+                routingTable->updateRoutingTable(stepNum, timeC.dbl());
+            }
             timerStep = simTime();
+            adaptTrainLength(timeC.dbl());
 
             // End the current step, and send a forced end self-message after survivalTime to avoid complete packet loss
             overtimeSelfMsg->setKind(STEP_END);
@@ -291,14 +466,14 @@ void RlUdpApp::processSend()
             scheduleAt(simTime() + overTime, overtimeSelfMsg);
 
             stepNum++;
-            randDst = getDstNode();
             sendPacketId = 0;
         }
         sendPacket();
         // Based on the set traffic intensity and average packet length, get the average packet transmission interval and generate an exponential distribution packet transmission interval
         cMersenneTwister *mt;
         // Traffic generation method: bounded, uniform distribution
-        cUniform un = cUniform(mt, 0.9 * sendInterval, 1.1 * sendInterval);
+        cUniform un =
+            cUniform(mt, 0.9 * sendInterval * trainLength, 1.1 * sendInterval * trainLength);
         // cExponential ex = cExponential(mt, sendInterval);
         double interval = un.draw();
         simtime_t d = simTime() + interval;
@@ -313,6 +488,233 @@ void RlUdpApp::processSend()
     }
 }
 
+/**
+     * @brief Reads the load of every OD pair of this source for the current step from the traffic matrix or trace, gives each active pair a
+     * random first send time within its interval so that the pairs are not synchronized, and schedules the step end
+     *
+     */
+void RlUdpApp::startStepTraffic()
+{
+    if (backgroundModel)
+        startBackground();
+    vector<double> rates;
+    getStepRates(senderNode, rates);
+    sendHeap = decltype(sendHeap)();
+    for (int dst = 0; dst < nodeNum; dst++) {
+        double rate = dst == senderNode ? 0 : rates[dst];
+        if (backgroundModel && !packetPairs[senderNode * nodeNum + dst])
+            rate = 0;
+        // Based on the load of the OD pair and the packet length, get the average packet transmission interval
+        odInterval[dst] = rate > 0 ? messageLength * 8 * trainLength * sampleWeight
+                                         / (rate * 1000 * 1000)
+                                   : 0;
+        if (odInterval[dst] > 0)
+            sendHeap.push({simTime() + uniform(0, odInterval[dst]), dst});
+    }
+    cancelEvent(selfMsg);
+    if (!sendHeap.empty() && (stopTime < SIMTIME_ZERO || simTime() < stopTime)) {
+        simtime_t d = sendHeap.top().first;
+        if (stopTime < SIMTIME_ZERO || d < stopTime) {
+            selfMsg->setKind(SEND);
+            scheduleAt(d, selfMsg);
+        } else {
+            selfMsg->setKind(STOP);
+            scheduleAt(stopTime, selfMsg);
+        }
+    }
+    stepMsg->setKind(STEP_END);
+    scheduleAt(timerStep + stepTime, stepMsg);
+}
+
+/**
+     * @brief Gets the load of every OD pair of a source for the current step, from the traffic trace, the traffic matrix,
+     * or flowRate towards every other host without traffic model
+     *
+     * @param src   ID of the source host
+     * @param rates Load towards each destination (Mbits/s)
+     */
+void RlUdpApp::getStepRates(int src, vector<double> &rates)
+{
+    rates.assign(nodeNum, 0);
+    if (trafficTrace) {
+        // The demands are read in place from the mapped trace
+        auto demands = trafficTrace->getDemands(stepNum, src);
+        for (auto demand = demands.first; demand != demands.second; demand++)
+            if (demand->dst < nodeNum)
+                rates[demand->dst] = demand->rate;
+    } else if (trafficMatrix) {
+        for (int dst = 0; dst < nodeNum; dst++)
+            rates[dst] = trafficMatrix->getRate(stepNum, src, dst);
+    } else {
+        rates.assign(nodeNum, flowRate);
+    }
+    rates[src] = 0;
+}
+
+/**
+     * @brief Hands the background load of every OD pair of the current step to the fluid model, which lowers the capacity of
+     * the links before the packets of the step are sent. The last host to end the previous step does it for all hosts, once
+     * its routing update is done, so the background follows the same routing state as the packets
+     *
+     */
+void RlUdpApp::startBackground()
+{
+    if (backgroundModel->isSolved(stepNum)
+        || (stepNum > 0 && !routingTable->stepIsEnd[stepNum - 1]))
+        return;
+    vector<double> rates;
+    for (int src = 0; src < nodeNum; src++) {
+        getStepRates(src, rates);
+        for (int dst = 0; dst < nodeNum; dst++) {
+            // The OD pairs sent as packets keep in the background the share of the load they do not sample
+            double share = packetPairs[src * nodeNum + dst] ? 1 - 1.0 / sampleWeight : 1;
+            backgroundModel->addDemand(stepNum, src, dst, rates[dst] * share);
+        }
+    }
+    // Sampled packets already stand for the whole load of their pair, the listed pairs only for their own
+    backgroundModel->applyBackground(stepNum, stepTime, hybridPairs);
+}
+
+/**
+     * @brief Reads the OD pairs sent as packets in hybrid mode, all of them if none is listed
+     *
+     * @param pairs Comma-separated list of src-dst host IDs, e.g. "0-3,2-5"
+     */
+void RlUdpApp::parseHybridPairs(const char *pairs)
+{
+    packetPairs.assign(nodeNum * nodeNum, 0);
+    cStringTokenizer tokenizer(pairs, ", ");
+    while (tokenizer.hasMoreTokens()) {
+        const char *token = tokenizer.nextToken();
+        int src, dst;
+        if (sscanf(token, "%d-%d", &src, &dst) != 2 || src < 0 || src >= nodeNum || dst < 0
+            || dst >= nodeNum || src == dst)
+            throw cRuntimeError("Invalid OD pair '%s' in hybridPairs", token);
+        packetPairs[src * nodeNum + dst] = 1;
+        hybridPairs = true;
+    }
+    if (!hybridPairs)
+        packetPairs.assign(nodeNum * nodeNum, 1);
+}
+
+/**
+     * @brief Hands the load of every OD pair of this source for the current step to the fluid model and schedules the step end,
+     * no packet is sent in fluid mode
+     *
+     */
+void RlUdpApp::startFluidStep()
+{
+    vector<double> rates;
+    getStepRates(senderNode, rates);
+    for (int dst = 0; dst < nodeNum; dst++)
+        fluidModel->addDemand(stepNum, senderNode, dst, rates[dst]);
+    stepMsg->setKind(STEP_END);
+    scheduleAt(timerStep + stepTime, stepMsg);
+}
+
+/**
+     * @brief Traces the step of this host that ends now, from the start of its step timer
+     *
+     */
+void RlUdpApp::traceStepEnd()
+{
+    if (RlTracer *tracer = RlTracer::getInstance()) {
+        cModule *host = getParentModule();
+        tracer->hostStep(host->getIndex(), host->getFullName(), stepNum, timerStep.dbl(), simTime().dbl());
+    }
+}
+
+/**
+     * @brief Resizes the packet trains for the next step from the event rate measured during the step that ended. The
+     * number of events is about inversely proportional to the train length, so the length is scaled by the ratio between
+     * the measured rate and the budget
+     *
+     * @param stepDuration  Simulated duration of the step that ended
+     */
+void RlUdpApp::adaptTrainLength(double stepDuration)
+{
+    eventnumber_t eventNum = getSimulation()->getEventNumber();
+    double eventRate = (eventNum - stepStartEvent) / stepDuration;
+    stepStartEvent = eventNum;
+    if (eventBudget <= 0 || eventRate <= 0)
+        return;
+    trainLength =
+        min(maxTrainLength, max(1, (int)ceil(trainLength * eventRate / eventBudget)));
+}
+
+/**
+     * @brief Sends the packets of all OD pairs that are due, and schedules the next send of each of them
+     *
+     */
+void RlUdpApp::processMatrixSend()
+{
+    while (!sendHeap.empty() && sendHeap.top().first <= simTime()) {
+        int dst = sendHeap.top().second;
+        sendHeap.pop();
+        sendPacketTo(dst, odPacketNum[dst]++ % flowsPerPair);
+        // Traffic generation method: bounded, uniform distribution
+        double interval = uniform(0.9 * odInterval[dst], 1.1 * odInterval[dst]);
+        sendHeap.push({simTime() + interval, dst});
+    }
+    simtime_t d = sendHeap.top().first;
+    if (stopTime < SIMTIME_ZERO || d < stopTime) {
+        selfMsg->setKind(SEND);
+        scheduleAt(d, selfMsg);
+    } else {
+        selfMsg->setKind(STOP);
+        scheduleAt(stopTime, selfMsg);
+    }
+}
+
+/**
+     * @brief Ends the current step when sending with a traffic matrix. Nodes without traffic also reach the step end, so
+     * the routing table still sees every node at every step
+     *
+     */
+void RlUdpApp::processStepEnd()
+{
+    simtime_t timeC = simTime() - timerStep;
+    // The first host to end the step solves it for all hosts, under the routing state of the step
+    if (fluidModel)
+        fluidModel->evaluate(stepNum, timeC.dbl());
+    routingTable->recordPktNum(sendPacketId, stepNum);
+    traceStepEnd();
+    routingTable->countNodeEndInStep(stepNum, simTime().dbl());
+    {
+        RlProfileScope scope(PROFILE_MESSAGES);
+        RlTraceScope trace("updateRoutingTable", stepNum);
+        routingTable->updateRoutingTable(stepNum, timeC.dbl());
+    }
+    timerStep = simTime();
+    adaptTrainLength(timeC.dbl());
+
+    if (fluidModel) {
+        // The reward follows the state of the step at once, as all packets of a fluid step are already accounted
+        if (routingTable->updateNodeCount[stepNum] == nodeNum && !routingTable->stepFinished[stepNum])
+            routingTable->finishStep(stepNum);
+        stepNum++;
+        if (stepNum < totalStep)
+            startFluidStep();
+        return;
+    }
+
+    // End the current step, and send a forced end self-message after survivalTime to avoid complete packet loss
+    overtimeSelfMsg->setKind(STEP_END);
+    if (overtimeSelfMsg->hasPar("step")) {
+        overtimeSelfMsg->par("step").setLongValue(stepNum);
+    } else {
+        overtimeSelfMsg->addPar("step").setLongValue(stepNum);
+    }
+    scheduleAt(simTime() + overTime, overtimeSelfMsg);
+
+    stepNum++;
+    sendPacketId = 0;
+    if (stepNum < totalStep)
+        startStepTraffic();
+    else
+        cancelEvent(selfMsg);
+}
+
 /**
      * @brief Stops the probabilistic routing application process
      *
@@ -330,15 +732,20 @@ void RlUdpApp::processStop()
 void RlUdpApp::handleMessageWhenUp(cMessage *msg)
 {
     if (msg->isSelfMessage()) {
-        ASSERT(msg == selfMsg || msg == overtimeSelfMsg);
-        if (msg == selfMsg) {
+        ASSERT(msg == selfMsg || msg == overtimeSelfMsg || msg == stepMsg);
+        if (msg == stepMsg) {
+            processStepEnd();
+        } else if (msg == selfMsg) {
             switch (selfMsg->getKind()) {
                 case START:
                     processStart();
                     break;
 
                 case SEND:
-                    processSend();
+                    if (stepTraffic)
+                        processMatrixSend();
+                    else
+                        processSend();
                     break;
 
                 case STOP:
@@ -428,6 +835,10 @@ void RlUdpApp::processPacket(Packet *pk)
 {
     emit(packetReceivedSignal, pk);
     routingTable->countPktDelay(pk, (simTime() - pk->getCreationTime()).dbl());
+    RlTracer *tracer = RlTracer::getInstance();
+    if (tracer && tracer->samplePacket(pk->getId()))
+        tracer->packetLife(pk->getId(), pk->getName(), pk->par("src").stringValue(), pk->par("dst").stringValue(),
+                           pk->par("step").longValue(), pk->getCreationTime().dbl(), simTime().dbl());
     routingTable->stepOverJudge(pk->par("step").longValue(), simTime().dbl());
     numReceived++;
     delete pk;
@@ -457,6 +868,7 @@ void RlUdpApp::handleStopOperation(LifecycleOperation *operation)
 {
     cancelEvent(selfMsg);
     cancelEvent(overtimeSelfMsg);
+    cancelEvent(stepMsg);
     socket.close();
     delayActiveOperationFinish(par("stopOperationTimeout"));
 }
@@ -470,6 +882,7 @@ void RlUdpApp::handleCrashOperation(LifecycleOperation *operation)
 {
     cancelEvent(selfMsg);
     cancelEvent(overtimeSelfMsg);
+    cancelEvent(stepMsg);
     socket.destroy();
 }
 
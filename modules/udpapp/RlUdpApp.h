@@ -8,11 +8,15 @@
  */
 #ifndef __INET_RlUdpApp_H
 #define __INET_RlUdpApp_H
+#include <queue>
 #include <string>
 #include "inet/common/INETDefs.h"
 #include "inet/applications/base/ApplicationBase.h"
 #include "inet/transportlayer/contract/udp/UdpSocket.h"
 #include "inet/networklayer/ipv4/RlBasicRoutingTable.h"
+#include "inet/networklayer/ipv4/RlFluidModel.h"
+#include "inet/applications/udpapp/RlTrafficMatrix.h"
+#include "inet/applications/udpapp/RlTrafficTrace.h"
 
 using namespace std;
 
@@ -49,12 +53,43 @@ protected:
     double overTime;              // Timeout
     int returnModeId;             // Simulation mode
     string routingMode;           // Routing mode
-    int randDst;                  // Randomly selected destination node
+    int candidatePathNum;         // Candidate paths of each OD pair in the path catalog
+    bool reprogramRoutes;         // Whether conventional routes are reprogrammed with link weights of the agent
+    int flowsPerPair;             // Number of flows between each OD pair, packets are assigned to them in turn
+    long flowRound = 0;           // Number of sending rounds, used to assign packets to flows
+    int senderNode;               // ID of this host
+    int trainLength = 1;          // Packets carried by each simulated packet train, whose length and weight are scaled
+    int maxTrainLength = 1;       // Longest train, bounded by the smallest MTU and by the trains of a pair in a step
+    double eventBudget = 0;       // Events per simulated second the trains are sized for, 0: fixed trainLength
+    eventnumber_t stepStartEvent = 0; // Event number at the start of the current step, used to measure the event rate
     RlBasicRoutingTable *routingTable;
+    vector<L3Address> destAddrs;  // Resolved address of each host, unspecified until the first packet to it
+
+    // traffic matrix: every active OD pair of this source sends at its own rate, its next send time is kept in a heap
+    string trafficModel;          // Empty: one packet to every other host per tick at flowRate
+    bool stepTraffic = false;     // Whether the OD pairs are sent from sendHeap, with a traffic model or in hybrid mode
+    RlTrafficMatrix *trafficMatrix = nullptr;
+    RlTrafficTrace *trafficTrace = nullptr; // Used instead of trafficMatrix by the trace model
+    vector<double> odInterval;    // Mean sending interval towards each destination in the current step, 0 if inactive
+    vector<long> odPacketNum;     // Packets sent towards each destination, used to assign packets to flows
+    priority_queue<pair<simtime_t, int>, vector<pair<simtime_t, int>>,
+                   greater<pair<simtime_t, int>>>
+        sendHeap;                 // (next send time, destination) of the active OD pairs
+
+    // fluid mode: no packets are sent, the fluid model solves each step from the demands of all hosts
+    string simMode;               // packet, fluid or hybrid
+    RlFluidModel *fluidModel = nullptr;
+
+    // hybrid mode: the fluid model carries the background load and the packets see the rest of the link capacity
+    RlFluidModel *backgroundModel = nullptr;
+    int sampleWeight = 1;         // Packets of the full load stood for by each sampled packet
+    bool hybridPairs = false;     // Whether only the OD pairs of interest are sent as packets, instead of a sample of all
+    vector<char> packetPairs;     // Whether the OD pair src * nodeNum + dst is sent as packets
 
     UdpSocket socket;
     cMessage *selfMsg = nullptr;
     cMessage *overtimeSelfMsg = nullptr;
+    cMessage *stepMsg = nullptr;
 
     // statistics
     int numSent = 0;     // Number of packets sent
@@ -67,14 +102,26 @@ protected:
     virtual void finish() override;
     virtual void refreshDisplay() const override;
 
-    // chooses random destination address
+    // sends one packet to every other host
     virtual void sendPacket();
+    virtual void sendPacketTo(int dst, int flowId);
     virtual void processPacket(Packet *msg);
     virtual void setSocketOptions();
 
     virtual void processStart();
     virtual void processSend();
     virtual void processStop();
+    virtual void processMatrixSend();
+    virtual void processStepEnd();
+    virtual void startStepTraffic();
+    virtual void startFluidStep();
+    virtual void getStepRates(int src, vector<double> &rates);
+    virtual void startBackground();
+    virtual void parseHybridPairs(const char *pairs);
+    virtual void sizeTrains();
+    virtual int getNetworkMtu();
+    virtual void adaptTrainLength(double stepDuration);
+    virtual void traceStepEnd();
 
     virtual void handleStartOperation(LifecycleOperation *operation) override;
     virtual void handleStopOperation(LifecycleOperation *operation) override;
@@ -84,8 +131,6 @@ protected:
     virtual void socketErrorArrived(UdpSocket *socket, Indication *indication) override;
     virtual void socketClosed(UdpSocket *socket) override;
 
-    int getDstNode();
-
 public:
     RlUdpApp() {}
     ~RlUdpApp();
@@ -14,7 +14,7 @@ import re
 import sys
 import time
 from argparse import Namespace
-from router_rl.multipath_env import MultipathEnv
+from router_rl.ecmp_env import EcmpEnv
 
 sys.path.append("src")
 from convention.ecmp.trainer import trainer
@@ -37,6 +37,7 @@ if __name__ == "__main__":
     parser.add_argument("--flow_rate", type=float, default=defaults["flow_rate"])
     parser.add_argument("--ned_path", type=str, default=defaults["ned_path"])
     parser.add_argument("--seed", type=int, default=defaults["seed"])
+    parser.add_argument("--flows_per_pair", type=int, default=defaults["flows_per_pair"])
 
     args: Namespace = parser.parse_args()
 
@@ -63,7 +64,7 @@ if __name__ == "__main__":
     network_log_path = (
         f"logs/inet/{args.algorithm}-fr{args.flow_rate}-{args.topology}-{date}-{now_time}"
     )
-    env = MultipathEnv(
+    env = EcmpEnv(
         network=args.topology,
         flow_rate=args.flow_rate,
         total_step=args.max_ep_steps,
@@ -72,6 +73,7 @@ if __name__ == "__main__":
         seed=args.seed,
         ned_path=args.ned_path,
         log_path=network_log_path,
+        flows_per_pair=args.flows_per_pair,
     )
     trainer(env, args.max_ep_steps)
     if env:
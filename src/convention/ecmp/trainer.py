@@ -11,13 +11,13 @@ import sys
 from rich.console import Console
 
 sys.path.append(".")
-from modules.router_rl.multipath_env import MultipathEnv
+from modules.router_rl.ecmp_env import EcmpEnv
 
 console = Console()
 
 
 def trainer(
-    env: MultipathEnv,
+    env: EcmpEnv,
     max_ep_steps: int,
     cold_start_steps: int = 20,
 ) -> None:
@@ -36,7 +36,7 @@ def trainer(
         s_or_r, step, msg = env.get_obs()
 
         if s_or_r == "s":
-            env.make_action(env.routing_table)
+            env.make_action("get state")
         else:
             if step < cold_start_steps:
                 env.reward_rcvd()
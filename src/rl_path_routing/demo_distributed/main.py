@@ -36,6 +36,7 @@ if __name__ == "__main__":
     parser.add_argument("--flow_rate", type=float, default=defaults["flow_rate"])
     parser.add_argument("--ned_path", type=str, default=defaults["ned_path"])
     parser.add_argument("--seed", type=int, default=defaults["seed"])
+    parser.add_argument("--candidate_path_num", type=int, default=defaults["candidate_path_num"])
 
     args: Namespace = parser.parse_args()
 
@@ -71,6 +72,7 @@ if __name__ == "__main__":
         seed=args.seed,
         ned_path=args.ned_path,
         log_path=network_log_path,
+        candidate_path_num=args.candidate_path_num,
     )
     trainer(env, args.max_ep_steps)
     if env:
@@ -0,0 +1,64 @@
+"""
+Author       : LIN Guocheng
+Date         : 2026-10-18 12:05:31
+LastEditors  : LIN Guocheng
+LastEditTime : 2026-10-18 12:05:31
+FilePath     : /root/RouterRL/rl-weighted-routing/src/demo_distributed/trainer.py
+Description  : Realization the training process of weighted shortest path routing in RouterRL.
+"""
+
+import sys
+from rich.console import Console
+
+sys.path.append(".")
+from modules.router_rl.weighted_env import WeightedEnv
+
+console = Console()
+
+
+def trainer(
+    env: WeightedEnv,
+    max_ep_steps: int,
+    cold_start_steps: int = 20,
+) -> None:
+    """Start weighted shortest path routing in RouterRL.
+
+    Args:
+        env (OmnetEnv): Simulator instance.
+        max_ep_steps (int): Max number of steps to simulate.
+        cold_start_steps (int, optional): Step number for cold starting. Defaults to 20.
+    """
+    env.reset()
+    step_count = 0
+    average_delay = 0
+    average_loss_rate = 0
+    while step_count < max_ep_steps:
+        s_or_r, step, msg = env.get_obs()
+
+        if s_or_r == "s":
+            env.make_action(str(env.routing_table))
+        else:
+            if step < cold_start_steps:
+                env.reward_rcvd()
+                continue
+
+            reward_msgs = msg.split("/")
+            global_delay, global_loss_rate = map(float, reward_msgs[-1].split(","))
+            console.rule(
+                f"Step: {step_count}, Delay: {global_delay} s, Loss Rate: {global_loss_rate}"
+            )
+            for index in range(env.node_num):
+                delay, loss_rate = map(float, reward_msgs[index].split(","))
+                console.log(f"Node: {index}: \tDelay: {delay} s\t Loss Rate: {loss_rate}")
+            average_delay += global_delay
+            average_loss_rate += global_loss_rate
+            step_count += 1
+            env.reward_rcvd()
+
+    average_delay /= step_count
+    average_loss_rate /= step_count
+    console.rule(
+        f"Average Delay: {round(average_delay*1000,4)} ms\t Loss Rate: {round(average_loss_rate*100, 4)} %"
+    )
+    if env:
+        env.close()
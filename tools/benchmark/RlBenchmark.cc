@@ -0,0 +1,518 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 19:48:26
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 19:48:26
+ * @FilePath     : /root/RouterRL/tools/benchmark/RlBenchmark.cc
+ * @Description  : Microbenchmarks of the hot paths of the routing tables of RouterRL, without simulation.
+ */
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <queue>
+#include <regex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "RlEcmpRoutingTable.h"
+#include "RlMultipathRoutingTable.h"
+#include "RlPathRoutingTable.h"
+#include "RlProbabilisticRoutingTable.h"
+#include "RlWeightedShortestPathRoutingTable.h"
+
+using namespace std;
+
+#define BENCH_STEPS        2     // Steps allocated by each table, the benchmarks only use step 0
+#define BENCH_PACKET_BITS  8000  // Bit length of the packets, 1000 bytes as sent by RlUdpApp
+#define BENCH_PACKET_POOL  4096  // Packets counted in a step by the countPktDelay and endStep benchmarks
+#define BENCH_CLEAR_PERIOD 65536 // Packets routed between two clearPkts calls, so that link counters do not overflow
+#define BENCH_CANDIDATES   4     // Candidate paths of each OD pair in catalog mode
+
+/**
+ * Network read from a NED file, with the initial routing tables given to the tables in the format of the Python envs:
+ * adjacency matrix for topoTable, and the shortest path of every OD pair for the tables that route by path.
+ */
+struct Topology {
+    string name;
+    int nodeNum = 0;
+    vector<int> adjacency;       // Row-major, 1 for a link between routers
+    vector<vector<int>> paths;   // Shortest path of each OD pair at paths[src * nodeNum + dst], BFS order of neighbors
+    vector<pair<int, int>> pairs; // OD pairs with a path
+    string topoTable;            // 0,1,1,0,...
+    string pathTable;            // src,dst,path;...
+    string multipathTable;       // src,dst,path,ratio;... two halves of the same path so the roulette wheel is used
+    int linkNum = 0;             // Directed links
+};
+
+/**
+ * @brief Read the routers and the links between them from a NED file, as the Python envs do
+ *
+ * @param nedFile   NED file of the network
+ * @param name      Network name
+ * @return Topology Network with its initial routing tables
+ */
+static Topology readTopology(const string &nedFile, const string &name)
+{
+    ifstream file(nedFile);
+    if (!file)
+        throw runtime_error("Cannot open '" + nedFile + "'");
+    stringstream buffer;
+    buffer << file.rdbuf();
+    string ned = buffer.str();
+
+    Topology topology;
+    topology.name = name;
+    smatch match;
+    if (regex_search(ned, match, regex("R\\[(\\d+)\\]")))
+        topology.nodeNum = stoi(match[1]);
+    int n = topology.nodeNum;
+    topology.adjacency.assign(n * n, 0);
+    regex link("R\\[(\\d+)\\][^;\\n]*? <--> C <--> R\\[(\\d+)\\][^;\\n]*?;");
+    for (sregex_iterator it(ned.begin(), ned.end(), link), end; it != end; ++it) {
+        int i = stoi((*it)[1]), j = stoi((*it)[2]);
+        if (i < n && j < n)
+            topology.adjacency[i * n + j] = topology.adjacency[j * n + i] = 1;
+    }
+    for (int k = 0; k < n * n; k++) {
+        topology.topoTable += (k ? "," : "") + to_string(topology.adjacency[k]);
+        topology.linkNum += topology.adjacency[k];
+    }
+
+    topology.paths.resize(n * n);
+    for (int src = 0; src < n; src++) {
+        vector<int> parent(n, -1);
+        queue<int> bfsQueue;
+        parent[src] = src;
+        bfsQueue.push(src);
+        while (!bfsQueue.empty()) {
+            int node = bfsQueue.front();
+            bfsQueue.pop();
+            for (int next = 0; next < n; next++) {
+                if (topology.adjacency[node * n + next] && parent[next] == -1) {
+                    parent[next] = node;
+                    bfsQueue.push(next);
+                }
+            }
+        }
+        for (int dst = 0; dst < n; dst++) {
+            if (dst == src || parent[dst] == -1)
+                continue;
+            vector<int> &path = topology.paths[src * n + dst];
+            for (int node = dst; node != src; node = parent[node])
+                path.insert(path.begin(), node);
+            path.insert(path.begin(), src);
+
+            string nodes;
+            for (int node : path)
+                nodes += (nodes.empty() ? "" : ".") + to_string(node);
+            string od = to_string(src) + "," + to_string(dst) + "," + nodes;
+            topology.pathTable += (topology.pathTable.empty() ? "" : ";") + od;
+            topology.multipathTable += (topology.multipathTable.empty() ? "" : ";") + od + ",0.5;" + od + ",0.5";
+            topology.pairs.push_back(make_pair(src, dst));
+        }
+    }
+    return topology;
+}
+
+/**
+ * @brief Reply of the agent to the states of a table, chosen by the benchmark
+ */
+static void setReply(const string &reply)
+{
+    zmq::mockReplier() = [reply](const string &request) { return reply; };
+}
+
+/**
+ * Tables of a network, built once and shared by all benchmarks of the network. The tables are never deleted, the
+ * destructors of the subclasses also delete their static instance.
+ */
+struct Tables {
+    RlProbabilisticRoutingTable *probabilistic;
+    RlPathRoutingTable *path;
+    RlPathRoutingTable *pathCatalog;
+    RlMultipathRoutingTable *multipath;
+    RlWeightedShortestPathRoutingTable *weighted;
+    RlEcmpRoutingTable *ecmp;
+};
+
+static Tables buildTables(const Topology &topology)
+{
+    int n = topology.nodeNum;
+    setReply("catalog received");
+    Tables tables;
+    string probTable = "[" + topology.topoTable + "]";
+    tables.probabilistic = new RlProbabilisticRoutingTable();
+    tables.probabilistic->setVals(0, n, probTable.c_str(), 1.0, BENCH_STEPS, 1);
+    tables.probabilistic->initiate();
+    tables.path = new RlPathRoutingTable();
+    tables.path->setVals(0, n, topology.topoTable.c_str(), topology.pathTable.c_str(), 1.0, BENCH_STEPS, 1);
+    tables.path->initiate();
+    tables.pathCatalog = new RlPathRoutingTable();
+    tables.pathCatalog->setVals(0, n, topology.topoTable.c_str(), "", 1.0, BENCH_STEPS, 1, BENCH_CANDIDATES);
+    tables.pathCatalog->initiate();
+    tables.multipath = new RlMultipathRoutingTable();
+    tables.multipath->setVals(0, n, topology.topoTable.c_str(), topology.multipathTable.c_str(), 1.0,
+                              BENCH_STEPS, 1);
+    tables.multipath->initiate();
+    tables.weighted = new RlWeightedShortestPathRoutingTable();
+    tables.weighted->setVals(0, n, topology.topoTable.c_str(), "", 1.0, BENCH_STEPS, 1);
+    tables.weighted->initiate();
+    tables.ecmp = new RlEcmpRoutingTable();
+    tables.ecmp->setVals(0, n, topology.topoTable.c_str(), 1.0, BENCH_STEPS, 1);
+    tables.ecmp->initiate();
+    return tables;
+}
+
+/**
+ * @brief Packet of an OD pair as sent by RlUdpApp in step 0
+ *
+ * @param src   Source node
+ * @param dst   Destination node
+ * @param id    Packet ID in the step
+ * @return unique_ptr<Packet> Packet with its parameters
+ */
+static unique_ptr<Packet> makePacket(int src, int dst, int id)
+{
+    unique_ptr<Packet> packet(new Packet("UDPData", BENCH_PACKET_BITS));
+    packet->addPar("step").setLongValue(0);
+    packet->addPar("src").setStringValue(("H[" + to_string(src) + "]").c_str());
+    packet->addPar("dst").setStringValue(("H[" + to_string(dst) + "]").c_str());
+    packet->addPar("id").setLongValue(id);
+    packet->addPar("flow").setLongValue(id % 4);
+    return packet;
+}
+
+static vector<unique_ptr<Packet>> makePackets(const Topology &topology)
+{
+    vector<unique_ptr<Packet>> packets;
+    for (int i = 0; i < BENCH_PACKET_POOL; i++) {
+        const pair<int, int> &od = topology.pairs[i % topology.pairs.size()];
+        packets.push_back(makePacket(od.first, od.second, i));
+    }
+    return packets;
+}
+
+/**
+ * @brief Route packets from their source host to their destination host, one call of getRoute per module, as Ipv4
+ * does with the full path of its parent module. Items are the calls of getRoute
+ */
+static void benchGetRoute(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table)
+{
+    vector<unique_ptr<Packet>> packets = makePackets(topology);
+    int maxHops = topology.nodeNum * 4 + 2; // Random walks of the probabilistic table are cut
+    size_t index = 0;
+    int64_t calls = 0, routed = 0;
+    for (auto _ : state) {
+        Packet *packet = packets[index++ % packets.size()].get();
+        string dstName = packet->par("dst").stringValue();
+        string module = packet->par("src").stringValue();
+        for (int hop = 0; hop < maxHops && module != dstName; hop++) {
+            pair<string, int> next = table->getRoute(topology.name + "." + module, packet);
+            benchmark::DoNotOptimize(next.second);
+            module = next.first;
+            calls++;
+        }
+        if (++routed % BENCH_CLEAR_PERIOD == 0)
+            table->clearPkts();
+    }
+    state.SetItemsProcessed(calls);
+}
+
+/**
+ * @brief Next node of a router towards a destination, over all routers and destinations
+ */
+static void benchGetNextNode(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table)
+{
+    size_t index = 0;
+    for (auto _ : state) {
+        const pair<int, int> &od = topology.pairs[index++ % topology.pairs.size()];
+        benchmark::DoNotOptimize(table->getNextNode(od.first, od.first, od.second));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Next hop of a packet at its first router, the path given by the agent is parsed and shortened at each call
+ */
+static void benchGetNextHopPath(benchmark::State &state, const Topology &topology, RlPathRoutingTable *table)
+{
+    vector<unique_ptr<Packet>> packets = makePackets(topology);
+    vector<string> pathStrs;
+    for (auto &packet : packets) {
+        table->getRoute(topology.name + "." + packet->par("src").stringValue(), packet.get());
+        pathStrs.push_back(packet->par("path").stringValue());
+    }
+    size_t index = 0;
+    for (auto _ : state) {
+        size_t i = index++ % packets.size();
+        Packet *packet = packets[i].get();
+        // getNextHop removes the current node from the path, it is restored for the next call on the same packet
+        packet->par("path").setStringValue(pathStrs[i].c_str());
+        benchmark::DoNotOptimize(table->getNextHop(atoi(pathStrs[i].c_str()), packet));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Next hop of a packet at its first router with the candidate path catalog, the path ID is set by the host
+ */
+static void benchGetNextHopCatalog(benchmark::State &state, const Topology &topology, RlPathRoutingTable *table)
+{
+    vector<unique_ptr<Packet>> packets = makePackets(topology);
+    for (auto &packet : packets)
+        table->getRoute(topology.name + "." + packet->par("src").stringValue(), packet.get());
+    size_t index = 0;
+    for (auto _ : state) {
+        Packet *packet = packets[index++ % packets.size()].get();
+        int src = atoi(packet->par("src").stringValue() + 2);
+        benchmark::DoNotOptimize(table->getNextHop(src, packet));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Next hop of a flow in ECMP, the flows of an OD pair are hashed over the equal-cost next hops
+ */
+static void benchGetNextHopEcmp(benchmark::State &state, const Topology &topology, RlEcmpRoutingTable *table)
+{
+    size_t index = 0;
+    for (auto _ : state) {
+        size_t i = index++;
+        const pair<int, int> &od = topology.pairs[i % topology.pairs.size()];
+        benchmark::DoNotOptimize(table->getNextHop(od.first, od.first, od.second, i % 4));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Gate of every link, the index of the neighbor in the row of the router
+ */
+static void benchGetGateId(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table)
+{
+    vector<pair<int, int>> links;
+    for (int k = 0; k < topology.nodeNum * topology.nodeNum; k++)
+        if (topology.adjacency[k])
+            links.push_back(make_pair(k / topology.nodeNum, k % topology.nodeNum));
+    size_t index = 0;
+    for (auto _ : state) {
+        const pair<int, int> &link = links[index++ % links.size()];
+        benchmark::DoNotOptimize(table->getGateId(link.first, link.second));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void benchCountPkct(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table)
+{
+    vector<pair<int, int>> links;
+    for (int k = 0; k < topology.nodeNum * topology.nodeNum; k++)
+        if (topology.adjacency[k])
+            links.push_back(make_pair(k / topology.nodeNum, k % topology.nodeNum));
+    size_t index = 0;
+    for (auto _ : state) {
+        const pair<int, int> &link = links[index++ % links.size()];
+        table->countPkct(link.first, link.second, BENCH_PACKET_BITS);
+        if (index % BENCH_CLEAR_PERIOD == 0)
+            table->clearPkts();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Delay of received packets in distributed mode, per packet ID for hop-by-hop tables and per OD pair for path tables
+ */
+static void benchCountPktDelay(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table)
+{
+    vector<unique_ptr<Packet>> packets = makePackets(topology);
+    size_t index = 0;
+    for (auto _ : state)
+        table->countPktDelay(packets[index++ % packets.size()].get(), 0.01);
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief State of a step sent by the last router, then the reply of the agent parsed into the routing state
+ */
+static void benchUpdateRoutingTable(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table,
+                                    const string &reply)
+{
+    setReply(reply);
+    for (auto _ : state) {
+        table->updateNodeCount[0] = topology.nodeNum - 1;
+        table->updateRoutingTable(0, 1.0);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Weights of the agent change one link at each step, so the shortest path engine repairs its trees every time
+ */
+static void benchUpdateWeights(benchmark::State &state, const Topology &topology,
+                               RlWeightedShortestPathRoutingTable *table)
+{
+    int64_t step = 0;
+    zmq::mockReplier() = [&topology, &step](const string &request) {
+        string reply;
+        for (int i = 0; i < topology.linkNum; i++)
+            reply += (i ? "," : "") + string(i == step % topology.linkNum ? "2" : "1");
+        step++;
+        return reply;
+    };
+    for (auto _ : state) {
+        table->updateNodeCount[0] = topology.nodeNum - 1;
+        table->updateRoutingTable(0, 1.0);
+    }
+    state.SetItemsProcessed(state.iterations());
+    setReply("");
+}
+
+/**
+ * @brief Rewards of a step in distributed mode. The packets of the step are counted again before each call, along their
+ * shortest path, with one packet out of ten lost
+ */
+static void benchEndStep(benchmark::State &state, const Topology &topology, RlBasicRoutingTable *table)
+{
+    setReply("reward received");
+    vector<unique_ptr<Packet>> packets = makePackets(topology);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < (int)packets.size(); i++) {
+            Packet *packet = packets[i].get();
+            int src = atoi(packet->par("src").stringValue() + 2);
+            int dst = atoi(packet->par("dst").stringValue() + 2);
+            for (int node : topology.paths[src * topology.nodeNum + dst])
+                table->countPktInNode(topology.name + ".R[" + to_string(node) + "]", packet);
+            table->pkNumOfStep[0]++;
+            if (i % 10)
+                table->countPktDelay(packet, 0.01);
+        }
+        state.ResumeTiming();
+        table->endStep(0);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief Names of all networks in a NED directory
+ *
+ * @param nedPath   NED directory
+ * @return vector<string> Sorted network names
+ */
+static vector<string> listTopologies(const string &nedPath)
+{
+    vector<string> names;
+    DIR *dir = opendir(nedPath.c_str());
+    if (!dir)
+        throw runtime_error("Cannot open NED directory '" + nedPath + "'");
+    while (dirent *entry = readdir(dir)) {
+        string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".ned") == 0)
+            names.push_back(name.substr(0, name.size() - 4));
+    }
+    closedir(dir);
+    sort(names.begin(), names.end());
+    return names;
+}
+
+static void registerBenchmarks(const Topology &topology, const Tables &tables)
+{
+    string suffix = "/" + topology.name;
+    string weightReply;
+    for (int i = 0; i < topology.linkNum; i++)
+        weightReply += (i ? "," : "") + string("1");
+
+    benchmark::RegisterBenchmark(("getRoute/probabilistic" + suffix).c_str(), benchGetRoute, cref(topology),
+                                 tables.probabilistic);
+    benchmark::RegisterBenchmark(("getRoute/path" + suffix).c_str(), benchGetRoute, cref(topology), tables.path);
+    benchmark::RegisterBenchmark(("getRoute/path_catalog" + suffix).c_str(), benchGetRoute, cref(topology), tables.pathCatalog);
+    benchmark::RegisterBenchmark(("getRoute/multipath" + suffix).c_str(), benchGetRoute, cref(topology), tables.multipath);
+    benchmark::RegisterBenchmark(("getRoute/weighted" + suffix).c_str(), benchGetRoute, cref(topology), tables.weighted);
+    benchmark::RegisterBenchmark(("getRoute/ecmp" + suffix).c_str(), benchGetRoute, cref(topology), tables.ecmp);
+
+    benchmark::RegisterBenchmark(("getNextNode/probabilistic" + suffix).c_str(), benchGetNextNode, cref(topology),
+                                 tables.probabilistic);
+    benchmark::RegisterBenchmark(("getNextNode/weighted" + suffix).c_str(), benchGetNextNode, cref(topology), tables.weighted);
+    benchmark::RegisterBenchmark(("getNextNode/ecmp" + suffix).c_str(), benchGetNextNode, cref(topology), tables.ecmp);
+
+    benchmark::RegisterBenchmark(("getNextHop/path" + suffix).c_str(), benchGetNextHopPath, cref(topology), tables.path);
+    benchmark::RegisterBenchmark(("getNextHop/path_catalog" + suffix).c_str(), benchGetNextHopCatalog, cref(topology),
+                                 tables.pathCatalog);
+    benchmark::RegisterBenchmark(("getNextHop/ecmp" + suffix).c_str(), benchGetNextHopEcmp, cref(topology), tables.ecmp);
+
+    benchmark::RegisterBenchmark(("getGateId" + suffix).c_str(), benchGetGateId, cref(topology), tables.ecmp);
+    benchmark::RegisterBenchmark(("countPkct" + suffix).c_str(), benchCountPkct, cref(topology), tables.ecmp);
+    benchmark::RegisterBenchmark(("countPktDelay/basic" + suffix).c_str(), benchCountPktDelay, cref(topology),
+                                 tables.probabilistic);
+    benchmark::RegisterBenchmark(("countPktDelay/path" + suffix).c_str(), benchCountPktDelay, cref(topology), tables.path);
+
+    benchmark::RegisterBenchmark(("updateRoutingTable/probabilistic" + suffix).c_str(), benchUpdateRoutingTable, cref(topology),
+                                 tables.probabilistic, weightReply);
+    benchmark::RegisterBenchmark(("updateRoutingTable/path" + suffix).c_str(), benchUpdateRoutingTable, cref(topology),
+                                 tables.path, topology.pathTable);
+    benchmark::RegisterBenchmark(("updateRoutingTable/multipath" + suffix).c_str(), benchUpdateRoutingTable, cref(topology),
+                                 tables.multipath, topology.multipathTable);
+    benchmark::RegisterBenchmark(("updateRoutingTable/weighted" + suffix).c_str(), benchUpdateWeights, cref(topology),
+                                 tables.weighted);
+    benchmark::RegisterBenchmark(("updateRoutingTable/ecmp" + suffix).c_str(), benchUpdateRoutingTable, cref(topology),
+                                 tables.ecmp, string("get state"));
+
+    benchmark::RegisterBenchmark(("endStep/basic" + suffix).c_str(), benchEndStep, cref(topology), tables.probabilistic);
+    benchmark::RegisterBenchmark(("endStep/path" + suffix).c_str(), benchEndStep, cref(topology), tables.path);
+}
+
+/**
+ * Usage: RlBenchmark [--benchmark_...] [ned_path=config/ned] [topologies=Abilene,Nsfnet]
+ * Run from the home directory of the repository. Results are written to stdout in JSON, the messages printed by the
+ * tables are discarded.
+ */
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+    string nedPath = "config/ned";
+    vector<string> names;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq), value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (key == "ned_path") {
+            nedPath = value;
+        } else if (key == "topologies") {
+            stringstream ss(value);
+            string name;
+            while (getline(ss, name, ','))
+                names.push_back(name);
+        } else {
+            cerr << "Unknown argument '" << arg << "'" << endl;
+            return 1;
+        }
+    }
+
+    try {
+        if (names.empty())
+            names = listTopologies(nedPath);
+        // Topologies are registered by address, they live until the end of the process
+        static vector<Topology> topologies;
+        topologies.reserve(names.size());
+        for (const string &name : names) {
+            topologies.push_back(readTopology(nedPath + "/" + name + ".ned", name));
+            if (topologies.back().pairs.empty())
+                throw runtime_error("Network '" + name + "' has no OD pair with a path");
+            registerBenchmarks(topologies.back(), buildTables(topologies.back()));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    benchmark::JSONReporter reporter;
+    reporter.SetOutputStream(&cout);
+    reporter.SetErrorStream(&cerr);
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,23 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 19:48:26
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 19:48:26
+ * @FilePath     : /root/RouterRL/tools/benchmark/mock/inet/networklayer/contract/INetfilter.h
+ * @Description  : Minimal stand-in for the INET packet seen by the routing tables of RouterRL.
+ */
+#ifndef RL_MOCK_INETFILTER_H
+#define RL_MOCK_INETFILTER_H
+#include <omnetpp.h>
+
+namespace inet {
+
+class Packet : public omnetpp::cPacket
+{
+public:
+    using cPacket::cPacket;
+};
+
+} // namespace inet
+
+#endif // RL_MOCK_INETFILTER_H
@@ -0,0 +1,157 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 19:48:26
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 19:48:26
+ * @FilePath     : /root/RouterRL/tools/benchmark/mock/omnetpp.h
+ * @Description  : Minimal stand-in for the OMNeT++ classes used by the routing tables of RouterRL.
+ */
+#ifndef RL_MOCK_OMNETPP_H
+#define RL_MOCK_OMNETPP_H
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Only what the routing tables need to be linked outside of a simulation: runtime errors, packets with their bit length
+ * and named parameters. Parameters are looked up by name in a vector, as in the cArray of OMNeT++ messages, so that
+ * the cost of par() stays close to the real one.
+ */
+namespace omnetpp {
+
+class cRuntimeError : public std::runtime_error
+{
+public:
+    cRuntimeError(const char *format, ...) : std::runtime_error("")
+    {
+        char buffer[512];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        static_cast<std::runtime_error &>(*this) = std::runtime_error(buffer);
+    }
+};
+
+class cObject
+{
+public:
+    virtual ~cObject() {}
+};
+
+class cMsgPar : public cObject
+{
+public:
+    long longValue() const { return longVal; }
+    long intValue() const { return longVal; }
+    double doubleValue() const { return doubleVal; }
+    bool boolValue() const { return longVal != 0; }
+    const char *stringValue() const { return stringVal.c_str(); }
+    cMsgPar &setLongValue(long value)
+    {
+        longVal = value;
+        return *this;
+    }
+    cMsgPar &setDoubleValue(double value)
+    {
+        doubleVal = value;
+        return *this;
+    }
+    cMsgPar &setStringValue(const char *value)
+    {
+        stringVal = value;
+        return *this;
+    }
+    cMsgPar &setBoolValue(bool value)
+    {
+        longVal = value;
+        return *this;
+    }
+
+protected:
+    long longVal = 0;
+    double doubleVal = 0;
+    std::string stringVal;
+};
+
+class cMessage : public cObject
+{
+public:
+    explicit cMessage(const char *name_v = nullptr) : name(name_v ? name_v : "") {}
+    const char *getName() const { return name.c_str(); }
+    const char *getFullName() const { return name.c_str(); }
+
+    // Unlike OMNeT++, adding an existing parameter returns it instead of adding a second one with the same name, so
+    // that a packet can be routed again by the benchmarks
+    cMsgPar &addPar(const char *parName)
+    {
+        for (auto &item : pars)
+            if (item.first == parName)
+                return item.second;
+        pars.emplace_back(parName, cMsgPar());
+        return pars.back().second;
+    }
+    cMsgPar &par(const char *parName)
+    {
+        for (auto &item : pars)
+            if (item.first == parName)
+                return item.second;
+        throw cRuntimeError("Parameter not found");
+    }
+    bool hasPar(const char *parName) const
+    {
+        for (auto &item : pars)
+            if (item.first == parName)
+                return true;
+        return false;
+    }
+
+protected:
+    std::string name;
+    std::vector<std::pair<std::string, cMsgPar>> pars;
+};
+
+class cPacket : public cMessage
+{
+public:
+    explicit cPacket(const char *name_v = nullptr, int64_t bitLength_v = 0)
+        : cMessage(name_v), bitLength(bitLength_v)
+    {
+    }
+    int64_t getBitLength() const { return bitLength; }
+    void setBitLength(int64_t bitLength_v) { bitLength = bitLength_v; }
+
+protected:
+    int64_t bitLength;
+};
+
+// Tables read the event number for the step profile, the benchmarks have no events
+class cSimulation
+{
+public:
+    int64_t getEventNumber() const { return 0; }
+};
+
+inline cSimulation *getSimulation()
+{
+    static cSimulation simulation;
+    return &simulation;
+}
+
+// The trace reads the simulated time, which stays at 0 in the benchmarks
+class SimTime
+{
+public:
+    double dbl() const { return 0; }
+};
+
+inline SimTime simTime() { return SimTime(); }
+
+} // namespace omnetpp
+
+#endif // RL_MOCK_OMNETPP_H
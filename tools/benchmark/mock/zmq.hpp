@@ -0,0 +1,86 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 19:48:26
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 19:48:26
+ * @FilePath     : /root/RouterRL/tools/benchmark/mock/zmq.hpp
+ * @Description  : In-process stand-in for the ZMQ socket of the routing tables of RouterRL.
+ */
+#ifndef RL_MOCK_ZMQ_HPP
+#define RL_MOCK_ZMQ_HPP
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#define ZMQ_LINGER 17
+
+/**
+ * The agent is replaced by a function called with each request of a routing table, its result is the reply. No
+ * message leaves the process, so the benchmarks measure the tables and not the transport.
+ */
+namespace zmq {
+
+using replier_t = std::function<std::string(const std::string &)>;
+
+inline replier_t &mockReplier()
+{
+    static replier_t replier;
+    return replier;
+}
+
+enum class socket_type { req, rep };
+enum class send_flags { none };
+enum class recv_flags { none };
+
+class message_t
+{
+public:
+    message_t() {}
+    explicit message_t(size_t size) : buffer(size, '\0') {}
+    void *data() { return &buffer[0]; }
+    const void *data() const { return buffer.data(); }
+    size_t size() const { return buffer.size(); }
+    std::string to_string() const { return buffer; }
+
+protected:
+    std::string buffer;
+    friend class socket_t;
+};
+
+class context_t
+{
+public:
+    explicit context_t(int ioThreads) {}
+    void close() {}
+};
+
+struct recv_result_t {
+    bool has_value() const { return true; }
+    explicit operator bool() const { return true; }
+};
+
+class socket_t
+{
+public:
+    socket_t(context_t &context, socket_type type) {}
+    template <typename T> void setsockopt(int option, T value) {}
+    void connect(const std::string &addr) {}
+    void close() {}
+    recv_result_t send(message_t &msg, send_flags flags)
+    {
+        request = msg.buffer;
+        return {};
+    }
+    recv_result_t recv(message_t &msg, recv_flags flags)
+    {
+        msg.buffer = mockReplier() ? mockReplier()(request) : "";
+        return {};
+    }
+
+protected:
+    std::string request;
+};
+
+} // namespace zmq
+
+#endif // RL_MOCK_ZMQ_HPP
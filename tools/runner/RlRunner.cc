@@ -0,0 +1,756 @@
+/*
+ * @Author       : LIN Guocheng
+ * @Date         : 2026-10-18 19:12:40
+ * @LastEditors  : LIN Guocheng
+ * @LastEditTime : 2026-10-18 19:12:40
+ * @FilePath     : /root/RouterRL/tools/runner/RlRunner.cc
+ * @Description  : Parallel runner of baseline sweeps in RouterRL, one simulator pinned to each core.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <regex>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <queue>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <zmq.hpp>
+
+using namespace std;
+
+#define RUNNER_RECV_TIMEOUT  30000 // ms without any request before a simulator is considered stuck, as in the Python envs
+#define RUNNER_WARMUP_STEPS  100   // Steps simulated on top of the measured ones, as in the Python envs
+#define RUNNER_STOP_TIMEOUT  2000  // ms given to a simulator to exit after SIGTERM, before SIGKILL
+
+/**
+ * Sweep specification, read from a file of "key = value" lines (# starts a comment) and overridden by key=value
+ * arguments. Lists are comma-separated, every combination of them is one run.
+ */
+struct SweepSpec {
+    vector<string> topologies;   // Network names in nedPath, "all" for every .ned file
+    vector<string> routingModes; // Routing modes of RlUdpApp, the agents of the RL modes keep their initial routing
+    vector<double> flowRates;    // Mbits/s
+    vector<int> seeds;
+    int steps = 10;              // Measured steps of each run
+    int coldStartSteps = 20;     // Rewards of the steps before it are not measured
+    int flowsPerPair = 4;        // ecmp only
+    int stepTime = 1;            // s
+    int messageLength = 128;     // Bytes
+    int jobs = 0;                // Simulators running at the same time, 0: one per allowed core
+    string nedPath = "config/ned";
+    string iniFile = "config/omnetpp.ini";
+    string output = "logs/runner/results.csv";
+    string logDir = "logs/runner";
+};
+
+struct RunSpec {
+    string topology;
+    string routingMode;
+    double flowRate;
+    int seed;
+};
+
+struct RunResult {
+    int steps = 0;
+    double avgDelay = 0;    // s
+    double avgLossRate = 0;
+    double wallTime = 0;    // s, from the start to the end of the simulator
+    double stepTime = 0;    // Wall time of a measured step, s
+    long long events = 0;   // Events of the simulation when it was stopped, from the last status line of Cmdenv
+    double eventRate = 0;   // Events per second of Cmdenv elapsed time
+    double packetRate = 0;  // Packets forwarded between routers per second of the measured steps
+    long peakRss = 0;       // Maximum resident set size of the simulator, KB
+    string status = "ok";
+};
+
+/**
+ * Routing of a run: the tables given to the simulator at its start and the reply of the scripted agent to its states.
+ * The agents of the RL modes keep the initial routing of their Python envs (shortest paths, uniform probabilities or
+ * unit weights) and send it again as their action at every step, as an agent would.
+ */
+struct RunRouting {
+    int nodeNum = 0;
+    string topoTable;        // Adjacency matrix, only for the modes that need it
+    string initRoutingTable;
+    string action;           // Reply to every state
+};
+
+/**
+ * @brief Split a comma-separated list, spaces around the items are removed
+ *
+ * @param list  List to split
+ * @return vector<string> Items of the list
+ */
+static vector<string> splitList(const string &list)
+{
+    vector<string> items;
+    stringstream stream(list);
+    string item;
+    while (getline(stream, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+/**
+ * @brief Set a field of the sweep specification
+ *
+ * @param spec  Sweep specification
+ * @param key   Name of the field
+ * @param value Value of the field
+ */
+static void setSpecValue(SweepSpec &spec, const string &key, const string &value)
+{
+    if (key == "topologies") {
+        spec.topologies = splitList(value);
+    } else if (key == "routing_modes") {
+        spec.routingModes = splitList(value);
+        for (auto &mode : spec.routingModes)
+            if (mode != "convention" && mode != "ecmp" && mode != "probabilistic" && mode != "singlepath"
+                && mode != "multipath" && mode != "weighted")
+                throw runtime_error("Unknown routing mode '" + mode + "'");
+    } else if (key == "flow_rates") {
+        spec.flowRates.clear();
+        for (auto &rate : splitList(value))
+            spec.flowRates.push_back(stod(rate));
+    } else if (key == "seeds") {
+        spec.seeds.clear();
+        for (auto &seed : splitList(value))
+            spec.seeds.push_back(stoi(seed));
+    } else if (key == "steps") {
+        spec.steps = stoi(value);
+    } else if (key == "cold_start_steps") {
+        spec.coldStartSteps = stoi(value);
+    } else if (key == "flows_per_pair") {
+        spec.flowsPerPair = stoi(value);
+    } else if (key == "step_time") {
+        spec.stepTime = stoi(value);
+    } else if (key == "message_length") {
+        spec.messageLength = stoi(value);
+    } else if (key == "jobs") {
+        spec.jobs = stoi(value);
+    } else if (key == "ned_path") {
+        spec.nedPath = value;
+    } else if (key == "ini_file") {
+        spec.iniFile = value;
+    } else if (key == "output") {
+        spec.output = value;
+    } else if (key == "log_dir") {
+        spec.logDir = value;
+    } else {
+        throw runtime_error("Unknown sweep key '" + key + "'");
+    }
+}
+
+/**
+ * @brief Parse a "key = value" line of the sweep specification, empty lines and comments are ignored
+ *
+ * @param spec  Sweep specification
+ * @param line  Line to parse
+ */
+static void parseSpecLine(SweepSpec &spec, string line)
+{
+    line = line.substr(0, line.find('#'));
+    size_t eq = line.find('=');
+    if (line.find_first_not_of(" \t\r") == string::npos)
+        return;
+    if (eq == string::npos)
+        throw runtime_error("Invalid sweep line '" + line + "', key = value expected");
+    string key = line.substr(0, eq), value = line.substr(eq + 1);
+    key.erase(0, key.find_first_not_of(" \t"));
+    key.erase(key.find_last_not_of(" \t") + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    value.erase(value.find_last_not_of(" \t\r") + 1);
+    setSpecValue(spec, key, value);
+}
+
+/**
+ * @brief Names of all networks in a NED directory
+ *
+ * @param nedPath   NED directory
+ * @return vector<string> Sorted network names
+ */
+static vector<string> listTopologies(const string &nedPath)
+{
+    vector<string> names;
+    DIR *dir = opendir(nedPath.c_str());
+    if (!dir)
+        throw runtime_error("Cannot open NED directory '" + nedPath + "'");
+    while (dirent *entry = readdir(dir)) {
+        string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".ned") == 0)
+            names.push_back(name.substr(0, name.size() - 4));
+    }
+    closedir(dir);
+    sort(names.begin(), names.end());
+    return names;
+}
+
+/**
+ * @brief Read the number of routers and the adjacency matrix of a network, as the Python envs do
+ *
+ * @param nedFile   NED file of the network
+ * @param topo      Adjacency matrix in row-major order, 1 for a link between routers
+ * @return int Number of routers
+ */
+static int readTopology(const string &nedFile, vector<int> &topo)
+{
+    ifstream file(nedFile);
+    if (!file)
+        throw runtime_error("Cannot open '" + nedFile + "'");
+    stringstream buffer;
+    buffer << file.rdbuf();
+    string ned = buffer.str();
+
+    smatch match;
+    int nodeNum = 0;
+    if (regex_search(ned, match, regex("R\\[(\\d+)\\]")))
+        nodeNum = stoi(match[1]);
+    topo.assign(nodeNum * nodeNum, 0);
+    regex link("R\\[(\\d+)\\][^;\\n]*? <--> C <--> R\\[(\\d+)\\][^;\\n]*?;");
+    for (sregex_iterator it(ned.begin(), ned.end(), link), end; it != end; ++it) {
+        int i = stoi((*it)[1]), j = stoi((*it)[2]);
+        if (i < nodeNum && j < nodeNum)
+            topo[i * nodeNum + j] = topo[j * nodeNum + i] = 1;
+    }
+    return nodeNum;
+}
+
+/**
+ * @brief Shortest path of every OD pair in the format of the path tables, with a BFS over the neighbors in the order
+ * of their IDs
+ *
+ * @param nodeNum   Number of routers
+ * @param topo      Adjacency matrix
+ * @param ratio     Split ratio appended to each path for the multipath table, empty for the single path table
+ * @return string   src,dst,path[,ratio];...
+ */
+static string shortestPathTable(int nodeNum, const vector<int> &topo, const string &ratio)
+{
+    string table;
+    for (int src = 0; src < nodeNum; src++) {
+        vector<int> parent(nodeNum, -1);
+        queue<int> bfsQueue;
+        parent[src] = src;
+        bfsQueue.push(src);
+        while (!bfsQueue.empty()) {
+            int node = bfsQueue.front();
+            bfsQueue.pop();
+            for (int next = 0; next < nodeNum; next++) {
+                if (topo[node * nodeNum + next] && parent[next] == -1) {
+                    parent[next] = node;
+                    bfsQueue.push(next);
+                }
+            }
+        }
+        for (int dst = 0; dst < nodeNum; dst++) {
+            if (dst == src || parent[dst] == -1)
+                continue;
+            string path = to_string(dst);
+            for (int node = dst; node != src;) {
+                node = parent[node];
+                path = to_string(node) + "." + path;
+            }
+            table += (table.empty() ? "" : ";") + to_string(src) + "," + to_string(dst) + "," + path
+                     + (ratio.empty() ? "" : "," + ratio);
+        }
+    }
+    return table;
+}
+
+/**
+ * @brief Tables and agent action of a run, in the formats of the Python envs
+ *
+ * @param nedFile       NED file of the network
+ * @param routingMode   Routing mode of the run
+ * @return RunRouting Routing of the run
+ */
+static RunRouting makeRouting(const string &nedFile, const string &routingMode)
+{
+    RunRouting routing;
+    vector<int> topo;
+    int n = readTopology(nedFile, topo);
+    routing.nodeNum = n;
+    string topoTable, unitWeights;
+    for (size_t k = 0; k < topo.size(); k++) {
+        topoTable += (k ? "," : "") + to_string(topo[k]);
+        if (topo[k])
+            unitWeights += (unitWeights.empty() ? "" : ",") + string("1");
+    }
+
+    if (routingMode == "probabilistic") {
+        // Forwarding probabilities in percent, uniform over the neighbors, the agent gives one weight per link
+        string probs;
+        for (int i = 0; i < n; i++) {
+            int degree = 0;
+            for (int j = 0; j < n; j++)
+                degree += topo[i * n + j];
+            for (int j = 0; j < n; j++)
+                probs += (i || j ? "," : "") + to_string(topo[i * n + j] ? 100 / degree : 0);
+        }
+        routing.initRoutingTable = "[" + probs + "]";
+        routing.action = unitWeights;
+    } else if (routingMode == "singlepath" || routingMode == "multipath") {
+        routing.topoTable = topoTable;
+        routing.initRoutingTable = shortestPathTable(n, topo, routingMode == "multipath" ? "1" : "");
+        routing.action = routing.initRoutingTable;
+    } else if (routingMode == "weighted") {
+        routing.topoTable = topoTable;
+        routing.initRoutingTable = unitWeights;
+        routing.action = unitWeights;
+    } else {
+        // convention and ecmp route without actions
+        if (routingMode == "ecmp")
+            routing.topoTable = topoTable;
+        routing.action = "get state";
+    }
+    return routing;
+}
+
+/**
+ * @brief Cores the runner may use, ordered so that consecutive slots alternate between NUMA nodes. Each simulator
+ * then allocates its memory on the node of its core (first touch), and the memory bandwidth of all nodes is used
+ * even when there are fewer runs than cores
+ *
+ * @return vector<int> Core of each slot
+ */
+static vector<int> orderCores()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        throw runtime_error("Cannot read the CPU affinity of the runner");
+
+    // Cores of each NUMA node from sysfs, a single node if the machine reports none
+    vector<vector<int>> nodes;
+    for (int node = 0;; node++) {
+        ifstream cpuList("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if (!cpuList)
+            break;
+        string list;
+        getline(cpuList, list);
+        vector<int> cores;
+        for (auto &range : splitList(list)) {
+            size_t dash = range.find('-');
+            int first = stoi(range), last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++)
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                    cores.push_back(cpu);
+        }
+        if (!cores.empty())
+            nodes.push_back(cores);
+    }
+    if (nodes.empty()) {
+        nodes.emplace_back();
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            if (CPU_ISSET(cpu, &allowed))
+                nodes.back().push_back(cpu);
+    }
+
+    vector<int> order;
+    for (size_t k = 0;; k++) {
+        bool added = false;
+        for (auto &cores : nodes) {
+            if (k < cores.size()) {
+                order.push_back(cores[k]);
+                added = true;
+            }
+        }
+        if (!added)
+            break;
+    }
+    return order;
+}
+
+/**
+ * Runs the simulators of a sweep. Each slot is a thread bound to one core: it starts the simulators of its runs pinned
+ * to its core, and plays a scripted agent over ZMQ (fixed action, rewards after the cold start are averaged), so that
+ * the results and timings of a run do not depend on Python.
+ */
+class RlRunner
+{
+public:
+    RlRunner(const SweepSpec &spec_v);
+    void run();
+
+protected:
+    void runSlot(int core);
+    RunResult runOne(const RunSpec &run, int core, zmq::socket_t &socket, int port);
+    pid_t startSimulator(const RunSpec &run, const RunRouting &routing, int core, int port);
+    long stopSimulator(pid_t pid);
+    string logFileOf(const RunSpec &run);
+    void writeResult(const RunSpec &run, int core, const RunResult &result);
+
+    SweepSpec spec;
+    vector<RunSpec> runs;
+    atomic<int> nextRun{0};
+    zmq::context_t context{1};
+    mutex outputMutex;
+    ofstream output;
+    int finishedRuns = 0;
+};
+
+RlRunner::RlRunner(const SweepSpec &spec_v) : spec(spec_v)
+{
+    if (spec.topologies.empty() || spec.topologies == vector<string>{"all"})
+        spec.topologies = listTopologies(spec.nedPath);
+    if (spec.routingModes.empty())
+        spec.routingModes = {"convention", "ecmp"};
+    if (spec.flowRates.empty() || spec.seeds.empty())
+        throw runtime_error("The sweep needs flow_rates and seeds");
+    if (spec.steps <= 0)
+        throw runtime_error("The sweep needs steps > 0");
+    for (auto &topology : spec.topologies)
+        for (auto &mode : spec.routingModes)
+            for (double rate : spec.flowRates)
+                for (int seed : spec.seeds)
+                    runs.push_back({topology, mode, rate, seed});
+}
+
+/**
+ * @brief Run all the runs of the sweep, one slot per core, and write one line per run to the output file
+ *
+ */
+void RlRunner::run()
+{
+    if (!getenv("__omnetpp_root_dir") || !getenv("INET_ROOT"))
+        throw runtime_error("OMNeT++ and INET environments are not set, source their setenv first");
+    // Parent directories of the logs are created as well, "logs" may not exist yet
+    for (size_t slash = spec.logDir.find('/', 1); slash != string::npos; slash = spec.logDir.find('/', slash + 1))
+        mkdir(spec.logDir.substr(0, slash).c_str(), 0755);
+    mkdir(spec.logDir.c_str(), 0755);
+    output.open(spec.output);
+    if (!output)
+        throw runtime_error("Cannot write '" + spec.output + "'");
+    output << "topology,routing_mode,flow_rate,seed,core,steps,avg_delay_s,avg_loss_rate,wall_time_s,"
+              "step_time_s,events,events_per_s,packets_per_s,peak_rss_kb,status"
+           << endl;
+
+    vector<int> cores = orderCores();
+    int slotNum = spec.jobs > 0 ? min<int>(spec.jobs, cores.size()) : cores.size();
+    slotNum = min<int>(slotNum, runs.size());
+    cout << "RlRunner: " << runs.size() << " runs on " << slotNum << " cores" << endl;
+
+    vector<thread> slots;
+    for (int i = 0; i < slotNum; i++)
+        slots.emplace_back(&RlRunner::runSlot, this, cores[i]);
+    for (auto &slot : slots)
+        slot.join();
+}
+
+/**
+ * @brief Take runs until none is left, each one with a fresh agent socket
+ *
+ * @param core  Core of the slot
+ */
+void RlRunner::runSlot(int core)
+{
+    int index;
+    while ((index = nextRun.fetch_add(1)) < (int)runs.size()) {
+        const RunSpec &run = runs[index];
+        RunResult result;
+        auto start = chrono::steady_clock::now();
+        try {
+            zmq::socket_t socket(context, zmq::socket_type::rep);
+            socket.setsockopt(ZMQ_LINGER, 0);
+            socket.setsockopt(ZMQ_RCVTIMEO, RUNNER_RECV_TIMEOUT);
+            socket.bind("tcp://127.0.0.1:*");
+            char endpoint[256];
+            size_t size = sizeof(endpoint);
+            socket.getsockopt(ZMQ_LAST_ENDPOINT, endpoint, &size);
+            int port = atoi(strrchr(endpoint, ':') + 1);
+            result = runOne(run, core, socket, port);
+        } catch (const exception &e) {
+            result.status = string("error: ") + e.what();
+        }
+        result.wallTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        writeResult(run, core, result);
+    }
+}
+
+/**
+ * @brief Read the events of a simulation from the last status line of Cmdenv in its log,
+ * "** Event #N   t=T   Elapsed: Xs (...)", the event rate is measured by the clock of Cmdenv
+ *
+ * @param logFile   Log of the simulator
+ * @param result    Result of the run, events and event rate are set if a status line is found
+ */
+static void readEventCount(const string &logFile, RunResult &result)
+{
+    ifstream log(logFile);
+    string line;
+    while (getline(log, line)) {
+        long long events;
+        double elapsed;
+        if (sscanf(line.c_str(), "** Event #%lld t=%*s Elapsed: %lf", &events, &elapsed) == 2) {
+            result.events = events;
+            result.eventRate = elapsed > 0 ? events / elapsed : 0;
+        }
+    }
+}
+
+/**
+ * @brief Run one simulation and play the scripted agent: states are answered with the action of the routing of the
+ * run, the rewards of the measured steps are averaged and the measured steps are timed. Packets forwarded between
+ * routers are counted from the link loads of the states
+ *
+ * @param run       Run to simulate
+ * @param core      Core the simulator is pinned to
+ * @param socket    Bound REP socket of the agent
+ * @param port      Port of the socket
+ * @return RunResult Averages of the measured steps
+ */
+RunResult RlRunner::runOne(const RunSpec &run, int core, zmq::socket_t &socket, int port)
+{
+    RunResult result;
+    RunRouting routing = makeRouting(spec.nedPath + "/" + run.topology + ".ned", run.routingMode);
+    pid_t pid = startSimulator(run, routing, core, port);
+    bool started = false;
+    chrono::steady_clock::time_point measureStart, measureEnd;
+    double forwardedLoad = 0; // Sum of the link loads of the measured steps, Mbits/s
+    try {
+        while (result.steps < spec.steps) {
+            zmq::message_t request;
+            if (!socket.recv(request, zmq::recv_flags::none)) {
+                int status;
+                struct rusage usage;
+                result.status = "timeout";
+                if (wait4(pid, &status, WNOHANG, &usage) == pid) {
+                    result.status = "simulator exited";
+                    result.peakRss = usage.ru_maxrss;
+                }
+                break;
+            }
+            auto now = chrono::steady_clock::now();
+            if (!started) {
+                measureStart = now;
+                started = true;
+            }
+            string msg(static_cast<const char *>(request.data()), request.size());
+            // Format: kind@@step@@body, kind is s (state), r (reward) or c (path catalog)
+            size_t first = msg.find("@@"), second = msg.find("@@", first + 2);
+            string kind = msg.substr(0, first);
+            string reply = "received";
+            if (kind == "s") {
+                reply = routing.action;
+                int step = atoi(msg.c_str() + first + 2);
+                if (step >= spec.coldStartSteps && step < spec.coldStartSteps + spec.steps
+                    && second != string::npos)
+                    for (auto &load : splitList(msg.substr(second + 2)))
+                        forwardedLoad += atof(load.c_str());
+            } else if (kind == "r") {
+                reply = "reward received";
+                int step = atoi(msg.c_str() + first + 2);
+                if (step >= spec.coldStartSteps && second != string::npos) {
+                    vector<string> reward = splitList(msg.substr(second + 2));
+                    if (reward.size() >= 2) {
+                        result.avgDelay += stod(reward[0]);
+                        result.avgLossRate += stod(reward[1]);
+                        result.steps++;
+                        measureEnd = now;
+                    }
+                } else {
+                    // The measured steps start when the last cold start step ends
+                    measureStart = now;
+                }
+            } else if (kind == "c") {
+                reply = "catalog received";
+            }
+            zmq::message_t response(reply.size());
+            memcpy(response.data(), reply.data(), reply.size());
+            socket.send(response, zmq::send_flags::none);
+        }
+    } catch (...) {
+        stopSimulator(pid);
+        throw;
+    }
+    long peakRss = stopSimulator(pid);
+    if (peakRss > 0)
+        result.peakRss = peakRss;
+    readEventCount(logFileOf(run), result);
+    if (result.steps > 0) {
+        result.avgDelay /= result.steps;
+        result.avgLossRate /= result.steps;
+        double measured = chrono::duration<double>(measureEnd - measureStart).count();
+        result.stepTime = measured / result.steps;
+        if (measured > 0)
+            result.packetRate =
+                forwardedLoad * spec.stepTime * 1e6 / (8.0 * spec.messageLength) / measured;
+    }
+    return result;
+}
+
+/**
+ * @brief Start a simulator with the same arguments as the Python envs, pinned to a core before exec so that all its
+ * allocations are local to the NUMA node of the core
+ *
+ * @param run   Run to simulate
+ * @param core  Core to pin the simulator to
+ * @param port  ZMQ port of the agent
+ * @return pid_t Process of the simulator
+ */
+pid_t RlRunner::startSimulator(const RunSpec &run, const RunRouting &routing, int core, int port)
+{
+    string omnetpp = getenv("__omnetpp_root_dir"), inet = getenv("INET_ROOT");
+    ostringstream rate;
+    rate << run.flowRate;
+    string logFile = logFileOf(run);
+    vector<string> args = {
+        omnetpp + "/bin/opp_run_release",
+        "-l",
+        inet + "/bin/../src/../src/INET",
+        "-x",
+        "inet.applications.voipstream;inet.common.selfdoc;inet.emulation;"
+        "inet.examples.emulation;inet.examples.voipstream;"
+        "inet.linklayer.configurator.gatescheduling.z3;inet.showcases.emulation;"
+        "inet.showcases.visualizer.osg;inet.transportlayer.tcp_lwip;inet.visualizer.osg",
+        "-n",
+        inet + "/examples:" + inet + "/showcases:" + inet + "/src:" + inet + "/tests/validation:" + inet
+            + "/tests/networks:" + inet + "/tutorials:",
+        "--image-path=" + inet + "/images",
+        spec.iniFile,
+        // Status lines of Cmdenv give the event count of the run
+        "--cmdenv-express-mode=true",
+        "--cmdenv-status-frequency=1s",
+        "--num-rngs=1",
+        "--seed-0-mt=" + to_string(run.seed),
+        "--ned-path=" + spec.nedPath,
+        "--network=" + run.topology,
+        "--**.app[0].returnMode=\"global\"",
+        "--**.app[0].routingMode=\"" + run.routingMode + "\"",
+        "--**.configurator.routingMode=\"" + run.routingMode + "\"",
+        "--**.app[0].flowRate=" + rate.str(),
+        "--**.app[0].stepTime=" + to_string(spec.stepTime),
+        "--**.app[0].messageLength=" + to_string(spec.messageLength),
+        "--**.app[0].initRoutingTable=\"" + routing.initRoutingTable + "\"",
+        "--**.app[0].topoTable=\"" + routing.topoTable + "\"",
+        "--**.app[0].nodeNum=" + to_string(routing.nodeNum),
+        "--**.app[0].totalStep=" + to_string(spec.coldStartSteps + spec.steps + RUNNER_WARMUP_STEPS),
+        "--**.app[0].zmqPort=" + to_string(port),
+    };
+    if (run.routingMode == "ecmp")
+        args.push_back("--**.app[0].flowsPerPair=" + to_string(spec.flowsPerPair));
+    vector<char *> argv;
+    for (auto &arg : args)
+        argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0)
+        throw runtime_error(string("Cannot fork: ") + strerror(errno));
+    if (pid == 0) {
+        // Only async-signal-safe calls until exec, the runner has other threads
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+        int log = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log >= 0) {
+            dup2(log, STDOUT_FILENO);
+            close(log);
+        }
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * @brief Log file of a run
+ *
+ * @param run   Run to simulate
+ * @return string Path of the log file, in logDir
+ */
+string RlRunner::logFileOf(const RunSpec &run)
+{
+    ostringstream rate;
+    rate << run.flowRate;
+    return spec.logDir + "/" + run.topology + "-" + run.routingMode + "-fr" + rate.str() + "-s"
+           + to_string(run.seed) + ".out";
+}
+
+/**
+ * @brief Stop a simulator, killed if it does not exit in time
+ *
+ * @param pid   Process of the simulator
+ * @return long Maximum resident set size of the simulator, KB
+ */
+long RlRunner::stopSimulator(pid_t pid)
+{
+    struct rusage usage;
+    int status;
+    kill(pid, SIGTERM);
+    for (int waited = 0; waited < RUNNER_STOP_TIMEOUT; waited += 10) {
+        pid_t waitedPid = wait4(pid, &status, WNOHANG, &usage);
+        if (waitedPid == pid)
+            return usage.ru_maxrss;
+        if (waitedPid < 0)
+            return 0;
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    kill(pid, SIGKILL);
+    return wait4(pid, &status, 0, &usage) == pid ? usage.ru_maxrss : 0;
+}
+
+/**
+ * @brief Append the result of a run to the output file, lines are in the order the runs finish
+ *
+ * @param run       Simulated run
+ * @param core      Core of the run
+ * @param result    Result of the run
+ */
+void RlRunner::writeResult(const RunSpec &run, int core, const RunResult &result)
+{
+    lock_guard<mutex> lock(outputMutex);
+    output << run.topology << "," << run.routingMode << "," << run.flowRate << "," << run.seed << ","
+           << core << "," << result.steps << "," << result.avgDelay << "," << result.avgLossRate << ","
+           << result.wallTime << "," << result.stepTime << "," << result.events << "," << result.eventRate
+           << "," << result.packetRate << "," << result.peakRss << "," << result.status << endl;
+    finishedRuns++;
+    cout << "[" << finishedRuns << "/" << runs.size() << "] " << run.topology << " "
+         << run.routingMode << " fr" << run.flowRate << " seed " << run.seed << ": " << result.status
+         << ", delay " << result.avgDelay * 1000 << " ms, loss " << result.avgLossRate * 100 << " %, "
+         << result.stepTime << " s/step, " << result.eventRate << " ev/s" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <sweep file> [key=value ...]" << endl;
+        return 1;
+    }
+    try {
+        SweepSpec spec;
+        ifstream file(argv[1]);
+        if (!file)
+            throw runtime_error(string("Cannot open sweep file '") + argv[1] + "'");
+        string line;
+        while (getline(file, line))
+            parseSpecLine(spec, line);
+        for (int i = 2; i < argc; i++)
+            parseSpecLine(spec, argv[i]);
+        RlRunner(spec).run();
+    } catch (const exception &e) {
+        cerr << "RlRunner: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
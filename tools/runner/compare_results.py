@@ -0,0 +1,95 @@
+"""
+Author       : LIN Guocheng
+Date         : 2026-10-18 20:21:05
+LastEditors  : LIN Guocheng
+LastEditTime : 2026-10-18 20:21:05
+FilePath     : /root/RouterRL/tools/runner/compare_results.py
+Description  : Compare two result files of RlRunner and flag the performance regressions.
+"""
+import argparse
+import csv
+import sys
+from typing import Dict, List, Tuple
+
+# Metric: True if higher is better
+METRICS = {
+    "events_per_s": True,
+    "packets_per_s": True,
+    "step_time_s": False,
+    "wall_time_s": False,
+    "peak_rss_kb": False,
+}
+
+RunKey = Tuple[str, str, str, str]
+
+
+def read_results(path: str) -> Dict[RunKey, Dict[str, str]]:
+    """Read a result file of RlRunner, runs are identified by their topology, routing mode, flow rate and seed.
+
+    Args:
+        path (str): CSV file written by RlRunner.
+
+    Returns:
+        Dict[RunKey, Dict[str, str]]: Row of each run.
+    """
+    with open(path, "r", encoding="utf-8") as file:
+        return {
+            (row["topology"], row["routing_mode"], row["flow_rate"], row["seed"]): row
+            for row in csv.DictReader(file)
+        }
+
+
+def compare(
+    base: Dict[RunKey, Dict[str, str]], new: Dict[RunKey, Dict[str, str]], threshold: float
+) -> List[str]:
+    """Compare the metrics of the runs in both files.
+
+    Args:
+        base (Dict[RunKey, Dict[str, str]]): Reference results.
+        new (Dict[RunKey, Dict[str, str]]): Results to check.
+        threshold (float): Relative change beyond which a worse metric is a regression, 0.1 for 10 %.
+
+    Returns:
+        List[str]: Description of each regression, failed or missing runs included.
+    """
+    regressions = []
+    for key, base_row in sorted(base.items()):
+        name = "/".join(key)
+        new_row = new.get(key)
+        if new_row is None:
+            regressions.append(f"{name}: missing")
+            continue
+        if new_row["status"] != "ok" and base_row["status"] == "ok":
+            regressions.append(f"{name}: {new_row['status']}")
+            continue
+        for metric, higher_is_better in METRICS.items():
+            if metric not in base_row or metric not in new_row:
+                continue
+            old_value, new_value = float(base_row[metric]), float(new_row[metric])
+            if old_value <= 0 or new_value <= 0:
+                continue
+            change = new_value / old_value - 1
+            worse = -change if higher_is_better else change
+            flag = "REGRESSION" if worse > threshold else ""
+            print(f"{name:<48} {metric:<14} {old_value:>14.6g} {new_value:>14.6g} {change:>+8.1%} {flag}")
+            if flag:
+                regressions.append(f"{name}: {metric} {change:+.1%}")
+    return regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Compare two result files of RlRunner.")
+    parser.add_argument("base", help="Reference results, e.g. of the previous version")
+    parser.add_argument("new", help="Results to check")
+    parser.add_argument(
+        "--threshold", type=float, default=0.1, help="Relative change flagged as a regression"
+    )
+    args = parser.parse_args()
+
+    found = compare(read_results(args.base), read_results(args.new), args.threshold)
+    if found:
+        print(f"\n{len(found)} regressions beyond {args.threshold:.0%}:")
+        for regression in found:
+            print(f"  {regression}")
+        sys.exit(1)
+    print(f"\nNo regression beyond {args.threshold:.0%}")
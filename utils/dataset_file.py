@@ -0,0 +1,94 @@
+"""
+Author       : LIN Guocheng
+Date         : 2026-10-18 22:52:03
+LastEditors  : LIN Guocheng
+LastEditTime : 2026-10-18 22:52:03
+FilePath     : /root/RouterRL/utils/dataset_file.py
+Description  : Map the offline RL datasets written by the simulator (datasetFile of RlUdpApp) and sample them.
+"""
+import argparse
+import struct
+from typing import Dict, Optional
+
+import numpy as np
+
+DATASET_MAGIC = 0x53444C52  # "RLDS"
+DATASET_VERSION = 1
+HEADER = struct.Struct("<IIIIIIQ")  # magic, version, node_num, link_num, field_num, slot_size, slot_num
+COLUMN = struct.Struct("<20s4sII")  # name, numpy type, width, reserved, the columns of utils/results_file.py
+
+DONE_CONTINUE = 0  # next_state is the state of the next step
+DONE_LAST = 1  # Last step of the simulation, next_state is NaN
+DONE_TRUNCATED = 2  # The simulation stopped before the next state, next_state is NaN
+
+
+def open_dataset(path: str) -> np.ndarray:
+    """Map the transitions of a dataset file as a read-only structured array, without reading them.
+
+    Args:
+        path (str): Dataset file.
+
+    Returns:
+        np.ndarray: One record per transition, with the fields delay, loss, action_hash, step, done, state, next_state,
+        action and, in distributed mode, reward_delay and reward_loss. state and next_state are flat row-major
+        node_num x node_num load matrices, as in the states of the agent.
+    """
+    with open(path, "rb") as file:
+        head = file.read(HEADER.size)
+        if len(head) < HEADER.size:
+            raise ValueError(f"{path} is not a dataset file")
+        magic, version, _, _, field_num, slot_size, slot_num = HEADER.unpack(head)
+        if magic != DATASET_MAGIC or version != DATASET_VERSION:
+            raise ValueError(f"{path} is not a version {DATASET_VERSION} dataset file")
+        fields = [COLUMN.unpack(file.read(COLUMN.size)) for _ in range(field_num)]
+    dtype = np.dtype(
+        {
+            "names": [name.rstrip(b"\0").decode() for name, _, _, _ in fields],
+            "formats": [
+                (type_[:3].decode(), (width,)) if width != 1 else type_[:3].decode()
+                for _, type_, width, _ in fields
+            ],
+            "itemsize": slot_size,
+        }
+    )
+    data_offset = (HEADER.size + field_num * COLUMN.size + 7) // 8 * 8
+    if slot_num == 0:
+        return np.empty(0, dtype=dtype)
+    # Slots after slot_num are being written or were cut by a stopped simulation
+    return np.memmap(path, dtype=dtype, mode="r", offset=data_offset, shape=(slot_num,))
+
+
+def sample(
+    dataset: np.ndarray, batch_size: int, rng: Optional[np.random.Generator] = None
+) -> Dict[str, np.ndarray]:
+    """Sample a minibatch of transitions. Only the sampled slots are read from the mapped file.
+
+    Args:
+        dataset (np.ndarray): Transitions returned by open_dataset.
+        batch_size (int): Number of transitions.
+        rng (Optional[np.random.Generator]): Random generator, a new one if None.
+
+    Returns:
+        Dict[str, np.ndarray]: (batch_size, ...) array of each field.
+    """
+    if len(dataset) == 0:
+        raise ValueError("The dataset is empty")
+    rng = rng if rng is not None else np.random.default_rng()
+    batch = dataset[np.sort(rng.integers(0, len(dataset), batch_size))]
+    return {name: batch[name] for name in dataset.dtype.names}
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Summarize a dataset file written by the simulator.")
+    parser.add_argument("input", help="Dataset file (datasetFile of RlUdpApp)")
+    args = parser.parse_args()
+    transitions = open_dataset(args.input)
+    print(f"{len(transitions)} transitions of {transitions.dtype.itemsize} bytes")
+    for name in transitions.dtype.names:
+        print(f"{name}: {transitions.dtype[name]}")
+    if len(transitions):
+        done = transitions["done"]
+        print(
+            f"{np.sum(done == DONE_LAST)} episode ends, {np.sum(done == DONE_TRUNCATED)} truncated, "
+            f"mean delay {np.mean(transitions['delay']):.6f} s"
+        )
@@ -0,0 +1,109 @@
+"""
+Author       : LIN Guocheng
+Date         : 2026-10-18 22:14:36
+LastEditors  : LIN Guocheng
+LastEditTime : 2026-10-18 22:14:36
+FilePath     : /root/RouterRL/utils/results_file.py
+Description  : Read the columnar per-step results written by the simulator (resultsFile of RlUdpApp).
+"""
+import argparse
+import mmap
+import struct
+from typing import Dict, Iterator, List, Tuple
+
+import numpy as np
+
+RESULTS_MAGIC = 0x53524C52  # "RLRS"
+RESULTS_VERSION = 1
+HEADER = struct.Struct("<IIIIII")  # magic, version, node_num, link_num, group_steps, column_num
+COLUMN = struct.Struct("<20s4sII")  # name, numpy type, width, reserved
+GROUP = struct.Struct("<II")  # row_num, reserved
+
+
+def _align(offset: int) -> int:
+    return (offset + 7) // 8 * 8
+
+
+def _read_layout(data) -> Tuple[List[Tuple[str, np.dtype, int]], np.ndarray, int]:
+    """Columns, links and offset of the first row group of a results file.
+
+    Args:
+        data: Contents of the file.
+
+    Returns:
+        Tuple[List[Tuple[str, np.dtype, int]], np.ndarray, int]: (name, dtype, width) of each column, (link_num, 2)
+        source and destination of each link, offset of the first row group.
+    """
+    magic, version, _, link_num, _, column_num = HEADER.unpack_from(data, 0)
+    if magic != RESULTS_MAGIC or version != RESULTS_VERSION:
+        raise ValueError(f"Not a version {RESULTS_VERSION} results file")
+    columns = []
+    offset = HEADER.size
+    for _ in range(column_num):
+        name, dtype, width, _ = COLUMN.unpack_from(data, offset)
+        columns.append((name.rstrip(b"\0").decode(), np.dtype(dtype[:3].decode()), width))
+        offset += COLUMN.size
+    links = np.frombuffer(data, dtype="<u2", count=link_num * 2, offset=offset).reshape(link_num, 2)
+    return columns, links, _align(offset + links.nbytes)
+
+
+def iter_groups(path: str) -> Iterator[Dict[str, np.ndarray]]:
+    """Iterate over the row groups of a results file, each column is a view of the mapped file.
+
+    Args:
+        path (str): Results file.
+
+    Yields:
+        Dict[str, np.ndarray]: Columns of the row group, (row_num,) or (row_num, width) arrays.
+    """
+    with open(path, "rb") as file:
+        data = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+    columns, _, offset = _read_layout(data)
+    while offset + GROUP.size <= len(data):
+        row_num = GROUP.unpack_from(data, offset)[0]
+        end = offset + GROUP.size + sum(row_num * width * dtype.itemsize for _, dtype, width in columns)
+        if end > len(data):
+            break  # Row group of a stopped simulation
+        offset += GROUP.size
+        group = {}
+        for name, dtype, width in columns:
+            values = np.frombuffer(data, dtype=dtype, count=row_num * width, offset=offset)
+            group[name] = values if width == 1 else values.reshape(row_num, width)
+            offset += values.nbytes
+        offset = _align(offset)
+        yield group
+
+
+def read_results(path: str) -> Dict[str, np.ndarray]:
+    """Read all the rows of a results file.
+
+    Args:
+        path (str): Results file.
+
+    Returns:
+        Dict[str, np.ndarray]: Columns of all the rows, in the order of the rewards, and "links", the (link_num, 2)
+        source and destination of the columns of link_load.
+    """
+    with open(path, "rb") as file, mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        columns, links, _ = _read_layout(data)
+        links = links.copy()
+    groups = list(iter_groups(path))
+    results = {}
+    for name, dtype, width in columns:
+        if groups:
+            results[name] = np.concatenate([group[name] for group in groups])
+        else:
+            results[name] = np.empty((0,) if width == 1 else (0, width), dtype=dtype)
+    results["links"] = links
+    return results
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Summarize a results file written by the simulator.")
+    parser.add_argument("input", help="Results file (resultsFile of RlUdpApp)")
+    args = parser.parse_args()
+    results = read_results(args.input)
+    for column, values in results.items():
+        print(f"{column}: {values.dtype} {values.shape}")
+    if len(results["step"]):
+        print(f"mean delay {np.mean(results['delay']):.6f} s, mean loss {np.mean(results['loss']):.4f}")
@@ -0,0 +1,136 @@
+"""
+Author       : LIN Guocheng
+Date         : 2026-10-18 16:48:12
+LastEditors  : LIN Guocheng
+LastEditTime : 2026-10-18 16:48:12
+FilePath     : /root/RouterRL/utils/traffic_trace.py
+Description  : Write and read the binary traffic traces replayed by RlUdpApp (trafficModel = "trace").
+"""
+import argparse
+import mmap
+import struct
+from typing import Dict, Iterable, List, Optional, Sequence, Tuple, Union
+
+TRACE_MAGIC = 0x54544C52  # "RLTT"
+TRACE_VERSION = 1
+HEADER = struct.Struct("<IIII")  # magic, version, node_num, step_num
+OFFSET = struct.Struct("<Q")
+DEMAND = struct.Struct("<HHf")  # src, dst, rate in Mbps
+
+Matrix = Union[Sequence[Sequence[float]], Dict[Tuple[int, int], float]]
+
+
+def _demands_of(matrix: Matrix, node_num: int) -> List[Tuple[int, int, float]]:
+    """Non-zero off-diagonal demands of a matrix, sorted by source and then by destination.
+
+    Args:
+        matrix (Matrix): Dense node_num x node_num matrix, or sparse {(src, dst): rate}.
+        node_num (int): Number of hosts.
+
+    Returns:
+        List[Tuple[int, int, float]]: Sorted (src, dst, rate) demands.
+    """
+    if isinstance(matrix, dict):
+        items = [(src, dst, rate) for (src, dst), rate in matrix.items()]
+    else:
+        items = [(src, dst, row[dst]) for src, row in enumerate(matrix) for dst in range(len(row))]
+    demands = []
+    for src, dst, rate in items:
+        if not (0 <= src < node_num and 0 <= dst < node_num):
+            raise ValueError(f"OD pair ({src}, {dst}) is outside of {node_num} nodes")
+        if rate < 0:
+            raise ValueError(f"Negative load {rate} of OD pair ({src}, {dst})")
+        if src != dst and rate > 0:
+            demands.append((src, dst, float(rate)))
+    demands.sort()
+    return demands
+
+
+def write_trace(
+    path: str, node_num: int, matrices: Iterable[Matrix], step_num: Optional[int] = None
+) -> None:
+    """Write a traffic trace, one matrix per step. Matrices are streamed, so a generator can produce multi-GB traces.
+
+    Args:
+        path (str): Output trace file.
+        node_num (int): Number of hosts, must be the nodeNum of the simulated network.
+        matrices (Iterable[Matrix]): Load of each OD pair (Mbps) for every step.
+        step_num (Optional[int]): Number of steps, required if matrices has no length.
+    """
+    if node_num > 65536:
+        raise ValueError("Traces support at most 65536 nodes")
+    if step_num is None:
+        step_num = len(matrices)
+    offsets = []
+    with open(path, "wb") as out:
+        out.write(HEADER.pack(TRACE_MAGIC, TRACE_VERSION, node_num, step_num))
+        out.write(b"\0" * OFFSET.size * (step_num + 1))  # Step index, filled in at the end
+        written = 0
+        for matrix in matrices:
+            if written == step_num:
+                raise ValueError(f"More than {step_num} matrices given")
+            offsets.append(out.tell())
+            out.write(b"".join(DEMAND.pack(*demand) for demand in _demands_of(matrix, node_num)))
+            written += 1
+        if written != step_num:
+            raise ValueError(f"{written} matrices given, {step_num} expected")
+        offsets.append(out.tell())
+        out.seek(HEADER.size)
+        out.write(b"".join(OFFSET.pack(offset) for offset in offsets))
+
+
+def read_step(path: str, step: int) -> Dict[Tuple[int, int], float]:
+    """Read the demands of one step from a traffic trace without loading the rest of the file.
+
+    Args:
+        path (str): Trace file.
+        step (int): Trace step to read.
+
+    Returns:
+        Dict[Tuple[int, int], float]: Load of each active OD pair (Mbps).
+    """
+    with open(path, "rb") as file, mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) as data:
+        magic, version, _, step_num = HEADER.unpack_from(data, 0)
+        if magic != TRACE_MAGIC or version != TRACE_VERSION:
+            raise ValueError(f"{path} is not a version {TRACE_VERSION} traffic trace")
+        if not 0 <= step < step_num:
+            raise IndexError(f"Step {step} is outside of {step_num} steps")
+        begin = OFFSET.unpack_from(data, HEADER.size + step * OFFSET.size)[0]
+        end = OFFSET.unpack_from(data, HEADER.size + (step + 1) * OFFSET.size)[0]
+        return {
+            (src, dst): rate
+            for src, dst, rate in (
+                DEMAND.unpack_from(data, offset) for offset in range(begin, end, DEMAND.size)
+            )
+        }
+
+
+def _read_text_matrices(path: str, node_num: int) -> Iterable[List[List[float]]]:
+    """Matrices of a text file in the format of trafficMatrixFile, one row-major matrix per line."""
+    with open(path, "r", encoding="utf-8") as file:
+        for line in file:
+            if not line.strip() or line.startswith("#"):
+                continue
+            loads = [float(x) for x in line.replace(",", " ").split()]
+            if len(loads) != node_num * node_num:
+                raise ValueError(f"Matrix with {len(loads)} loads, {node_num * node_num} expected")
+            yield [loads[i * node_num : (i + 1) * node_num] for i in range(node_num)]
+
+
+def _count_text_matrices(path: str) -> int:
+    with open(path, "r", encoding="utf-8") as file:
+        return sum(1 for line in file if line.strip() and not line.startswith("#"))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Convert a text traffic matrix file into a binary trace.")
+    parser.add_argument("input", help="Text file, one row-major matrix per line (trafficMatrixFile format)")
+    parser.add_argument("output", help="Binary trace file for trafficTraceFile")
+    parser.add_argument("--node_num", type=int, required=True, help="Number of hosts")
+    args = parser.parse_args()
+    write_trace(
+        args.output,
+        args.node_num,
+        _read_text_matrices(args.input, args.node_num),
+        _count_text_matrices(args.input),
+    )